@@ -23,9 +23,127 @@
 
 #include "customdebug.h"
 #include <QtCore>
-#include <QBitArray>
+#include <QtEndian>
 #include <utility>
 
+/*
+  Bit streams used to export / import the fields, bit 0 of the stream is bit 0 of the first byte.
+  The bits are packed / unpacked up to 32 at a time through a 64 bits little-endian word,
+  the underlying buffers always keep 8 spare bytes after the current position for that.
+*/
+class BitWriter {
+  public:
+    void write(uint64_t value, unsigned int bits)
+    {
+      while (bits > 0) {
+        unsigned int chunk = std::min(bits, 32u);
+        writeWord(uint32_t(value), chunk);
+        value >>= chunk;
+        bits -= chunk;
+      }
+    }
+
+    // Zero pad (or go back) up to the given position
+    void seek(unsigned int position)
+    {
+      if (position > offset)
+        write(0, position - offset);
+      else
+        offset = position;
+    }
+
+    unsigned int position() const
+    {
+      return offset;
+    }
+
+    unsigned int size() const
+    {
+      return end;
+    }
+
+    QByteArray bytes() const
+    {
+      return buffer.left((end + 7) / 8);
+    }
+
+  protected:
+    void writeWord(uint32_t value, unsigned int bits)
+    {
+      unsigned int index = offset / 8;
+      unsigned int shift = offset % 8;
+      if (unsigned(buffer.size()) < index + 8) {
+        buffer.append(QByteArray(std::max<int>(buffer.size(), 64), 0));
+      }
+      uchar * p = (uchar *)buffer.data() + index;
+      uint64_t mask = ((uint64_t(1) << bits) - 1) << shift;
+      uint64_t word = qFromLittleEndian<quint64>(p);
+      word = (word & ~mask) | ((uint64_t(value) << shift) & mask);
+      qToLittleEndian<quint64>(word, p);
+      offset += bits;
+      end = std::max(end, offset);
+    }
+
+    QByteArray buffer;
+    unsigned int offset = 0;
+    unsigned int end = 0;
+};
+
+class BitReader {
+  public:
+    explicit BitReader(const QByteArray & bytes):
+      buffer(bytes),
+      length(bytes.size() * 8)
+    {
+      buffer.append(QByteArray(8, 0));
+    }
+
+    // Bits after the end of the stream read as 0
+    uint64_t read(unsigned int bits)
+    {
+      uint64_t result = 0;
+      for (unsigned int shift = 0; bits > 0; shift += 32) {
+        unsigned int chunk = std::min(bits, 32u);
+        uint64_t value = readWord(chunk);
+        if (shift < 64)
+          result |= value << shift;
+        bits -= chunk;
+      }
+      return result;
+    }
+
+    void seek(unsigned int position)
+    {
+      offset = position;
+    }
+
+    unsigned int position() const
+    {
+      return offset;
+    }
+
+    unsigned int size() const
+    {
+      return length;
+    }
+
+  protected:
+    uint32_t readWord(unsigned int bits)
+    {
+      unsigned int index = offset / 8;
+      unsigned int shift = offset % 8;
+      offset += bits;
+      if (index + 8 > unsigned(buffer.size()))
+        return 0;
+      uint64_t word = qFromLittleEndian<quint64>((const uchar *)buffer.constData() + index);
+      return (word >> shift) & ((uint64_t(1) << bits) - 1);
+    }
+
+    QByteArray buffer;
+    unsigned int length;
+    unsigned int offset = 0;
+};
+
 class DataField {
   Q_DECLARE_TR_FUNCTIONS(DataField)
 
@@ -45,60 +163,41 @@ class DataField {
     }
 
     virtual unsigned int size() = 0; // size in bits
-    virtual void ExportBits(QBitArray & output) = 0;
-    virtual void ImportBits(const QBitArray & input) = 0;
-
-    static QBitArray bytesToBits(QByteArray bytes)
-    {
-      QBitArray bits(bytes.count()*8);
-      // Convert from QByteArray to QBitArray
-      for (int i=0; i<bytes.count(); ++i)
-        for (int b=0; b<8; ++b)
-          bits.setBit(i*8+b, bytes.at(i)&(1<<b));
-      return bits;
-    }
-
-    static QByteArray bitsToBytes(QBitArray bits, int offset=0)
-    {
-      QByteArray bytes;
-      bytes.resize((offset+bits.count()+7)/8);
-      bytes.fill(0);
-      // Convert from QBitArray to QByteArray
-      for (int b=0; b<bits.count(); ++b)
-        bytes[(b+offset)/8] = ( bytes.at((b+offset)/8) | ((bits[b]?1:0)<<((b+offset)%8)));
-      return bytes;
-    }
+    // each field writes / reads exactly size() bits at the current stream position
+    virtual void ExportBits(BitWriter & output) = 0;
+    virtual void ImportBits(BitReader & input) = 0;
 
     int Export(QByteArray & output)
     {
-      QBitArray result;
-      ExportBits(result);
-      output = bitsToBytes(result);
+      BitWriter writer;
+      ExportBits(writer);
+      output = writer.bytes();
       return 0;
     }
 
     int Import(const QByteArray & input)
     {
-      QBitArray bits = bytesToBits(input);
-      if (unsigned(bits.size()) < size()) {
-        qDebug() << QString("Error importing %1: size too small %2 bits / %3 bits").arg(getName()).arg(bits.size()).arg(size());
+      BitReader reader(input);
+      if (reader.size() < size()) {
+        qDebug() << QString("Error importing %1: size too small %2 bits / %3 bits").arg(getName()).arg(reader.size()).arg(size());
         return -1;
       }
-      ImportBits(bits);
+      ImportBits(reader);
       return 0;
     }
 
     virtual int dump(int level=0, int offset=0)
     {
-      QBitArray bits;
-      ExportBits(bits);
-      QByteArray bytes = bitsToBytes(bits);
-      int result = (offset+bits.count()) % 8;
+      BitWriter writer;
+      ExportBits(writer);
+      QByteArray bytes = writer.bytes();
+      int bits = writer.size();
+      int result = (offset+bits) % 8;
       for (int i=0; i<level; i++) printf("  ");
-      if (bits.count() % 8 == 0)
+      if (bits % 8 == 0)
         printf("%s (%dbytes) ", getName().toLatin1().constData(), bytes.count());
       else
-        printf("%s (%dbits) ", getName().toLatin1().constData(), bits.count());
+        printf("%s (%dbits) ", getName().toLatin1().constData(), bits);
       for (int i=0; i<bytes.count(); i++) {
         unsigned char c = bytes[i];
         if ((i==0 && offset) || (i==bytes.count()-1 && result!=0))
@@ -165,27 +264,18 @@ class BaseUnsignedField: public DataField {
 
     BaseUnsignedField() = delete;
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
       container value = field;
       if (value > max) value = max;
       if (value < min) value = min;
 
-      output.resize(N);
-      for (int i=0; i<N; i++) {
-        if (value & ((container)1<<i)) {
-          output.setBit(i);
-        }
-      }
+      output.write(value, N);
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
-      field = 0;
-      for (int i=0; i<N; i++) {
-        if (input[i])
-          field |= ((container)1<<i);
-      }
+      field = (container)input.read(N);
       qCDebug(eepromImport) << QString("\timported %1<%2>: 0x%3(%4)").arg(name).arg(N).arg(field, 0, 16).arg(field);
     }
 
@@ -231,17 +321,14 @@ class BoolField: public DataField {
 
     BoolField() = delete;
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
-      output.resize(N);
-      if (field) {
-        output.setBit(0);
-      }
+      output.write(field ? 1 : 0, N);
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
-      field = input[0];
+      field = input.read(N) & 1;
       qCDebug(eepromImport) << QString("\timported %1<%2>: 0x%3(%4)").arg(name).arg(N).arg(field, 0, 16).arg(field);
     }
 
@@ -277,31 +364,21 @@ class SignedField: public DataField {
     {
     }
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
       int value = field;
       if (value > max) value = max;
       if (value < min) value = min;
 
-      output.resize(N);
-      for (int i=0; i<N; i++) {
-        if (((unsigned int)value) & (1<<i))
-          output.setBit(i);
-      }
+      output.write((unsigned int)value, N);
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
-      unsigned int value = 0;
-      for (int i=0; i<N; i++) {
-        if (input[i])
-          value |= (1<<i);
-      }
+      unsigned int value = input.read(N);
 
-      if (input[N-1]) {
-        for (unsigned int i=N; i<8*sizeof(int); i++) {
-          value |= (1<<i);
-        }
+      if (N < 8*sizeof(int) && (value & (1u << (N-1)))) {
+        value |= ~0u << (N % (8*sizeof(int)));
       }
 
       field = (int)value;
@@ -342,30 +419,19 @@ class CharField: public DataField {
     {
     }
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
-      output.resize(N*8);
-      int b = 0;
       int len = truncate ? strlen(field) : N;
       for (int i=0; i<N; i++) {
-        int idx = (i>=len ? 0 : field[i]);
-        for (int j=0; j<8; j++, b++) {
-          if (idx & (1<<j))
-            output.setBit(b);
-        }
+        uint8_t idx = (i>=len ? 0 : field[i]);
+        output.write(idx, 8);
       }
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
-      unsigned int b = 0;
       for (int i=0; i<N; i++) {
-        int8_t idx = 0;
-        for (int j=0; j<8; j++) {
-          if (input[b++])
-            idx |= (1<<j);
-        }
-        field[i] = idx;
+        field[i] = input.read(8);
       }
       qCDebug(eepromImport) << QString("\timported %1<%2>: '%3'").arg(name).arg(N).arg(field);
     }
@@ -417,29 +483,19 @@ class ZCharField: public DataField {
     {
     }
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
-      output.resize(N*8);
-      int b = 0;
       int len = strlen(field);
       for (int i=0; i<N; i++) {
-        int idx = i>=len ? 0 : char2zchar(field[i]);
-        for (int j=0; j<8; j++, b++) {
-          if (idx & (1<<j))
-            output.setBit(b);
-        }
+        uint8_t idx = i>=len ? 0 : char2zchar(field[i]);
+        output.write(idx, 8);
       }
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
-      unsigned int b = 0;
       for (int i=0; i<N; i++) {
-        int8_t idx = 0;
-        for (int j=0; j<8; j++) {
-          if (input[b++])
-            idx |= (1<<j);
-        }
+        int8_t idx = input.read(8);
         field[i] = zchar2char(idx);
       }
 
@@ -480,29 +536,22 @@ class StructField: public DataField {
       fields.append(field);
     }
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
-      int offset = 0;
-      output.resize(size());
       foreach(DataField *field, fields) {
-        QBitArray bits;
-        field->ExportBits(bits);
-        for (int i=0; i<bits.size(); i++)
-          output[offset++] = bits[i];
+        unsigned int offset = output.position() + field->size();
+        field->ExportBits(output);
+        output.seek(offset);
       }
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
       qCDebug(eepromImport) << QString("\timporting %1[%2]:").arg(name).arg(fields.size());
-      int offset = 0;
       foreach(DataField *field, fields) {
-        unsigned int size = field->size();
-        QBitArray bits(size);
-        for (unsigned int i=0; i<size; i++) {
-          bits[i] = input[offset++];
-        }
-        field->ImportBits(bits);
+        unsigned int offset = input.position() + field->size();
+        field->ImportBits(input);
+        input.seek(offset);
       }
     }
 
@@ -540,13 +589,13 @@ class TransformedField: public DataField {
     ~TransformedField() override
     = default;
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
       beforeExport();
       field.ExportBits(output);
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
       qCDebug(eepromImport) << QString("\timporting TransformedField %1:").arg(field.getName());
       field.ImportBits(input);
@@ -619,25 +668,28 @@ class UnionField: public DataField {
         maxSize = member->getField()->size();
     }
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
+      unsigned int offset = output.position() + maxSize;
       foreach(UnionMember *member, members) {
         if (member->select(selectField)) {
           member->getField()->ExportBits(output);
           break;
         }
       }
-      output.resize(maxSize);
+      output.seek(offset);
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
+      unsigned int offset = input.position() + maxSize;
       foreach(UnionMember *member, members) {
         if (member->select(selectField)) {
           member->getField()->ImportBits(input);
           break;
         }
       }
+      input.seek(offset);
     }
 
     unsigned int size() override
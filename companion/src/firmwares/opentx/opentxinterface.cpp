@@ -172,6 +172,43 @@ bool OpenTxEepromInterface::loadFromByteArray(T & dest, const QByteArray & data,
   return true;
 }
 
+// CRC32 (0x04C11DB7, MSB first, no final xor) of the radio file journal records
+static uint32_t journalCrc(uint32_t crc, const char * data, int len)
+{
+  while (len--) {
+    crc ^= uint32_t(uint8_t(*data++)) << 24;
+    for (int i = 0; i < 8; i++) {
+      crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+// The radio appends the later changes of a model file after its content (see radio/src/storage/sdcard_raw.cpp),
+// record: offset (2 bytes), length (2 bytes), CRC32 of offset, length and data (4 bytes), data
+static QByteArray applyFileJournal(const QByteArray & data)
+{
+  const int size = *((const uint16_t *)&data.constData()[6]);
+  if (data.size() <= 8 + size) {
+    return data.mid(8);
+  }
+
+  QByteArray content = data.mid(8, size);
+  int pos = 8 + size;
+  while (pos + 8 <= data.size()) {
+    const char * record = data.constData() + pos;
+    const int offset = *((const uint16_t *)&record[0]);
+    const int length = *((const uint16_t *)&record[2]);
+    if (offset + length > size || pos + 8 + length > data.size() ||
+        journalCrc(journalCrc(0xFFFFFFFF, record, 4), record + 8, length) != *((const uint32_t *)&record[4])) {
+      break;  // not completely written by the radio
+    }
+    content.replace(offset, length, record + 8, length);
+    pos += 8 + length;
+  }
+  return content;
+}
+
 template <class T, class M>
 bool OpenTxEepromInterface::loadFromByteArray(T & dest, const QByteArray & data)
 {
@@ -187,7 +224,7 @@ bool OpenTxEepromInterface::loadFromByteArray(T & dest, const QByteArray & data)
   }
   qDebug() << QString().sprintf("%s: OK", getName());
   uint8_t version = data[4];
-  QByteArray raw = data.right(data.size() - 8);
+  QByteArray raw = applyFileJournal(data);
   return loadFromByteArray<T, M>(dest, raw, version);
 }
 
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "logmodel.h"
+
+LogModel::LogModel(QObject * parent) :
+  QAbstractTableModel(parent),
+  m_records(0),
+  m_lastTimeStampHourStart(0)
+{
+}
+
+void LogModel::clear()
+{
+  beginResetModel();
+  m_fields.clear();
+  m_texts.clear();
+  m_values.clear();
+  m_timestamps.clear();
+  m_sessions.clear();
+  m_records = 0;
+  m_lastTimeStampHour.clear();
+  endResetModel();
+}
+
+bool LogModel::parse(QIODevice & device, int & errors, int & lines)
+{
+  errors = 0;
+  lines = -1;
+
+  // the current log is kept if this one can't be read
+  if (!device.peek(9).startsWith("Date,Time")) {
+    return false;
+  }
+
+  clear();
+  beginResetModel();
+
+  // the timestamps and the numeric values are converted only once, here, and the
+  // flight sessions are found on the fly
+  double lastTimestamp = 0;
+  while (!device.atEnd()) {
+    QString line = device.readLine().trimmed();
+    QStringList columns = line.split(',');
+    if (m_fields.isEmpty()) {
+      m_fields = columns;
+      m_texts.resize(m_fields.count());
+      m_values.resize(m_fields.count());
+    }
+    else if (columns.count() == m_fields.count()) {
+      double timestamp = parseRecordTimeStamp(columns.at(0), columns.at(1));
+      if (m_records == 0 || timestamp - lastTimestamp > 60) {
+        m_sessions.append(m_records);
+      }
+      lastTimestamp = timestamp;
+      m_timestamps.append(timestamp);
+      for (int i = 0; i < columns.count(); i++) {
+        if (i >= 2) {
+          m_values[i].append(columns.at(i).toDouble());
+        }
+        m_texts[i].append(columns.at(i));
+      }
+      m_records++;
+    }
+    else {
+      errors++;
+    }
+    lines++;
+  }
+  m_sessions.append(m_records);
+
+  endResetModel();
+  return true;
+}
+
+int LogModel::rowCount(const QModelIndex & parent) const
+{
+  return parent.isValid() ? 0 : m_records;
+}
+
+int LogModel::columnCount(const QModelIndex & parent) const
+{
+  return parent.isValid() ? 0 : m_fields.count();
+}
+
+QVariant LogModel::data(const QModelIndex & index, int role) const
+{
+  if (!index.isValid() || role != Qt::DisplayRole) {
+    return QVariant();
+  }
+  return text(index.row(), index.column());
+}
+
+QVariant LogModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section < m_fields.count()) {
+    return m_fields.at(section);
+  }
+  return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+QDateTime LogModel::recordTime(int record) const
+{
+  return QDateTime::fromMSecsSinceEpoch(qRound64(timestamp(record) * 1000));
+}
+
+QString LogModel::recordLine(int record) const
+{
+  QStringList line;
+  for (int i = 0; i < m_texts.size(); i++) {
+    line.append(text(record, i));
+  }
+  return line.join(",");
+}
+
+// "yyyy-MM-dd", "HH:mm:ss[.zzz]" => seconds since epoch, in local time
+// QDateTime is only used once per hour of log, the rest is plain arithmetic
+double LogModel::parseRecordTimeStamp(const QString & date, const QString & time)
+{
+  QString hour = date + time.left(2);
+  if (hour != m_lastTimeStampHour) {
+    QDateTime start = QDateTime::fromString(hour, "yyyy-MM-ddHH");
+    m_lastTimeStampHour = hour;
+    m_lastTimeStampHourStart = start.isValid() ? start.toMSecsSinceEpoch() / 1000.0 : 0;
+  }
+  return m_lastTimeStampHourStart + time.midRef(3, 2).toInt() * 60 + time.midRef(6).toDouble();
+}
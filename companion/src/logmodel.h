@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _LOGMODEL_H_
+#define _LOGMODEL_H_
+
+#include <QAbstractTableModel>
+#include <QDateTime>
+#include <QIODevice>
+#include <QStringList>
+#include <QVector>
+
+// A telemetry log (CSV, "Date,Time,..." header), stored by column. The table views
+// only ask for the cells they show, the plots use the values converted at load time.
+class LogModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+  public:
+    explicit LogModel(QObject * parent = nullptr);
+
+    // returns false if the device doesn't hold a log, errors counts the lines with a wrong number of fields
+    bool parse(QIODevice & device, int & errors, int & lines);
+    void clear();
+
+    int rowCount(const QModelIndex & parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex & parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    const QStringList & fields() const { return m_fields; }
+    const QString & text(int record, int column) const { return m_texts.at(column).at(record); }
+    // numeric values of the columns after Date and Time
+    const QVector<double> & values(int column) const { return m_values.at(column); }
+    double timestamp(int record) const { return m_timestamps.at(record); }  // seconds since epoch
+    QDateTime recordTime(int record) const;
+    QString recordLine(int record) const;
+    // first record of each flight session (more than 60s between two records), then the records count
+    const QList<int> & sessions() const { return m_sessions; }
+
+  protected:
+    double parseRecordTimeStamp(const QString & date, const QString & time);
+
+    QStringList m_fields;
+    QVector<QStringList> m_texts;
+    QVector<QVector<double>> m_values;
+    QVector<double> m_timestamps;
+    QList<int> m_sessions;
+    int m_records;
+
+    QString m_lastTimeStampHour;
+    double m_lastTimeStampHourStart;
+};
+
+#endif // _LOGMODEL_H_
@@ -31,17 +31,21 @@
 
 LogsDialog::LogsDialog(QWidget *parent) :
   QDialog(parent, Qt::WindowTitleHint | Qt::WindowSystemMenuHint),
+  logModel(new LogModel(this)),
   ui(new Ui::LogsDialog),
   tracerMaxAlt(0),
   cursorA(0),
   cursorB(0),
-  cursorLine(0)
+  cursorLine(0),
+  cursorGraph(-1)
 {
-  csvlog.clear();
-
   ui->setupUi(this);
   setWindowIcon(CompanionIcon("logs.png"));
 
+  // the table only asks the log for the rows it shows
+  ui->logTable->setModel(logModel);
+  ui->logTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+
   plotLock=false;
 
   colors.append(Qt::green);
@@ -110,13 +114,15 @@ LogsDialog::LogsDialog(QWidget *parent) :
 
   // make left axes transfer its range to right axes:
   connect(axisRect->axis(QCPAxis::atLeft), SIGNAL(rangeChanged(QCPRange)), this, SLOT(yAxisChangeRanges(QCPRange)));
+  // decimate the graphs again when the time range changes:
+  connect(axisRect->axis(QCPAxis::atBottom), SIGNAL(rangeChanged(QCPRange)), this, SLOT(xAxisChangeRange(QCPRange)));
 
   // connect some interaction slots:
   connect(ui->customPlot, SIGNAL(titleDoubleClick(QMouseEvent*, QCPPlotTitle*)), this, SLOT(titleDoubleClick(QMouseEvent*, QCPPlotTitle*)));
   connect(ui->customPlot, SIGNAL(axisDoubleClick(QCPAxis*,QCPAxis::SelectablePart,QMouseEvent*)), this, SLOT(axisLabelDoubleClick(QCPAxis*,QCPAxis::SelectablePart)));
   connect(ui->customPlot, SIGNAL(legendDoubleClick(QCPLegend*,QCPAbstractLegendItem*,QMouseEvent*)), this, SLOT(legendDoubleClick(QCPLegend*,QCPAbstractLegendItem*)));
   connect(ui->FieldsTW, SIGNAL(itemSelectionChanged()), this, SLOT(plotLogs()));
-  connect(ui->logTable, SIGNAL(itemSelectionChanged()), this, SLOT(plotLogs()));
+  connect(ui->logTable->selectionModel(), SIGNAL(selectionChanged(QItemSelection, QItemSelection)), this, SLOT(plotLogs()));
   connect(ui->Reset_PB, SIGNAL(clicked()), this, SLOT(plotLogs()));
   connect(ui->SaveSession_PB, SIGNAL(clicked()), this, SLOT(saveSession()));
 }
@@ -236,18 +242,15 @@ void LogsDialog::selectionChanged()
   }
 }
 
-QList<QStringList> LogsDialog::filterGePoints(const QList<QStringList> & input)
+// the records of the selected rows (all of them without selection) with a valid GPS position
+QVector<int> LogsDialog::filterGePoints()
 {
-  QList<QStringList> result;
-
-  int n = input.count();
-  if (n == 0) {
-    return result;
-  }
+  QVector<int> result;
 
+  const QStringList & fields = logModel->fields();
   int gpscol = 0;
-  for (int i=1; i<input.at(0).count(); i++) {
-    if (input.at(0).at(i) == "GPS") {
+  for (int i=1; i<fields.count(); i++) {
+    if (fields.at(i) == "GPS") {
       gpscol=i;
     }
   }
@@ -258,16 +261,16 @@ The columns for altitude \"GAlt\" and for speed \"GSpd\" are optional"));
     return result;
   }
 
-  result.append(input.at(0));
-  bool rangeSelected = ui->logTable->selectionModel()->selectedRows().length() > 0;
+  QItemSelectionModel * selection = ui->logTable->selectionModel();
+  bool rangeSelected = selection->hasSelection();
 
   GpsGlitchFilter glitchFilter;
   GpsLatLonFilter latLonFilter;
 
-  for (int i = 1; i < n; i++) {
-    if ((ui->logTable->item(i-1, 1)->isSelected() && rangeSelected) || !rangeSelected) {
+  for (int i = 0; i < logModel->rowCount(); i++) {
+    if (!rangeSelected || selection->isRowSelected(i, QModelIndex())) {
 
-      GpsCoord coord = extractGpsCoordinates(input.at(i).at(gpscol));
+      GpsCoord coord = extractGpsCoordinates(logModel->text(i, gpscol));
 
       // glitch filter
       if ( glitchFilter.isGlitch(coord) ) {
@@ -282,38 +285,38 @@ The columns for altitude \"GAlt\" and for speed \"GSpd\" are optional"));
       }
 
       // qDebug() << "point " << latitude << longitude;
-      result.append(input.at(i));
+      result.append(i);
     }
   }
 
-  // qDebug() << "filterGePoints(): filtered from" << input.count() << "to " << result.count() << "points";
+  // qDebug() << "filterGePoints(): filtered from" << logModel->rowCount() << "to " << result.count() << "points";
   return result;
 }
 
 void LogsDialog::exportToGoogleEarth()
 {
   // filter data points
-  QList<QStringList> dataPoints = filterGePoints(csvlog);
-  int n = dataPoints.count(); // number of points to export
-  if (n==0) return;
+  QVector<int> dataPoints = filterGePoints();
+  if (dataPoints.isEmpty()) return;
 
+  const QStringList & fields = logModel->fields();
   int gpscol=0, altcol=0, speedcol=0;
   double altMultiplier = 1.0;
 
   QSet<int> nondataCols;
-  for (int i=1; i<dataPoints.at(0).count(); i++) {
+  for (int i=1; i<fields.count(); i++) {
     // Long,Lat,Course,GPS Speed,GPS Alt
-    if (dataPoints.at(0).at(i) == "GPS") {
+    if (fields.at(i) == "GPS") {
       gpscol=i;
     }
-    if (dataPoints.at(0).at(i).contains("GAlt")) {
+    if (fields.at(i).contains("GAlt")) {
       altcol = i;
       nondataCols << i;
-      if (dataPoints.at(0).at(i).contains("(ft)")) {
+      if (fields.at(i).contains("(ft)")) {
         altMultiplier = 0.3048;    // feet to meters
       }
     }
-    if (dataPoints.at(0).at(i).contains("GSpd")) {
+    if (fields.at(i).contains("GSpd")) {
       speedcol = i;
       nondataCols << i;
     }
@@ -353,9 +356,9 @@ void LogsDialog::exportToGoogleEarth()
   outputStream << "\t\t\t<gx:SimpleArrayField name=\"GPSSpeed\" type=\"float\">\n\t\t\t\t<displayName>GPS Speed</displayName>\n\t\t\t</gx:SimpleArrayField>\n";
 
   // declare additional fields
-  for (int i=0; i<dataPoints.at(0).count()-2; i++) {
+  for (int i=0; i<fields.count()-2; i++) {
     if (ui->FieldsTW->item(i, 0) && ui->FieldsTW->item(i, 0)->isSelected() && !nondataCols.contains(i+2)) {
-      QString origName = dataPoints.at(0).at(i+2);
+      QString origName = fields.at(i+2);
       QString safeName = origName;
       safeName.replace(" ","_");
       outputStream << "\t\t\t<gx:SimpleArrayField name=\""<< safeName <<"\" ";
@@ -378,17 +381,17 @@ void LogsDialog::exportToGoogleEarth()
   outputStream << "\n\t\t\t\t\t<altitudeMode>absolute</altitudeMode>\n";
 
   // time data points
-  for (int i=1; i<n; i++) {
-    QString tstamp=dataPoints.at(i).at(0)+QString("T")+dataPoints.at(i).at(1)+QString("Z");
+  foreach (int record, dataPoints) {
+    QString tstamp=logModel->text(record, 0)+QString("T")+logModel->text(record, 1)+QString("Z");
     outputStream << "\t\t\t\t\t<when>"<< tstamp <<"</when>\n";
   }
 
   // coordinate data points
   outputStream.setRealNumberNotation(QTextStream::FixedNotation);
   outputStream.setRealNumberPrecision(8);
-  for (int i=1; i<n; i++) {
-    GpsCoord coord = extractGpsCoordinates(dataPoints.at(i).at(gpscol));
-    int altitude = altcol ? (dataPoints.at(i).at(altcol).toFloat() * altMultiplier) : 0;
+  foreach (int record, dataPoints) {
+    GpsCoord coord = extractGpsCoordinates(logModel->text(record, gpscol));
+    int altitude = altcol ? (logModel->text(record, altcol).toFloat() * altMultiplier) : 0;
     outputStream << "\t\t\t\t\t<gx:coord>" << coord.longitude << " " << coord.latitude << " " << altitude << " </gx:coord>\n" ;
   }
 
@@ -398,20 +401,20 @@ void LogsDialog::exportToGoogleEarth()
   if (speedcol) {
     // gps speed data points
     outputStream << "\t\t\t\t\t\t\t<gx:SimpleArrayData name=\"GPSSpeed\">\n";
-    for (int i=1; i<n; i++) {
-      outputStream << "\t\t\t\t\t\t\t\t<gx:value>"<< dataPoints.at(i).at(speedcol) <<"</gx:value>\n";
+    foreach (int record, dataPoints) {
+      outputStream << "\t\t\t\t\t\t\t\t<gx:value>"<< logModel->text(record, speedcol) <<"</gx:value>\n";
     }
     outputStream << "\t\t\t\t\t\t\t</gx:SimpleArrayData>\n";
   }
 
   // add values for additional fields
-  for (int i=0; i<dataPoints.at(0).count()-2; i++) {
+  for (int i=0; i<fields.count()-2; i++) {
     if (ui->FieldsTW->item(i, 0) && ui->FieldsTW->item(i, 0)->isSelected() && !nondataCols.contains(i+2)) {
-      QString safeName = dataPoints.at(0).at(i+2);;
+      QString safeName = fields.at(i+2);
       safeName.replace(" ","_");
       outputStream << "\t\t\t\t\t\t\t<gx:SimpleArrayData name=\""<< safeName <<"\">\n";
-      for (int j=1; j<n; j++) {
-        outputStream << "\t\t\t\t\t\t\t\t<gx:value>"<< dataPoints.at(j).at(i+2) <<"</gx:value>\n";
+      foreach (int record, dataPoints) {
+        outputStream << "\t\t\t\t\t\t\t\t<gx:value>"<< logModel->text(record, i+2) <<"</gx:value>\n";
       }
       outputStream << "\t\t\t\t\t\t\t</gx:SimpleArrayData>\n";
     }
@@ -464,10 +467,19 @@ void LogsDialog::placeCursor(double x, bool second)
 {
   QCPItemTracer * cursor = second ? cursorB : cursorA;
 
-  if (cursor) {
-    cursor->setGraphKey(x);
-    cursor->updatePosition();
-    cursor->setVisible(true);
+  if (cursor && cursorGraph >= 0) {
+    // the log sample nearest to x, the graph may only hold some of them
+    const coords_t & c = plottedCoords.at(cursorGraph);
+    int nearest = -1;
+    for (int i = 0; i < c.x.size(); i++) {
+      if (nearest < 0 || fabs(c.x.at(i) - x) < fabs(c.x.at(nearest) - x)) {
+        nearest = i;
+      }
+    }
+    if (nearest >= 0) {
+      placeTracer(cursor, ui->customPlot->graph(cursorGraph), c.x.at(nearest), c.y.at(nearest));
+      cursor->setVisible(true);
+    }
   }
 
   if (cursorA && cursorB) {
@@ -562,6 +574,7 @@ void LogsDialog::removeAllGraphs()
   cursorA = 0;
   cursorB = 0;
   cursorLine = 0;
+  cursorGraph = -1;
   ui->labelCursors->setText("");
 }
 
@@ -572,37 +585,28 @@ void LogsDialog::on_fileOpen_BT_clicked()
     g.logDir(fileName);
     ui->FileName_LE->setText(fileName);
     if (cvsFileParse()) {
+      const QStringList & fields = logModel->fields();
       ui->FieldsTW->clear();
-      ui->logTable->clear();
       ui->FieldsTW->setShowGrid(false);
       ui->FieldsTW->setContentsMargins(0,0,0,0);
-      ui->FieldsTW->setRowCount(csvlog.at(0).count()-2);
+      ui->FieldsTW->setRowCount(fields.count()-2);
       ui->FieldsTW->setColumnCount(1);
       ui->FieldsTW->setHorizontalHeaderLabels(QStringList(tr("Available fields")));
-      ui->logTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-      for (int i=2; i<csvlog.at(0).count(); i++) {
-        QTableWidgetItem* item= new QTableWidgetItem(csvlog.at(0).at(i));
+      for (int i=2; i<fields.count(); i++) {
+        QTableWidgetItem* item= new QTableWidgetItem(fields.at(i));
         ui->FieldsTW->setItem(i-2, 0, item);
       }
       ui->FieldsTW->resizeRowsToContents();
-      ui->logTable->setColumnCount(csvlog.at(0).count());
-      ui->logTable->setRowCount(csvlog.count()-1);
-      ui->logTable->setHorizontalHeaderLabels(csvlog.at(0));
-
-      QAbstractItemModel *model = ui->logTable->model();
-      for (int i=1; i<csvlog.count(); i++) {
-        for (int j=0; j<csvlog.at(0).count(); j++) {
-          model->setData(model->index(i - 1, j, QModelIndex()), csvlog.at(i).at(j));
-        }
-      }
 
+      // the column widths are measured on the first rows only
+      ui->logTable->horizontalHeader()->setResizeContentsPrecision(100);
       ui->logTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
       QVarLengthArray<int> sizes;
-      for (int i = 0; i < ui->logTable->columnCount(); i++) {
+      for (int i = 0; i < logModel->columnCount(); i++) {
         sizes.append(ui->logTable->columnWidth(i));
       }
       ui->logTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
-      for (int i = 0; i < ui->logTable->columnCount(); i++) {
+      for (int i = 0; i < logModel->columnCount(); i++) {
         ui->logTable->setColumnWidth(i, sizes.at(i));
       }
     }
@@ -614,27 +618,10 @@ void LogsDialog::saveSession()
   int index = ui->sessions_CB->currentIndex();
   // ignore index 0 is its all sessions combined
   if(index > 0) {
-    int n = csvlog.count();
-    QList<QStringList> sessionCsvLog;
-    // add CSV headers from first row of source file
-    sessionCsvLog.push_back(csvlog[0]);
-    // find session breaks
-    int currentSession = 0;
-    QDateTime lastvalue;
-    for (int i = 1; i < n; i++) {
-      QDateTime tmp = getRecordTimeStamp(i);
-      if (!lastvalue.isValid() || lastvalue.secsTo(tmp) > 60) {
-        currentSession++;
-      }
-      lastvalue = tmp;
-      if(currentSession == index) {
-        // add records to filtered list
-        sessionCsvLog.push_back(csvlog[i]);
-      }
-      else if (currentSession > index) {
-        break;
-      }
-    }
+    // session breaks were found when the log was parsed
+    const QList<int> & sessions = logModel->sessions();
+    int first = sessions.at(index - 1);
+    int end = sessions.at(index);
     // save the filtered records to a new file
     QString newFilename = logFilename;
     newFilename.append(QString("-Session%1.csv").arg(index));
@@ -642,12 +629,12 @@ void LogsDialog::saveSession()
     QFile data(filename);
     if(data.open(QFile::WriteOnly |QFile::Truncate)) {
       QTextStream output(&data);
-      int numRecords = sessionCsvLog.count();
-      for(int i = 0; i < numRecords; i++){
-        output << sessionCsvLog[i].join(",") << '\n';
+      // CSV headers from first row of source file
+      output << logModel->fields().join(",") << '\n';
+      for (int i = first; i < end; i++) {
+        output << logModel->recordLine(i) << '\n';
       }
     }
-    sessionCsvLog.clear();
   }
 }
 
@@ -660,46 +647,22 @@ bool LogsDialog::cvsFileParse()
   if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) { // reading HEX TEXT file
     return false;
   }
-  else {
-    csvlog.clear();
-    logFilename.clear();
-    QTextStream inputStream(&file);
-    QString buffer = file.readLine();
-
-    if (buffer.startsWith("Date,Time")) {
-      file.reset();
-    }
-    else {
-      return false;
-    }
-
-    int numfields=-1;
-    while (!file.atEnd()) {
-      QString line = file.readLine().trimmed();
-      QStringList columns = line.split(',');
-      if (numfields==-1) {
-        numfields=columns.count();
-      }
-      if (columns.count()==numfields) {
-        csvlog.append(columns);
-      }
-      else {
-        errors++;
-      }
-      lines++;
-    }
 
-    logFilename = QFileInfo(file.fileName()).baseName();
+  logFilename.clear();
+  bool result = logModel->parse(file, errors, lines);
+  file.close();
+  if (!result) {
+    return false;
   }
+  logFilename = QFileInfo(file.fileName()).baseName();
 
-  file.close();
   if (errors > 1) {
     QMessageBox::warning(this, CPN_STR_APP_NAME, tr("The selected logfile contains %1 invalid lines out of  %2 total lines").arg(errors).arg(lines));
   }
 
-  int n = csvlog.count();
-  if (n == 1) {
-    csvlog.clear();
+  if (logModel->rowCount() == 0) {
+    ui->FieldsTW->clear();
+    ui->FieldsTW->setRowCount(0);
     return false;
   }
 
@@ -715,14 +678,6 @@ struct FlightSession {
   QDateTime end;
 };
 
-QDateTime LogsDialog::getRecordTimeStamp(int index)
-{
-  QString tstamp = csvlog.at(index).at(0) + " " + csvlog.at(index).at(1);
-  if (csvlog.at(index).at(1).contains("."))
-    return QDateTime::fromString(tstamp, "yyyy-MM-dd HH:mm:ss.zzz");
-  return QDateTime::fromString(tstamp, "yyyy-MM-dd HH:mm:ss");
-}
-
 QString LogsDialog::generateDuration(const QDateTime & start, const QDateTime & end)
 {
   int secs = start.secsTo(end);
@@ -740,35 +695,25 @@ void LogsDialog::setFlightSessions()
   ui->sessions_CB->clear();
   ui->SaveSession_PB->setEnabled(false);
 
-  int n = csvlog.count();
+  int n = logModel->rowCount();
   // qDebug() << "records" << n;
 
-  // find session breaks
-  QList<int> sessions;
-  QDateTime lastvalue;
-  for (int i = 1; i < n; i++) {
-    QDateTime tmp = getRecordTimeStamp(i);
-    if (!lastvalue.isValid() || lastvalue.secsTo(tmp) > 60) {
-      sessions.push_back(i-1);
-      // qDebug() << "session index" << i-1;
-    }
-    lastvalue = tmp;
-  }
-  sessions.push_back(n-1);
+  // session breaks were found when the log was parsed
+  const QList<int> & sessions = logModel->sessions();
 
   //now construct a list of sessions with their times
   //total time
   int noSesions = sessions.size()-1;
   QString label = QString("%1 ").arg(noSesions);
   label += tr(noSesions > 1 ? "sessions" : "session");
-  label += " <" + tr("time span") + generateDuration(getRecordTimeStamp(1), getRecordTimeStamp(n-1)) + ">";
+  label += " <" + tr("time span") + generateDuration(logModel->recordTime(0), logModel->recordTime(n-1)) + ">";
   ui->sessions_CB->addItem(label);
 
   // add individual sessions
   if (sessions.size() > 2) {
     for (int i = 1; i < sessions.size(); i++) {
-      QDateTime sessionStart = getRecordTimeStamp(sessions.at(i-1)+1);
-      QDateTime sessionEnd = getRecordTimeStamp(sessions.at(i));
+      QDateTime sessionStart = logModel->recordTime(sessions.at(i-1));
+      QDateTime sessionEnd = logModel->recordTime(sessions.at(i)-1);
       QString label = sessionStart.toString("HH:mm:ss") + " <" + tr("duration ") + generateDuration(sessionStart, sessionEnd) + ">";
       ui->sessions_CB->addItem(label, sessions.at(i-1));
       // qDebug() << "added label" << label << sessions.at(i-1);
@@ -788,13 +733,13 @@ void LogsDialog::on_sessions_CB_currentIndexChanged(int index)
     if (index < ui->sessions_CB->count() - 1) {
       bottom = ui->sessions_CB->itemData(index + 1, Qt::UserRole).toInt();
     } else {
-      bottom = ui->logTable->rowCount();
+      bottom = logModel->rowCount();
     }
 
-    QModelIndex topLeft = ui->logTable->model()->index(
+    QModelIndex topLeft = logModel->index(
       ui->sessions_CB->itemData(index, Qt::UserRole).toInt(), 0 , QModelIndex());
-    QModelIndex bottomRight = ui->logTable->model()->index(
-      bottom - 1, ui->logTable->columnCount() - 1, QModelIndex());
+    QModelIndex bottomRight = logModel->index(
+      bottom - 1, logModel->columnCount() - 1, QModelIndex());
 
     QItemSelection selection(topLeft, bottomRight);
     ui->logTable->selectionModel()->select(selection, QItemSelectionModel::Select);
@@ -833,7 +778,7 @@ void LogsDialog::plotLogs()
     std::sort(selectedRows.begin(), selectedRows.end());
   } else {
     hasLogSelection = false;
-    rowCount = ui->logTable->rowCount();
+    rowCount = logModel->rowCount();
   }
 
   plots.min_x = QDateTime::currentDateTime().toTime_t();
@@ -848,36 +793,21 @@ void LogsDialog::plotLogs()
     plotCoords.yaxis = firstLeft;
     plotCoords.name = plot->text();
 
+    const QVector<double> & values = logModel->values(plotColumn);
+    plotCoords.x.reserve(rowCount);
+    plotCoords.y.reserve(rowCount);
+
     for (int row = 0; row < rowCount; row++) {
-      QTableWidgetItem *logValue;
-      double y;
-      double time;
-      QString time_str;
-
-      if (hasLogSelection) {
-        logValue = ui->logTable->item(selectedRows.at(row), plotColumn);
-        time_str = ui->logTable->item(selectedRows.at(row), 0)->text() +
-          QString(" ") + ui->logTable->item(selectedRows.at(row), 1)->text();
-      } else {
-        logValue = ui->logTable->item(row, plotColumn);
-        time_str = ui->logTable->item(row, 0)->text() + QString(" ") +
-          ui->logTable->item(row, 1)->text();
-      }
+      // the table rows are the log records
+      int record = (hasLogSelection ? selectedRows.at(row) : row);
 
-      y = logValue->text().toDouble();
+      double y = values.at(record);
       plotCoords.y.push_back(y);
 
       if (plotCoords.min_y > y) plotCoords.min_y = y;
       if (plotCoords.max_y < y) plotCoords.max_y = y;
 
-      if (time_str.contains('.')) {
-        time = QDateTime::fromString(time_str, "yyyy-MM-dd HH:mm:ss.zzz")
-          .toTime_t();
-        time += time_str.mid(time_str.indexOf('.')).toDouble();
-      } else {
-        time = QDateTime::fromString(time_str, "yyyy-MM-dd HH:mm:ss")
-          .toTime_t();
-      }
+      double time = logModel->timestamp(record);
       plotCoords.x.push_back(time);
 
       if (plots.min_x > time) plots.min_x = time;
@@ -973,6 +903,11 @@ void LogsDialog::plotLogs()
 
   removeAllGraphs();
 
+  plottedCoords.clear();
+  for (int i = 0; i < plots.coords.size(); i++) {
+    plottedCoords.append(plots.coords.at(i));
+  }
+
   axisRect->axis(QCPAxis::atBottom)->setRange(plots.min_x, plots.max_x);
 
   axisRect->axis(QCPAxis::atLeft)->setRange(yAxesRanges[firstLeft].min,
@@ -1045,14 +980,14 @@ void LogsDialog::plotLogs()
         break;
     }
 
-    ui->customPlot->graph(i)->setData(plots.coords.at(i).x,
-      plots.coords.at(i).y);
+    setGraphData(i, axisRect->axis(QCPAxis::atBottom)->range());
     pen.setColor(colors.at(i % colors.size()));
     ui->customPlot->graph(i)->setPen(pen);
 
     if (!tracerMaxAlt && (plots.coords.at(i).name.endsWith("(m)") ||
         plots.coords.at(i).name.endsWith(" Alt") ||
         plots.coords.at(i).name.endsWith("(ft)"))) {
+      cursorGraph = i;
       addMaxAltitudeMarker(plots.coords.at(i), ui->customPlot->graph(i));
       countNumberOfThrows(plots.coords.at(i), ui->customPlot->graph(i));
       addCursor(&cursorA, ui->customPlot->graph(i), Qt::blue);
@@ -1066,6 +1001,61 @@ void LogsDialog::plotLogs()
   ui->customPlot->replot();
 }
 
+void LogsDialog::xAxisChangeRange(QCPRange range)
+{
+  for (int i = 0; i < plottedCoords.size() && i < ui->customPlot->graphCount(); i++) {
+    setGraphData(i, range);
+  }
+}
+
+// Give the graph only the points needed to draw it in the time range: in each pixel
+// column the first, last, min and max points, in time order. The drawn line is the
+// same as with all the points, and the full log is kept in plottedCoords for zooming.
+void LogsDialog::setGraphData(int index, const QCPRange & range)
+{
+  const coords_t & c = plottedCoords.at(index);
+  int width = qMax(axisRect->width(), 100);
+  int count = c.x.size();
+
+  if (count <= 4 * width || !std::is_sorted(c.x.begin(), c.x.end())) {
+    ui->customPlot->graph(index)->setData(c.x, c.y);
+    return;
+  }
+
+  int first = std::lower_bound(c.x.begin(), c.x.end(), range.lower) - c.x.begin();
+  int last = std::upper_bound(c.x.begin(), c.x.end(), range.upper) - c.x.begin();
+  // keep the points just outside of the range, the line goes to the plot edges
+  if (first > 0) first--;
+  if (last < count) last++;
+
+  QVector<double> x, y;
+  x.reserve(qMin(last - first, 4 * (width + 2)));
+  y.reserve(qMin(last - first, 4 * (width + 2)));
+
+  double bucketWidth = range.size() / width;
+  int i = first;
+  while (i < last) {
+    int bucket = (bucketWidth > 0 ? qBound(-1, (int)floor((c.x.at(i) - range.lower) / bucketWidth), width) : 0);
+    int points[4] = { i, i, i, i };  // first, min, max, last
+    for (i++; i < last; i++) {
+      if (bucketWidth > 0 && qBound(-1, (int)floor((c.x.at(i) - range.lower) / bucketWidth), width) != bucket)
+        break;
+      if (c.y.at(i) < c.y.at(points[1])) points[1] = i;
+      if (c.y.at(i) > c.y.at(points[2])) points[2] = i;
+      points[3] = i;
+    }
+    std::sort(points, points + 4);
+    for (int j = 0; j < 4; j++) {
+      if (j == 0 || points[j] != points[j - 1]) {
+        x.append(c.x.at(points[j]));
+        y.append(c.y.at(points[j]));
+      }
+    }
+  }
+
+  ui->customPlot->graph(index)->setData(x, y);
+}
+
 void LogsDialog::yAxisChangeRanges(QCPRange range)
 {
   if (axisRect->axis(QCPAxis::atRight)->visible()) {
@@ -1109,6 +1099,16 @@ void LogsDialog::yAxisChangeRanges(QCPRange range)
 }
 
 
+// The tracers are placed on the log samples, and not attached to the graph: it
+// only gets the decimated points, the readouts would not be the logged values.
+void LogsDialog::placeTracer(QCPItemTracer * tracer, QCPGraph * graph, double x, double y)
+{
+  tracer->setGraph(0);
+  tracer->position->setType(QCPItemPosition::ptPlotCoords);
+  tracer->position->setAxes(graph->keyAxis(), graph->valueAxis());
+  tracer->position->setCoords(x, y);
+}
+
 void LogsDialog::addMaxAltitudeMarker(const coords_t & c, QCPGraph * graph) {
   // find max altitude
   int positionIndex = 0;
@@ -1127,14 +1127,11 @@ void LogsDialog::addMaxAltitudeMarker(const coords_t & c, QCPGraph * graph) {
   // add max altitude marker
   tracerMaxAlt = new QCPItemTracer(ui->customPlot);
   ui->customPlot->addItem(tracerMaxAlt);
-  tracerMaxAlt->setGraph(graph);
-  tracerMaxAlt->setInterpolating(true);
   tracerMaxAlt->setStyle(QCPItemTracer::tsSquare);
   tracerMaxAlt->setPen(QPen(Qt::blue));
   tracerMaxAlt->setBrush(Qt::NoBrush);
   tracerMaxAlt->setSize(7);
-  tracerMaxAlt->setGraphKey(c.x.at(positionIndex));
-  tracerMaxAlt->updatePosition();
+  placeTracer(tracerMaxAlt, graph, c.x.at(positionIndex), c.y.at(positionIndex));
 }
 
 void LogsDialog::countNumberOfThrows(const coords_t & c, QCPGraph * graph)
@@ -1154,8 +1151,7 @@ void LogsDialog::countNumberOfThrows(const coords_t & c, QCPGraph * graph)
 void LogsDialog::addCursor(QCPItemTracer ** cursor, QCPGraph * graph, const QColor & color) {
   QCPItemTracer * c = new QCPItemTracer(ui->customPlot);
   ui->customPlot->addItem(c);
-  c->setGraph(graph);
-  c->setInterpolating(false);
+  c->position->setAxes(graph->keyAxis(), graph->valueAxis());
   c->setStyle(QCPItemTracer::tsCrosshair);
   QPen pen(color);
   pen.setStyle(Qt::DashLine);
@@ -24,6 +24,7 @@
 #include <QtCore>
 #include <QDialog>
 #include "qcustomplot.h"
+#include "logmodel.h"
 
 #define INVALID_MIN 999999
 #define INVALID_MAX -999999
@@ -82,9 +83,10 @@ private slots:
   void on_sessions_CB_currentIndexChanged(int index);
   void on_mapsButton_clicked();
   void yAxisChangeRanges(QCPRange range);
+  void xAxisChangeRange(QCPRange range);
 
 private:
-  QList<QStringList> csvlog;
+  LogModel * logModel;
   Ui::LogsDialog *ui;
   QCPAxisRect *axisRect;
   QCPLegend *rightLegend;
@@ -102,13 +104,16 @@ private:
   QCPItemTracer * cursorB;
   QCPItemStraightLine * cursorLine;
 
+  QVector<coords_t> plottedCoords;  // all the points of the graphs, they get a decimated copy
+  int cursorGraph;                  // the cursors are on this graph, placed on its points in plottedCoords
+
   bool cvsFileParse();
-  QList<QStringList> filterGePoints(const QList<QStringList> & input);
+  QVector<int> filterGePoints();
   void exportToGoogleEarth();
-  QDateTime getRecordTimeStamp(int index);
   QString generateDuration(const QDateTime & start, const QDateTime & end);
   void setFlightSessions();
 
+  void placeTracer(QCPItemTracer * tracer, QCPGraph * graph, double x, double y);
   void addMaxAltitudeMarker(const coords_t & c, QCPGraph * graph);
   void countNumberOfThrows(const coords_t & c, QCPGraph * graph);
   void addCursor(QCPItemTracer ** cursor, QCPGraph * graph, const QColor & color);
@@ -116,6 +121,7 @@ private:
   void placeCursor(double x, bool second);
   QString formatTimeDelta(double timeDelta);
   void updateCursorsLabel();
+  void setGraphData(int index, const QCPRange & range);
 
 
 };
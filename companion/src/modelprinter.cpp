@@ -717,15 +717,12 @@ void CurveImage::drawCurve(const CurveData & curve, QColor color)
   }
 }
 
-QString ModelPrinter::createCurveImage(int idx, QTextDocument * document)
+// may be called from a worker thread
+QImage ModelPrinter::createCurveImage(int idx)
 {
   CurveImage image;
   image.drawCurve(model.curves[idx], colors[idx]);
-  QString filename = QString("mydata://curve-%1-%2.png").arg((uint64_t)this).arg(idx);
-  if (document)
-    document->addResource(QTextDocument::ImageResource, QUrl(filename), image.get());
-  // qDebug() << "ModelPrinter::createCurveImage()" << idx << filename;
-  return filename;
+  return image.get();
 }
 
 QString ModelPrinter::printGlobalVarUnit(int idx)
@@ -76,7 +76,7 @@ class ModelPrinter: public QObject
     QString printChannelName(int idx);
     QString printCurveName(int idx);
     QString printCurve(int idx);
-    QString createCurveImage(int idx, QTextDocument * document);
+    QImage createCurveImage(int idx);
     QString printGlobalVarUnit(int idx);
     QString printGlobalVarPrec(int idx);
     QString printGlobalVarMin(int idx);
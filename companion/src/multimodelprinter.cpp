@@ -23,6 +23,8 @@
 #include "multimodelprinter.h"
 #include "appdata.h"
 #include <algorithm>
+#include <QCryptographicHash>
+#include <QRunnable>
 
 MultiModelPrinter::MultiColumns::MultiColumns(int count):
   count(count),
@@ -223,6 +225,52 @@ void MultiModelPrinter::MultiColumns::appendFieldSeparator(const bool sep)
   COMPARE(what); \
   columns.appendFieldSeparator(sep);
 
+// Renders one section of the document, in a worker thread
+class MultiModelPrinter::SectionTask: public QRunnable
+{
+  public:
+    SectionTask(MultiModelPrinter * printer, SectionPrinter section, QString * result):
+      printer(printer),
+      section(section),
+      result(result)
+    {
+    }
+
+    void run() override
+    {
+      *result = (printer->*section)();
+    }
+
+  protected:
+    MultiModelPrinter * printer;
+    SectionPrinter section;
+    QString * result;
+};
+
+// Renders the curves images of one model, in a worker thread
+class MultiModelPrinter::CurvesTask: public QRunnable
+{
+  public:
+    CurvesTask(ModelPrinter * modelPrinter, const QVector<int> & curves, QVector<QImage> * result):
+      modelPrinter(modelPrinter),
+      curves(curves),
+      result(result)
+    {
+    }
+
+    void run() override
+    {
+      for (int idx: curves) {
+        result->append(modelPrinter->createCurveImage(idx));
+      }
+    }
+
+  protected:
+    ModelPrinter * modelPrinter;
+    QVector<int> curves;
+    QVector<QImage> * result;
+};
+
 QString MultiModelPrinter::printTitle(const QString & label)
 {
   return QString("<tr><td class=mpc-section-title colspan='%1'>").arg(modelPrinterMap.count()) + label + "</td></tr>";
@@ -248,6 +296,11 @@ void MultiModelPrinter::setModel(int idx, const ModelData * model, const General
 
   QPair<const ModelData *, ModelPrinter *> pair(model, new ModelPrinter(firmware, *generalSettings, *model));
   modelPrinterMap.insert(idx, pair);  // QMap.insert will replace any existing key
+
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  hash.addData(reinterpret_cast<const char *>(model), sizeof(ModelData));
+  hash.addData(reinterpret_cast<const char *>(generalSettings), sizeof(GeneralSettings));
+  modelHashes.insert(idx, hash.result());
 }
 
 void MultiModelPrinter::setModel(int idx, const ModelData * model)
@@ -262,6 +315,59 @@ void MultiModelPrinter::clearModels()
       delete modelPrinterMap.value(i).second;
   }
   modelPrinterMap.clear();
+  modelHashes.clear();
+}
+
+bool MultiModelPrinter::isCurveUsed(int idx)
+{
+  for (int k=0; k < modelPrinterMap.size(); k++) {
+    if (!modelPrinterMap.value(k).first->curves[idx].isEmpty())
+      return true;
+  }
+  return false;
+}
+
+QString MultiModelPrinter::curveImageName(int modelIdx, int curveIdx)
+{
+  return QString("mydata://curve-%1-%2.png").arg(QString(modelHashes.value(modelIdx).toHex())).arg(curveIdx);
+}
+
+// Renders the images of the models which were not in the previous print, and adds all of them to the document
+void MultiModelPrinter::renderCurves(QTextDocument * document)
+{
+  QVector<int> curves;
+  for (int i=0; i<firmware->getCapability(NumCurves); i++) {
+    if (isCurveUsed(i))
+      curves.append(i);
+  }
+
+  QHash<QByteArray, QImage> images;
+  QVector<QVector<QImage>> rendered(modelPrinterMap.size());
+  for (int k=0; k < modelPrinterMap.size(); k++) {
+    bool cached = true;
+    for (int i: curves) {
+      QByteArray key = modelHashes.value(k) + QByteArray::number(i);
+      if (!curvesCache.contains(key)) {
+        cached = false;
+        break;
+      }
+      images.insert(key, curvesCache.value(key));
+    }
+    if (!cached)
+      threadPool.start(new CurvesTask(modelPrinterMap.value(k).second, curves, &rendered.data()[k]));
+  }
+  threadPool.waitForDone();
+
+  for (int k=0; k < modelPrinterMap.size(); k++) {
+    for (int j=0; j < rendered[k].size(); j++) {
+      images.insert(modelHashes.value(k) + QByteArray::number(curves[j]), rendered[k][j]);
+    }
+    for (int i: curves) {
+      if (document)
+        document->addResource(QTextDocument::ImageResource, QUrl(curveImageName(k, i)), images.value(modelHashes.value(k) + QByteArray::number(i)));
+    }
+  }
+  curvesCache = images;
 }
 
 QString MultiModelPrinter::print(QTextDocument * document)
@@ -270,35 +376,61 @@ QString MultiModelPrinter::print(QTextDocument * document)
   Stylesheet css(MODEL_PRINT_CSS);
   if (css.load(Stylesheet::StyleType::STYLE_TYPE_EFFECTIVE))
     document->setDefaultStyleSheet(css.text());
-  QString str = "<table cellspacing='0' cellpadding='3' width='100%'>";   // attributes not settable via QT stylesheet
-  str.append(printSetup());
+  renderCurves(document);
+
+  QVector<SectionPrinter> sections;
+  sections << &MultiModelPrinter::printSetup;
   if (firmware->getCapability(HasDisplayText))
-    str.append(printChecklist());
+    sections << &MultiModelPrinter::printChecklist;
   if (firmware->getCapability(Timers)) {
-    str.append(printTimers());
+    sections << &MultiModelPrinter::printTimers;
   }
-  str.append(printModules());
+  sections << &MultiModelPrinter::printModules;
   if (firmware->getCapability(Heli))
-    str.append(printHeliSetup());
+    sections << &MultiModelPrinter::printHeliSetup;
   if (firmware->getCapability(FlightModes))
-    str.append(printFlightModes());
-  str.append(printInputs());
-  str.append(printMixers());
-  str.append(printOutputs());
-  str.append(printCurves(document));
+    sections << &MultiModelPrinter::printFlightModes;
+  sections << &MultiModelPrinter::printInputs;
+  sections << &MultiModelPrinter::printMixers;
+  sections << &MultiModelPrinter::printOutputs;
+  sections << &MultiModelPrinter::printCurves;
   if (firmware->getCapability(Gvars) && !firmware->getCapability(GvarsFlightModes))
-    str.append(printGvars());
-  str.append(printLogicalSwitches());
+    sections << &MultiModelPrinter::printGvars;
+  sections << &MultiModelPrinter::printLogicalSwitches;
   if (firmware->getCapability(GlobalFunctions))
-    str.append(printGlobalFunctions());
-  str.append(printSpecialFunctions());
+    sections << &MultiModelPrinter::printGlobalFunctions;
+  sections << &MultiModelPrinter::printSpecialFunctions;
   if (firmware->getCapability(Telemetry)) {
-    str.append(printTelemetry());
-    str.append(printSensors());
+    sections << &MultiModelPrinter::printTelemetry;
+    sections << &MultiModelPrinter::printSensors;
     if (firmware->getCapability(TelemetryCustomScreens)) {
-      str.append(printTelemetryScreens());
+      sections << &MultiModelPrinter::printTelemetryScreens;
     }
   }
+
+  // each section compares all the models, it only has to be rendered again when one of them has changed
+  QByteArray modelsKey;
+  for (int k=0; k < modelHashes.size(); k++) {
+    modelsKey.append(modelHashes.value(k));
+  }
+
+  QVector<QString> results(sections.size());
+  QString * result = results.data();
+  for (int i=0; i < sections.size(); i++) {
+    QByteArray key = modelsKey + QByteArray::number(i);
+    if (sectionsCache.contains(key))
+      result[i] = sectionsCache.value(key);
+    else
+      threadPool.start(new SectionTask(this, sections[i], &result[i]));
+  }
+  threadPool.waitForDone();
+
+  sectionsCache.clear();
+  QString str = "<table cellspacing='0' cellpadding='3' width='100%'>";   // attributes not settable via QT stylesheet
+  for (int i=0; i < sections.size(); i++) {
+    sectionsCache.insert(modelsKey + QByteArray::number(i), results[i]);
+    str.append(results[i]);
+  }
   str.append("</table>");
   return str;
 }
@@ -652,21 +784,14 @@ QString MultiModelPrinter::printMixers()
   return str;
 }
 
-QString MultiModelPrinter::printCurves(QTextDocument * document)
+QString MultiModelPrinter::printCurves()
 {
   QString str;
   MultiColumns columns(modelPrinterMap.size());
   int count = 0;
   columns.appendSectionTableStart();
   for (int i=0; i<firmware->getCapability(NumCurves); i++) {
-    bool curveEmpty = true;
-    for (int k=0; k < modelPrinterMap.size(); k++) {
-      if (!modelPrinterMap.value(k).first->curves[i].isEmpty()) {
-        curveEmpty = false;
-        break;
-      }
-    }
-    if (!curveEmpty) {
+    if (isCurveUsed(i)) {
       count++;
       columns.appendRowStart();
       columns.appendCellStart(20, true);
@@ -677,7 +802,7 @@ QString MultiModelPrinter::printCurves(QTextDocument * document)
       columns.appendRowStart("", 20);
       columns.appendCellStart();
       for (int k=0; k < modelPrinterMap.size(); k++)
-        columns.append(k, QString("<br/><img src='%1' border='0' /><br/>").arg(modelPrinterMap.value(k).second->createCurveImage(i, document)));
+        columns.append(k, QString("<br/><img src='%1' border='0' /><br/>").arg(curveImageName(k, i)));
       columns.appendCellEnd();
       columns.appendRowEnd();
     }
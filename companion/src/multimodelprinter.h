@@ -23,6 +23,8 @@
 
 #include <QObject>
 #include <QTextDocument>
+#include <QThreadPool>
+#include <QImage>
 #include "eeprominterface.h"
 #include "modelprinter.h"
 
@@ -73,9 +75,22 @@ class MultiModelPrinter: public QObject
         QString * compareColumns;
     };
 
+    class SectionTask;
+    class CurvesTask;
+    typedef QString (MultiModelPrinter::*SectionPrinter)();
+
     Firmware * firmware;
     GeneralSettings defaultSettings;
     QMap<int, QPair<const ModelData *, ModelPrinter *> > modelPrinterMap;
+    QMap<int, QByteArray> modelHashes;  // content of the model and its radio settings
+    // sections and curves rendered by the last print(), keyed by the content of the models
+    QHash<QByteArray, QString> sectionsCache;
+    QHash<QByteArray, QImage> curvesCache;
+    QThreadPool threadPool;
+
+    bool isCurveUsed(int idx);
+    QString curveImageName(int modelIdx, int curveIdx);
+    void renderCurves(QTextDocument * document);
 
     QString printTitle(const QString & label);
     QString printSetup();
@@ -85,7 +100,7 @@ class MultiModelPrinter: public QObject
     QString printOutputs();
     QString printInputs();
     QString printMixers();
-    QString printCurves(QTextDocument * document);
+    QString printCurves();
     QString printGvars();
     QString printLogicalSwitches();
     QString printSpecialFunctions();
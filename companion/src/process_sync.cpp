@@ -24,8 +24,18 @@
 #include <QCryptographicHash>
 #include <QElapsedTimer>
 #include <QMutexLocker>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStorageInfo>
+#include <QTextStream>
 
 #define SYNC_MAX_ERRORS       50  // give up after this many errors per destination
+#define SYNC_MANIFEST_DIR     "sync"  // hashes caches, in the Companion data folder
+#define SYNC_HASH_BLOCK_SIZE  (64 * 1024)
+#define SYNC_MTIME_RESOLUTION 2000  // ms, FAT file times
+#define SYNC_COPY_THREADS     4  // concurrent copies, bounds the I/O load on the destination
+#define SYNC_COPY_QUEUE       (4 * SYNC_COPY_THREADS)  // copies started and not collected yet
 
 // a flood of log messages can make the UI unresponsive so we'll introduce a dynamic sleep period based on log frequency (values in [us])
 #define PAUSE_FACTOR          60UL
@@ -52,9 +62,88 @@
   #define FILTER_RE_SYNTX     QRegExp::WildcardUnix
 #endif
 
+// The hashes cache of a folder is kept on the computer, never written into the folder itself (radio SD card).
+// Different SD cards can be mounted at the same path, so the volume is part of the key.
+static QString manifestPath(const QString & folder)
+{
+  const QStorageInfo volume(folder);
+  const QString key = QString("%1\n%2\n%3\n%4").arg(QDir(folder).absolutePath(), QString(volume.device()), volume.name(), QString::number(volume.bytesTotal()));
+  const QString name = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex();
+  return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).absoluteFilePath(SYNC_MANIFEST_DIR "/" + name);
+}
+
+// MD5 of a file content, read by blocks
+static bool hashFile(const QString & path, QByteArray & hash, QString & error)
+{
+  QFile file(path);
+  if (!file.open(QFile::ReadOnly)) {
+    error = file.errorString();
+    return false;
+  }
+  QCryptographicHash md5(QCryptographicHash::Md5);
+  QByteArray buffer(SYNC_HASH_BLOCK_SIZE, Qt::Uninitialized);
+  qint64 len;
+  while ((len = file.read(buffer.data(), buffer.size())) > 0)
+    md5.addData(buffer.constData(), len);
+  if (len < 0) {
+    error = file.errorString();
+    return false;
+  }
+  hash = md5.result();
+  return true;
+}
+
+class HashTask : public QRunnable
+{
+  public:
+    explicit HashTask(const QString & path) : path(path), result(false) { setAutoDelete(false); }
+    void run() override { result = hashFile(path, hash, error); }
+
+    QString path;
+    QByteArray hash;
+    QString error;
+    bool result;
+};
+
+// Replaces the destination file, the results are collected by the sync thread (see collectCopies())
+class CopyTask : public QRunnable
+{
+  public:
+    CopyTask(const QString & srcPath, const QString & destPath, const QDir & destination, const QString & relPath, const QByteArray & hash, bool existed) :
+      srcPath(srcPath), destPath(destPath), destination(destination), relPath(relPath), hash(hash), existed(existed), removeFailed(false), result(false)
+    {
+      setAutoDelete(false);
+    }
+
+    void run() override
+    {
+      QFile destinationFile(destPath);
+      if (existed && !destinationFile.remove()) {
+        removeFailed = true;
+        error = destinationFile.errorString();
+        return;
+      }
+      QFile sourceFile(srcPath);
+      result = sourceFile.copy(destPath);
+      if (!result)
+        error = sourceFile.errorString();
+    }
+
+    QString srcPath;
+    QString destPath;
+    QDir destination;
+    QString relPath;
+    QByteArray hash;  // source content, empty if not known
+    bool existed;
+    bool removeFailed;
+    QString error;
+    bool result;
+};
+
 SyncProcess::SyncProcess(const SyncProcess::SyncOptions & options) :
   m_options(options),
   m_pauseTime(PAUSE_MINTM),
+  m_hashCount(0),
   stopping(false)
 {
   qRegisterMetaType<SyncProcess::SyncStatus>();
@@ -77,6 +166,10 @@ SyncProcess::SyncProcess(const SyncProcess::SyncOptions & options) :
   if (m_options.flags & OPT_DRY_RUN)
     testRunStr = tr("[TEST RUN] ");
 
+  // the destination file is hashed in the background while the source one is read
+  m_hashPool.setMaxThreadCount(1);
+  m_copyPool.setMaxThreadCount(SYNC_COPY_THREADS);
+
   //qDebug() << m_options;
 #ifdef Q_OS_WIN
   qt_ntfs_permission_lookup++;  // global enable NTFS permissions checking
@@ -112,7 +205,11 @@ void SyncProcess::run()
   int count = 0;
 
   m_stat.clear();
+  m_hashCount = 0;
   m_startTime = QDateTime::currentDateTime();
+  m_manifests.clear();
+  loadManifest(folderA);
+  loadManifest(folderB);
 
   emit started();
   emit fileCountChanged(0);
@@ -166,9 +263,84 @@ void SyncProcess::run()
   }
 
   endrun:
+  // the hashes only describe the files as they are, a test run keeps them as well
+  saveManifest(folderA);
+  saveManifest(folderB);
   finish();
 }
 
+void SyncProcess::loadManifest(const QString & folder)
+{
+  Manifest & manifest = m_manifests[QDir(folder).absolutePath()];
+  QFile file(manifestPath(folder));
+  if (!file.open(QFile::ReadOnly | QFile::Text))
+    return;
+
+  // one file per line: <md5>\t<size>\t<modified>\t<path>
+  QTextStream stream(&file);
+  stream.setCodec("UTF-8");
+  QString line;
+  while (stream.readLineInto(&line)) {
+    const QStringList fields = line.split('\t');
+    if (fields.size() != 4)
+      continue;
+    ManifestEntry entry;
+    entry.hash = QByteArray::fromHex(fields.at(0).toLatin1());
+    entry.size = fields.at(1).toLongLong();
+    entry.modified = fields.at(2).toLongLong();
+    if (entry.hash.size() == 16)
+      manifest.insert(fields.at(3), entry);
+  }
+}
+
+void SyncProcess::saveManifest(const QString & folder)
+{
+  const QDir dir(folder);
+  const Manifest manifest = m_manifests.value(dir.absolutePath());
+  if (manifest.isEmpty() || !dir.exists())
+    return;
+
+  const QString path = manifestPath(folder);
+  QDir().mkpath(QFileInfo(path).absolutePath());
+  QSaveFile file(path);
+  if (!file.open(QFile::WriteOnly | QFile::Text)) {
+    qDebug() << "Could not write sync manifest" << file.fileName() << file.errorString();
+    return;
+  }
+  QTextStream stream(&file);
+  stream.setCodec("UTF-8");
+  for (Manifest::const_iterator it = manifest.constBegin(), end = manifest.constEnd(); it != end; ++it) {
+    if (dir.exists(it.key()))  // forget the deleted files
+      stream << it.value().hash.toHex() << '\t' << it.value().size << '\t' << it.value().modified << '\t' << it.key() << '\n';
+  }
+  stream.flush();
+  file.commit();
+}
+
+bool SyncProcess::getCachedHash(const QDir & folder, const QString & path, const QFileInfo & fileInfo, QByteArray & hash)
+{
+  const Manifest & manifest = m_manifests[folder.absolutePath()];
+  Manifest::const_iterator it = manifest.constFind(path);
+  if (it == manifest.constEnd() || it.value().size != fileInfo.size() || it.value().modified != fileInfo.lastModified().toMSecsSinceEpoch())
+    return false;
+  hash = it.value().hash;
+  return true;
+}
+
+void SyncProcess::setCachedHash(const QDir & folder, const QString & path, const QFileInfo & fileInfo, const QByteArray & hash)
+{
+  // a file written again within the resolution of its time could keep its size and time
+  if (fileInfo.lastModified().msecsTo(QDateTime::currentDateTime()) < SYNC_MTIME_RESOLUTION) {
+    m_manifests[folder.absolutePath()].remove(path);
+    return;
+  }
+
+  ManifestEntry & entry = m_manifests[folder.absolutePath()][path];
+  entry.size = fileInfo.size();
+  entry.modified = fileInfo.lastModified().toMSecsSinceEpoch();
+  entry.hash = hash;
+}
+
 void SyncProcess::finish()
 {
   const lldiv_t elapsed = lldiv(m_startTime.secsTo(QDateTime::currentDateTime()), 60);
@@ -288,6 +460,10 @@ void SyncProcess::updateDir(const QString & source, const QString & destination)
     pause();
   }
 
+  // the other direction must see the copied files
+  m_copyPool.waitForDone();
+  collectCopies();
+
   QString endStr = "\n" % testRunStr;
   if (isStopRequsted())
     endStr.append(tr("Aborted synchronization of:"));
@@ -303,8 +479,10 @@ bool SyncProcess::updateEntry(const QString & entry, const QDir & source, const
 {
   const QString srcPath = QDir::toNativeSeparators(source.absoluteFilePath(entry));
   const QString destPath = QDir::toNativeSeparators(destination.absoluteFilePath(source.relativeFilePath(entry)));
+  const QString relPath = source.relativeFilePath(entry);
   const QFileInfo sourceInfo(srcPath);
   const QFileInfo destInfo(destPath);
+  QByteArray sourceHash;
   static QString lastMkPath;
 
   // check if this is a directory OR if we're copying a file with a path which doesn't exist yet.
@@ -336,8 +514,6 @@ bool SyncProcess::updateEntry(const QString & entry, const QDir & source, const
   }
 
   //qDebug() << destPath;
-  QFile sourceFile(srcPath);
-  QFile destinationFile(destPath);
   const bool destExists = destInfo.exists();
   bool checkDate = (m_options.compareType == OVERWR_NEWER_IF_DIFF || m_options.compareType == OVERWR_NEWER_ALWAYS);
   bool checkContent = (m_options.compareType == OVERWR_NEWER_IF_DIFF || m_options.compareType == OVERWR_IF_DIFF);
@@ -359,24 +535,43 @@ bool SyncProcess::updateEntry(const QString & entry, const QDir & source, const
   }
 
   if (destExists && checkContent) {
-    if (!sourceFile.open(QFile::ReadOnly)) {
-      PRINT_ERROR(tr("Could not open source file '%1': %2").arg(srcPath, sourceFile.errorString()));
-      ++m_stat.errored;
-      return false;
-    }
-    if (!destinationFile.open(QFile::ReadOnly)) {
-      PRINT_ERROR(tr("Could not open destination file '%1': %2").arg(destPath, destinationFile.errorString()));
-      ++m_stat.errored;
-      return false;
-    }
+    // files with different sizes are different, no need to read them
+    if (sourceInfo.size() == destInfo.size()) {
+      // the source hash is taken from the cache while the size and time of the file are unchanged.
+      // The destination is always read, in the background: a radio without RTC can write a file
+      // again with the same size and time, it must not be skipped as identical.
+      QByteArray destHash;
+      QString error;
+      HashTask destTask(destPath);
+      m_hashPool.start(&destTask);
+      ++m_hashCount;
+
+      if (!getCachedHash(source, relPath, sourceInfo, sourceHash)) {
+        ++m_hashCount;
+        if (!hashFile(srcPath, sourceHash, error)) {
+          m_hashPool.waitForDone();
+          PRINT_ERROR(tr("Could not open source file '%1': %2").arg(srcPath, error));
+          ++m_stat.errored;
+          return false;
+        }
+        setCachedHash(source, relPath, sourceInfo, sourceHash);
+      }
 
-    const bool skip = QCryptographicHash::hash(sourceFile.readAll(), QCryptographicHash::Md5) == QCryptographicHash::hash(destinationFile.readAll(), QCryptographicHash::Md5);
-    sourceFile.close();
-    destinationFile.close();
-    if (skip) {
-      PRINT_SKIP(tr("Skipping identical file: %1").arg(srcPath));
-      ++m_stat.skipped;
-      return true;
+      m_hashPool.waitForDone();
+      if (!destTask.result) {
+        PRINT_ERROR(tr("Could not open destination file '%1': %2").arg(destPath, destTask.error));
+        ++m_stat.errored;
+        return false;
+      }
+      destHash = destTask.hash;
+      // used when this folder is the source, in the other direction or the next sync
+      setCachedHash(destination, relPath, destInfo, destHash);
+
+      if (sourceHash == destHash) {
+        PRINT_SKIP(tr("Skipping identical file: %1").arg(srcPath));
+        ++m_stat.skipped;
+        return true;
+      }
     }
     checkContent = false;
   }
@@ -385,30 +580,57 @@ bool SyncProcess::updateEntry(const QString & entry, const QDir & source, const
     if (destInfo.exists()) {
       existed = true;
       PRINT_REPLACE(tr("Replacing file: %1").arg(destPath));
-      if (!(m_options.flags & OPT_DRY_RUN) && !destinationFile.remove()) {
-        PRINT_ERROR(tr("Could not delete destination file '%1': %2").arg(destPath, destinationFile.errorString()));
-        ++m_stat.errored;
-        return false;
-      }
     }
     else {
       PRINT_CREATE(tr("Creating file: %1").arg(destPath));
     }
-    if (!(m_options.flags & OPT_DRY_RUN) && !sourceFile.copy(destPath)) {
-      PRINT_ERROR(tr("Copy failed: '%1' to '%2': %3").arg(srcPath, destPath, sourceFile.errorString()));
-      ++m_stat.errored;
-      return false;
+
+    if (m_options.flags & OPT_DRY_RUN) {
+      if (existed)
+        ++m_stat.updated;
+      else
+        ++m_stat.created;
+      return true;
     }
 
-    if (existed)
-      ++m_stat.updated;
-    else
-      ++m_stat.created;
+    if (m_copies.size() >= SYNC_COPY_QUEUE) {
+      m_copyPool.waitForDone();
+      collectCopies();
+    }
+    CopyTask * task = new CopyTask(srcPath, destPath, destination, relPath, sourceHash, existed);
+    m_copies.append(task);
+    m_copyPool.start(task);
   }
 
   return true;
 }
 
+// counts the finished copies, called with no copy running
+void SyncProcess::collectCopies()
+{
+  for (CopyTask * task : m_copies) {
+    if (task->removeFailed) {
+      PRINT_ERROR(tr("Could not delete destination file '%1': %2").arg(task->destPath, task->error));
+      ++m_stat.errored;
+    }
+    else if (!task->result) {
+      PRINT_ERROR(tr("Copy failed: '%1' to '%2': %3").arg(task->srcPath, task->destPath, task->error));
+      ++m_stat.errored;
+    }
+    else {
+      if (!task->hash.isEmpty())
+        setCachedHash(task->destination, task->relPath, QFileInfo(task->destPath), task->hash);
+      if (task->existed)
+        ++m_stat.updated;
+      else
+        ++m_stat.created;
+    }
+    delete task;
+  }
+  m_copies.clear();
+  emit statusUpdate(m_stat);
+}
+
 void SyncProcess::pause()
 {
   QElapsedTimer tim;
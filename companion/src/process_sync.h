@@ -26,10 +26,14 @@
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
+#include <QHash>
 #include <QReadWriteLock>
 #include <QRegExp>
+#include <QThreadPool>
 #include <QVector>
 
+class CopyTask;
+
 class SyncProcess : public QObject
 {
     Q_OBJECT
@@ -121,6 +125,14 @@ class SyncProcess : public QObject
   protected:
     enum FileFilterResult { FILE_ALLOW, FILE_OVERSIZE, FILE_EXCLUDE, FILE_LINK_IGNORE };
 
+    // content hashes of a synchronized folder, kept in the Companion data folder between syncs
+    struct ManifestEntry {
+        qint64 size;
+        qint64 modified;  // ms since epoch
+        QByteArray hash;
+    };
+    typedef QHash<QString, ManifestEntry> Manifest;  // key is the path relative to the folder
+
     bool isStopRequsted();
     void finish();
     FileFilterResult fileFilter(const QFileInfo & fileInfo);
@@ -129,6 +141,11 @@ class SyncProcess : public QObject
     void updateDir(const QString & source, const QString & destination);
     void pushDirEntries(const QFileInfo & fi, QMutableListIterator<QFileInfo> &it);
     bool updateEntry(const QString & entry, const QDir & source, const QDir & destination);
+    void collectCopies();
+    void loadManifest(const QString & folder);
+    void saveManifest(const QString & folder);
+    bool getCachedHash(const QDir & folder, const QString & path, const QFileInfo & fileInfo, QByteArray & hash);
+    void setCachedHash(const QDir & folder, const QString & path, const QFileInfo & fileInfo, const QByteArray & hash);
     void pause();
     void emitProgressMessage(const QString &text, int type);
 
@@ -137,10 +154,15 @@ class SyncProcess : public QObject
     QReadWriteLock stopReqMutex;
     QString testRunStr;
     QVector<QRegExp> m_excludeFilters;
+    QHash<QString, Manifest> m_manifests;  // key is the folder absolute path
+    QThreadPool m_hashPool;
+    QThreadPool m_copyPool;
+    QList<CopyTask *> m_copies;  // started, not collected yet
     QStringList m_dirIteratorFilters;
     QDir::Filters m_dirFilters;
     QDateTime m_startTime;
     unsigned long m_pauseTime;
+    int m_hashCount;  // files read to compute their hash
     bool stopping;
 };
 
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <chrono>
+#include <functional>
+#include "gtests.h"
+#include "location.h"
+#include "storage/otx.h"
+#include "firmwares/eepromimportexport.h"
+#include "firmwares/opentx/opentxeeprom.h"
+
+TEST(DataField, StructBitsLayout)
+{
+  unsigned int a = 5, b = 0x1234;
+  int c = -3;
+  bool d = true;
+  char name[4] = "AB";
+
+  StructField field(nullptr);
+  field.Append(new UnsignedField<3>(&field, a));
+  field.Append(new SignedField<5>(&field, c));
+  field.Append(new UnsignedField<16>(&field, b));
+  field.Append(new BoolField<1>(&field, d));
+  field.Append(new SpareBitsField<7>(&field));
+  field.Append(new CharField<3>(&field, name));
+  EXPECT_EQ(field.size(), 56u);
+
+  QByteArray bytes;
+  field.Export(bytes);
+  ASSERT_EQ(bytes.size(), 7);
+  EXPECT_EQ(QByteArray("\xed\x34\x12\x01\x41\x42\x00", 7), bytes);
+
+  a = b = 0;
+  c = 0;
+  d = false;
+  name[0] = '\0';
+  EXPECT_EQ(field.Import(bytes), 0);
+  EXPECT_EQ(a, 5u);
+  EXPECT_EQ(c, -3);
+  EXPECT_EQ(b, 0x1234u);
+  EXPECT_EQ(d, true);
+  EXPECT_STREQ(name, "AB");
+
+  EXPECT_EQ(field.Import(bytes.left(6)), -1);
+}
+
+// Host throughput only. The field tree is built for each model, the "tree" figure tells how much
+// a per board and version layout cache could save on an export or an import.
+TEST(DataField, ModelThroughput)
+{
+  OtxFormat otx(RADIO_TESTS_PATH "/model_22_x10.otx");
+  RadioData radio;
+  ASSERT_EQ(true, otx.load(radio));
+  const ModelData & model = radio.models[0];
+  const Board::Type board = Board::BOARD_X10;
+  const unsigned int version = 219;
+
+  QByteArray raw;
+  {
+    ModelData copy(model);
+    OpenTxModelData manager(copy, board, version, 0);
+    manager.Export(raw);
+  }
+
+  const unsigned rounds = 200;
+  auto modelsPerSecond = [&](std::function<void(ModelData &)> convert) {
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned round = 0; round < rounds; round++) {
+      ModelData copy(model);
+      convert(copy);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return double(rounds) * 1000000 / (elapsed.count() + 1);
+  };
+
+  printf("X10 model: export %.0f models/s, import %.0f models/s, tree %.0f models/s (%d bytes)\n",
+         modelsPerSecond([&](ModelData & copy) {
+           QByteArray bytes;
+           OpenTxModelData(copy, board, version, 0).Export(bytes);
+         }),
+         modelsPerSecond([&](ModelData & copy) {
+           OpenTxModelData(copy, board, version, 0).Import(raw);
+         }),
+         modelsPerSecond([&](ModelData & copy) {
+           OpenTxModelData manager(copy, board, version, 0);
+         }),
+         raw.size());
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <QBuffer>
+#include "gtests.h"
+#include "logmodel.h"
+
+static bool parseTestLog(LogModel & log, const QByteArray & content, int & errors, int & lines)
+{
+  QByteArray data(content);
+  QBuffer buffer(&data);
+  buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+  return log.parse(buffer, errors, lines);
+}
+
+TEST(Logs, parse)
+{
+  LogModel log;
+  int errors, lines;
+
+  ASSERT_TRUE(parseTestLog(log,
+    "Date,Time,RSSI(dB),Alt(m),GPS\n"
+    "2021-05-01,10:59:58.500,80,1.5,45.100000 6.200000\n"
+    "2021-05-01,10:59:59.000,81,2.5,\n"
+    "a broken,line\n"
+    "2021-05-01,11:00:00.250,82,-3.5,45.100000 6.200000\n"
+    "2021-05-01,11:02:00.000,83,4.5,45.100000 6.200000\n",
+    errors, lines));
+
+  EXPECT_EQ(errors, 1);
+  EXPECT_EQ(lines, 5);
+  EXPECT_EQ(log.rowCount(), 4);
+  EXPECT_EQ(log.columnCount(), 5);
+  EXPECT_EQ(log.fields().at(3), QString("Alt(m)"));
+  EXPECT_EQ(log.headerData(2, Qt::Horizontal).toString(), QString("RSSI(dB)"));
+
+  // the table cells are the logged texts, the plots use the values
+  EXPECT_EQ(log.data(log.index(1, 3)).toString(), QString("2.5"));
+  EXPECT_EQ(log.data(log.index(1, 4)).toString(), QString(""));
+  EXPECT_EQ(log.text(0, 4), QString("45.100000 6.200000"));
+  EXPECT_EQ(log.values(3).size(), 4);
+  EXPECT_DOUBLE_EQ(log.values(3).at(2), -3.5);
+  EXPECT_DOUBLE_EQ(log.values(2).at(3), 83);
+  EXPECT_EQ(log.recordLine(2), QString("2021-05-01,11:00:00.250,82,-3.5,45.100000 6.200000"));
+
+  // the timestamps are right across the hours
+  EXPECT_EQ(log.recordTime(0), QDateTime::fromString("2021-05-01 10:59:58.500", "yyyy-MM-dd HH:mm:ss.zzz"));
+  EXPECT_DOUBLE_EQ(log.timestamp(1) - log.timestamp(0), 0.5);
+  EXPECT_DOUBLE_EQ(log.timestamp(2) - log.timestamp(1), 1.25);
+  EXPECT_DOUBLE_EQ(log.timestamp(3) - log.timestamp(2), 119.75);
+
+  // a new session after more than 60s without records
+  EXPECT_EQ(log.sessions(), QList<int>({0, 3, 4}));
+
+  // not a log: the current one is kept
+  EXPECT_FALSE(parseTestLog(log, "Time,Date\n", errors, lines));
+  EXPECT_EQ(log.rowCount(), 4);
+
+  log.clear();
+  EXPECT_EQ(log.rowCount(), 0);
+  EXPECT_EQ(log.columnCount(), 0);
+}
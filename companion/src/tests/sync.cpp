@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <utime.h>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include "gtests.h"
+#include "process_sync.h"
+
+#define SYNC_TEST_DIRS   4
+#define SYNC_TEST_FILES  50  // per directory
+
+// gives the tests access to the number of files hashed
+class HashCountingSyncProcess : public SyncProcess
+{
+  public:
+    using SyncProcess::SyncProcess;
+    using SyncProcess::m_hashCount;
+};
+
+static void setFileTime(const QString & path, time_t time)
+{
+  struct utimbuf times;
+  times.actime = times.modtime = time;
+  utime(path.toLocal8Bit().constData(), &times);
+}
+
+static void writeSyncTestFile(const QString & path, const QByteArray & content, time_t time)
+{
+  QFile file(path);
+  ASSERT_TRUE(file.open(QFile::WriteOnly));
+  file.write(content);
+  file.close();
+  setFileTime(path, time);
+}
+
+// identical small files in both folders, dated one hour ago so that their hashes can be cached
+static void createSyncTestTree(const QString & folder)
+{
+  const QByteArray content(512, 'x');
+  const time_t time = QDateTime::currentDateTime().addSecs(-3600).toTime_t();
+
+  for (int d = 0; d < SYNC_TEST_DIRS; d++) {
+    const QString dir = QString("%1/DIR%2").arg(folder).arg(d);
+    QDir().mkpath(dir);
+    for (int f = 0; f < SYNC_TEST_FILES; f++) {
+      writeSyncTestFile(QString("%1/FILE%2.BIN").arg(dir).arg(f), QString("%1/%2").arg(d).arg(f).toLatin1() + content, time);
+    }
+  }
+}
+
+static SyncProcess::SyncStatus runSync(const SyncProcess::SyncOptions & options, int & hashCount, qint64 & elapsed)
+{
+  SyncProcess::SyncStatus status;
+  status.clear();
+  HashCountingSyncProcess sync(options);
+  QObject::connect(&sync, &SyncProcess::statusUpdate, [&status](const SyncProcess::SyncStatus & s) { status = s; });
+  QElapsedTimer timer;
+  timer.start();
+  sync.run();
+  elapsed = timer.elapsed();
+  hashCount = sync.m_hashCount;
+  return status;
+}
+
+static SyncProcess::SyncOptions syncTestOptions(const QString & folder, int flags)
+{
+  SyncProcess::SyncOptions options;
+  options.folderA = folder + "/A";
+  options.folderB = folder + "/B";
+  options.direction = SyncProcess::SYNC_A2B;
+  options.compareType = SyncProcess::OVERWR_IF_DIFF;
+  options.flags = flags;
+  return options;
+}
+
+class SyncTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+      QStandardPaths::setTestModeEnabled(true);
+      manifests = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/sync";
+      QDir(manifests).removeRecursively();
+    }
+
+    void TearDown() override
+    {
+      QDir(manifests).removeRecursively();
+      QStandardPaths::setTestModeEnabled(false);
+    }
+
+    QString manifests;
+};
+
+// Test run between identical trees: the first one hashes both sides, the next one only the destination
+TEST_F(SyncTest, dryRunBenchmark)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  createSyncTestTree(dir.path() + "/A");
+  createSyncTestTree(dir.path() + "/B");
+  const SyncProcess::SyncOptions options = syncTestOptions(dir.path(), SyncProcess::OPT_DRY_RUN | SyncProcess::OPT_RECURSIVE);
+
+  int hashCount;
+  qint64 uncached, cached;
+  SyncProcess::SyncStatus status = runSync(options, hashCount, uncached);
+  EXPECT_EQ(status.count, SYNC_TEST_DIRS * SYNC_TEST_FILES);
+  EXPECT_EQ(status.skipped, status.count);
+  EXPECT_EQ(status.errored, 0);
+  EXPECT_EQ(hashCount, 2 * status.count);
+
+  status = runSync(options, hashCount, cached);
+  EXPECT_EQ(status.skipped, status.count);
+  EXPECT_EQ(status.errored, 0);
+  EXPECT_EQ(hashCount, status.count);
+
+  printf("Sync test run of %d files: %lldms without the hashes cache, %lldms with it\n",
+         status.count, uncached, cached);
+}
+
+// A destination file rewritten with the same size and time is not skipped as identical
+TEST_F(SyncTest, destinationChangedInPlace)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  const time_t time = QDateTime::currentDateTime().addSecs(-3600).toTime_t();
+  const QString source = dir.path() + "/A/MODEL.BIN";
+  const QString destination = dir.path() + "/B/MODEL.BIN";
+  QDir().mkpath(dir.path() + "/A");
+  QDir().mkpath(dir.path() + "/B");
+  writeSyncTestFile(source, "first", time);
+  writeSyncTestFile(destination, "first", time);
+  const SyncProcess::SyncOptions options = syncTestOptions(dir.path(), SyncProcess::OPT_RECURSIVE);
+
+  int hashCount;
+  qint64 elapsed;
+  SyncProcess::SyncStatus status = runSync(options, hashCount, elapsed);
+  EXPECT_EQ(status.skipped, 1);
+  EXPECT_EQ(status.updated, 0);
+
+  writeSyncTestFile(destination, "other", time);
+  status = runSync(options, hashCount, elapsed);
+  EXPECT_EQ(status.skipped, 0);
+  EXPECT_EQ(status.updated, 1);
+  EXPECT_EQ(status.errored, 0);
+
+  QFile file(destination);
+  ASSERT_TRUE(file.open(QFile::ReadOnly));
+  EXPECT_EQ(file.readAll(), QByteArray("first"));
+}
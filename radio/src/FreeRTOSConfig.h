@@ -41,7 +41,14 @@
 #define configUSE_MALLOC_FAILED_HOOK    0
 #define configUSE_APPLICATION_TASK_TAG  0
 #define configUSE_COUNTING_SEMAPHORES   0
-#define configGENERATE_RUN_TIME_STATS   0
+#if defined(DEBUG_TASKS)
+  // tasks CPU time, counted in CPU cycles (the DWT counter is started in delaysInit())
+  #define configGENERATE_RUN_TIME_STATS            1
+  #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+  #define portGET_RUN_TIME_COUNTER_VALUE()         ticksNow()
+#else
+  #define configGENERATE_RUN_TIME_STATS   0
+#endif
 #define configUSE_TIMERS                0
 
 #if !defined(DEBUG)
@@ -546,7 +546,9 @@ void audioTask(void * pdata)
   while (true) {
     DEBUG_TIMER_SAMPLE(debugTimerAudioIterval);
     DEBUG_TIMER_START(debugTimerAudioDuration);
+    TRACE_TASK_EVENT(task_audio_start, 0);
     audioQueue.wakeup();
+    TRACE_TASK_EVENT(task_audio_end, 0);
     DEBUG_TIMER_STOP(debugTimerAudioDuration);
     RTOS_WAIT_MS(4);
   }
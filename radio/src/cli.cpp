@@ -19,6 +19,7 @@
  */
 
 #include "opentx.h"
+#include "mixer_scheduler.h"
 #include "diskio.h"
 #include <ctype.h>
 #include <malloc.h>
@@ -697,6 +698,22 @@ int cliTrace(const char ** argv)
 }
 #endif
 
+#if defined(DEBUG_TRACE_BUFFER)
+int cliTraceBuffer(const char ** argv)
+{
+  if (!strcmp(argv[1], "dump")) {
+    dumpTraceBuffer();
+  }
+  else if (!strcmp(argv[1], "clear")) {
+    clearTraceBuffer();
+  }
+  else {
+    serialPrint("%s: Invalid argument \"%s\"", argv[0], argv[1]);
+  }
+  return 0;
+}
+#endif
+
 int cliStackInfo(const char ** argv)
 {
   serialPrint("[MAIN] %d available / %d bytes", stackAvailable()*4, stackSize()*4);
@@ -804,6 +821,16 @@ int cliSet(const char ** argv)
       serialPrint("%s: Invalid arguments \"%s\" \"%s\"", argv[0], argv[1], argv[2]);
     }
   }
+  else if (!strcmp(argv[1], "headroom")) {
+    int headroom = 0;
+    if (toInt(argv, 2, &headroom) > 0 && headroom >= 0 && headroom < MIN_REFRESH_RATE) {
+      mixerSchedulerSetHeadroom(headroom);
+    }
+    else {
+      serialPrint("%s: Invalid argument \"%s\" \"%s\"", argv[0], argv[1], argv[2]);
+    }
+    return 0;
+  }
 #if !defined(SOFTWARE_VOLUME)
   else if (!strcmp(argv[1], "volume")) {
     int level = 0;
@@ -828,64 +855,92 @@ void printInterrupts()
   memset(&interruptCounters, 0, sizeof(interruptCounters));
   interruptCounters.resetTime = get_tmr10ms();
   __enable_irq();
-  serialPrint("Interrupts count in the last %u ms:", (get_tmr10ms() - ic.resetTime) * 10);
+  serialPrint("Interrupts count and cycles in the last %u ms:", (get_tmr10ms() - ic.resetTime) * 10);
   for(int n = 0; n < INT_LAST; n++) {
-    serialPrint("%s: %u", interruptNames[n], ic.cnt[n]);
+    serialPrint("%s: %u %u", interruptNames[n], ic.cnt[n], ic.cycles[n]);
   }
 }
 #endif //#if defined(DEBUG_INTERRUPTS)
 
 #if defined(DEBUG_TASKS)
-
-void printTaskSwitchLog()
+int cliTop(const char ** argv)
 {
-  serialPrint("Tasks legend [<task_id>, <task name>]:");
-  for(int n = 0; n <= CFG_MAX_USER_TASKS+1; n++) {
-    if (0 == n) {
-      serialPrint("%d: Idle", n);
-    }
-    if (cliTaskId == n) {
-      serialPrint("%d: CLI", n);
-    }
-    else if (menusTaskId == n) {
-      serialPrint("%d: menus", n);
-    }
-    else if (mixerTaskId == n) {
-      serialPrint("%d: mixer", n);
-    }
-    else if (audioTaskId == n) {
-      serialPrint("%d: audio", n);
-    }
+  int period;
+  int result = toInt(argv, 1, &period);
+  if (result < 0) {
+    return -1;
+  }
+  else if (result == 0) {
+    period = 1000;
+  }
+  else if (period <= 0 || period > 10000) {
+    serialPrint("%s: Invalid period \"%s\"", argv[0], argv[1]);
+    return -1;
   }
-  serialCrlf();
 
-  serialPrint("Tasks switch log at %u [<time>, <task_id>]:", get_tmr10ms());
-  uint32_t lastSwitchTime = 0;
-  uint32_t * tsl = new uint32_t[DEBUG_TASKS_LOG_SIZE];
-  if (!tsl) {
-    serialPrint("Not enough memory");
-    return;
-  }
-  memcpy(tsl, taskSwitchLog, sizeof(taskSwitchLog));
-  uint32_t * p = tsl + taskSwitchLogPos;
-  uint32_t * end = tsl + DEBUG_TASKS_LOG_SIZE;
-  for(int n = 0; n < DEBUG_TASKS_LOG_SIZE; n++) {
-    uint32_t taskId = *p >> 24;
-    uint32_t switchTime = *p & 0xFFFFFF;
-    if (lastSwitchTime != switchTime) {
-      serialPrintf("\r\n%06x: ", switchTime);
-      lastSwitchTime = switchTime;
-    }
-    serialPrintf("%u ", taskId);
-    if ( ++p >= end ) {
-      p = tsl;
-    }
+  // own baseline, the debug screen and Lua may sample the stats meanwhile
+  static CpuStats cpuStats;
+  updateCpuStats(cpuStats);
+  RTOS_WAIT_MS(period);
+  updateCpuStats(cpuStats);
+
+  serialPrint("CPU load in the last %u ms:", cpuStats.period / 1000);
+  serialPrint("Task        Load  Free stack");
+  for (uint8_t i = 0; i < cpuStats.tasksCount; i++) {
+    const TaskStats & task = cpuStats.tasks[i];
+    serialPrint("%-10s %3u.%u%%  %u", task.name, task.load / 10, task.load % 10, task.stackFree * 4);
   }
-  delete[] tsl;
-  serialCrlf();
+  if (cpuStats.tasksTotal > cpuStats.tasksCount) {
+    serialPrint("(%u more tasks)", cpuStats.tasksTotal - cpuStats.tasksCount);
+  }
+#if defined(DEBUG_INTERRUPTS)
+  serialPrint("%-10s %3u.%u%%", "Interrupts", cpuStats.interruptsLoad / 10, cpuStats.interruptsLoad % 10);
+#endif
+  serialPrint("%-10s %9s  %u", "Main", "", stackAvailable() * 4);
+  return 0;
 }
 #endif // #if defined(DEBUG_TASKS)
 
+#if defined(DEBUG_LATENCY_MEASURE)
+int cliLatency(const char ** argv)
+{
+  if (!strcmp(argv[1], "reset")) {
+    resetLatencyStats();
+    return 0;
+  }
+  else if (argv[1][0]) {
+    serialPrint("%s: Invalid argument \"%s\"", argv[0], argv[1]);
+    return -1;
+  }
+
+  uint32_t count = latencyStats.count;
+  serialPrint("Latency of %u samples (%u dropped), from the ADC read:", count, latencyStats.dropped);
+  if (count == 0) {
+    return 0;
+  }
+
+  serialPrint("Stage          Min    Avg    Max (us)");
+  for (uint8_t i = LATENCY_MIXER_START; i <= LATENCY_STAGES_COUNT; i++) {
+    // the end to end stats are in the ADC stage, printed last
+    uint8_t stage = i % LATENCY_STAGES_COUNT;
+    const LatencyStageStats & stats = latencyStats.stages[stage];
+    serialPrint("%-11s %6u %6u %6u", latencyStageNames[stage], stats.min, uint32_t(stats.sum / count), stats.max);
+  }
+
+  serialPrint("End to end histogram:");
+  for (uint8_t i = 0; i < LATENCY_HISTOGRAM_BINS; i++) {
+    uint32_t samples = latencyStats.histogram[i];
+    if (samples == 0)
+      continue;
+    if (i == LATENCY_HISTOGRAM_BINS - 1)
+      serialPrint("     >= %5uus %6u %3u%%", i * LATENCY_HISTOGRAM_BIN_US, samples, samples * 100 / count);
+    else
+      serialPrint("%5u-%5uus %6u %3u%%", i * LATENCY_HISTOGRAM_BIN_US, (i + 1) * LATENCY_HISTOGRAM_BIN_US, samples, samples * 100 / count);
+  }
+  return 0;
+}
+#endif // #if defined(DEBUG_LATENCY_MEASURE)
+
 #if defined(DEBUG_TIMERS)
 
 void printDebugTime(uint32_t time)
@@ -1054,11 +1109,6 @@ int cliDisplay(const char ** argv)
     printInterrupts();
   }
 #endif
-#if defined(DEBUG_TASKS)
-  else if (!strcmp(argv[1], "tsl")) {
-    printTaskSwitchLog();
-  }
-#endif
 #if defined(DEBUG_TIMERS)
   else if (!strcmp(argv[1], "dt")) {
     printDebugTimers();
@@ -1067,12 +1117,31 @@ int cliDisplay(const char ** argv)
   else if (!strcmp(argv[1], "audio")) {
     printAudioVars();
   }
+  else if (!strcmp(argv[1], "mixer")) {
+    if (argv[2] && !strcmp(argv[2], "reset")) {
+      resetMixerSchedulerStats();
+      return 0;
+    }
+    serialPrint("Mixer period: %uus, headroom: %uus, %u runs", getMixerSchedulerPeriod(), getMixerSchedulerHeadroom(), getMixerSchedulerRuns());
+    for (uint8_t i = 0; i < NUM_MODULES; i++) {
+      const MixerScheduleStats & stats = getMixerSchedulerStats(i);
+      if (stats.frames) {
+        serialPrint("Module %u: %u frames, outputs age %uus (max %uus)", i, stats.frames, stats.lastAge, stats.maxAge);
+      }
+    }
+  }
 #if defined(DISK_CACHE)
   else if (!strcmp(argv[1], "dc")) {
     DiskCacheStats stats = diskCache.getStats();
     uint32_t hitRate = diskCache.getHitRate();
     serialPrint("Disk Cache stats: w:%u r: %u, h: %u(%0.1f%%), m: %u", stats.noWrites, (stats.noHits + stats.noMisses), stats.noHits, hitRate*0.1f, stats.noMisses);
   }
+#endif
+#if defined(USB_MSC_CACHE)
+  else if (!strcmp(argv[1], "msc")) {
+    const UsbMscCacheStats & stats = usbMscCache.getStats();
+    serialPrint("USB MSC cache stats: r: %u (h: %u), w: %u, f: %u, %u KB/s", stats.readSectors, stats.readHits, stats.writtenSectors, stats.flushes, usbMscCache.getThroughput());
+  }
 #endif
   else if (toLongLongInt(argv, 1, &address) > 0) {
     int size = 256;
@@ -1256,10 +1325,19 @@ const CliCommand cliCommands[] = {
   { "reboot", cliReboot, "[wdt]" },
   { "set", cliSet, "<what> <value>" },
   { "stackinfo", cliStackInfo, "" },
+#if defined(DEBUG_TASKS)
+  { "top", cliTop, "[<period (ms)>]" },
+#endif
+#if defined(DEBUG_LATENCY_MEASURE)
+  { "latency", cliLatency, "[reset]" },
+#endif
   { "meminfo", cliMemoryInfo, "" },
   { "test", cliTest, "new | std::exception | graphics | memspd" },
 #if defined(DEBUG)
   { "trace", cliTrace, "on | off" },
+#endif
+#if defined(DEBUG_TRACE_BUFFER)
+  { "tracebuffer", cliTraceBuffer, "dump | clear" },
 #endif
   { "help", cliHelp, "[<command>]" },
   { "debugvars", cliDebugVars, "" },
@@ -45,52 +45,66 @@ void debugPrintf(const char * format, ...)
 #endif
 
 #if defined(DEBUG_TRACE_BUFFER)
+static_assert((TRACE_BUFFER_LEN & (TRACE_BUFFER_LEN - 1)) == 0, "TRACE_BUFFER_LEN must be a power of 2");
+
 static struct TraceElement traceBuffer[TRACE_BUFFER_LEN];
-static uint8_t traceBufferPos;
+static uint32_t traceBufferPos;  // total count of events, the ring index is its low bits
+static bool traceBufferPaused;
 extern Fifo<uint8_t, 512> auxSerialTxFifo;
-gtime_t filltm(const gtime_t *t, struct gtm *tp);
+
+static inline uint32_t traceTime()
+{
+#if defined(SIMU)
+  return simuTimerMicros();
+#else
+  return ticksNow();
+#endif
+}
 
 void trace_event(enum TraceEvent event, uint32_t data)
 {
-  if (traceBufferPos >= TRACE_BUFFER_LEN) return;
-  __disable_irq();
-  struct TraceElement * p = &traceBuffer[traceBufferPos++];
-  __enable_irq();
-  p->time = g_rtcTime;
-  p->time_ms = g_ms100;
+  if (traceBufferPaused) return;
+  // the slot is reserved atomically, which is enough for tasks and interrupts to share the ring
+  uint32_t pos = __atomic_fetch_add(&traceBufferPos, 1, __ATOMIC_RELAXED);
+  struct TraceElement * p = &traceBuffer[pos & (TRACE_BUFFER_LEN - 1)];
+  p->time = traceTime();
   p->event = event;
   p->data = data;
 }
 
 void trace_event_i(enum TraceEvent event, uint32_t data)
 {
-  if (traceBufferPos >= TRACE_BUFFER_LEN) return;
-  struct TraceElement * p = &traceBuffer[traceBufferPos++];
-  p->time = g_rtcTime;
-  p->time_ms = g_ms100;
-  p->event = event;
-  p->data = data;
+  trace_event(event, data);
 }
 
+uint16_t getTraceElementsCount()
+{
+  return min<uint32_t>(traceBufferPos, TRACE_BUFFER_LEN);
+}
 
+// idx 0 is the oldest event
 const struct TraceElement * getTraceElement(uint16_t idx)
 {
-  if (idx < TRACE_BUFFER_LEN) return &traceBuffer[idx];
+  uint32_t count = getTraceElementsCount();
+  if (idx < count) return &traceBuffer[(traceBufferPos - count + idx) & (TRACE_BUFFER_LEN - 1)];
   return 0;
 }
 
+void clearTraceBuffer()
+{
+  traceBufferPos = 0;
+}
 
 void dumpTraceBuffer()
 {
+  traceBufferPaused = true;
+  uint16_t count = getTraceElementsCount();
   TRACE("Dump of Trace Buffer (%s " DATE " " TIME "):", vers_stamp);
-  TRACE("#   Time                     Event  Data");
-  for(int n = 0; n < TRACE_BUFFER_LEN; ++n) {
-    struct gtm tp;
-    filltm(&traceBuffer[n].time, &tp);
-    TRACE_NOCRLF("%02d  ", n);
-    TRACE_NOCRLF("%4d-%02d-%02d,%02d:%02d:%02d.%02d0", tp.tm_year+TM_YEAR_BASE, tp.tm_mon+1, tp.tm_mday, tp.tm_hour, tp.tm_min, tp.tm_sec, traceBuffer[n].time_ms);
-    TRACE("  %03d    0x%08x", traceBuffer[n].event, traceBuffer[n].data);
-    if (traceBuffer[n].time == 0 && traceBuffer[n].time_ms == 0) break;
+  TRACE("Trace ticks/us %d, %d events, %d lost", TRACE_TICKS_PER_US, count, traceBufferPos - count);
+  TRACE("#   Time        Event  Data");
+  for (uint16_t n = 0; n < count; ++n) {
+    const struct TraceElement * te = getTraceElement(n);
+    TRACE_NOCRLF("%03d %10u  %03d    0x%08x" CRLF, n, te->time, te->event, te->data);
 #if !defined(SIMU)
     if ((n % 5) == 0) {
       while (!auxSerialTxFifo.isEmpty()) {
@@ -100,6 +114,7 @@ void dumpTraceBuffer()
 #endif
   }
   TRACE("End of Trace Buffer dump");
+  traceBufferPaused = false;
 }
 #endif
 
@@ -119,6 +134,8 @@ void dumpTraceBuffer()
     "Tim2 ",   // INT_TIM2,
     "Tim3 ",   // INT_TIM3,
     "BlueT",   // INT_BLUETOOTH,
+    "IntMd",   // INT_INTMODULE,
+    "ExtMd",   // INT_EXTMODULE,
     "USB  ",  // INT_OTG_FS,
 #if defined(DEBUG_USB_INTERRUPTS)
     " spur",  // INT_OTG_FS_SPURIOUS,
@@ -152,6 +169,9 @@ void dumpTraceBuffer()
     "TelDm",   // INT_TELEM_DMA,
     "TelUs",   // INT_TELEM_USART,
     "Train",   // INT_TRAINER,
+    "AuDma",   // INT_AUDIO_DMA,
+    "IntMd",   // INT_INTMODULE,
+    "ExtMd",   // INT_EXTMODULE,
     "Usb  ",   // INT_OTG_FS,
 #if defined(DEBUG_USB_INTERRUPTS)
     " spur",  // INT_OTG_FS_SPURIOUS,
@@ -174,30 +194,76 @@ void dumpTraceBuffer()
 #endif
 
 struct InterruptCounters interruptCounters;
+uint32_t interruptsCycles;
+
+InterruptCyclesCounter::InterruptCyclesCounter(uint8_t index):
+  index(index),
+  start(ticksNow())
+{
+  ++interruptCounters.cnt[index];
+}
+
+InterruptCyclesCounter::~InterruptCyclesCounter()
+{
+  uint32_t cycles = ticksNow() - start;
+  interruptCounters.cycles[index] += cycles;
+  interruptsCycles += cycles;
+}
 #endif //#if defined(DEBUG_INTERRUPTS)
 
 #if defined(DEBUG_TASKS)
 
-uint32_t taskSwitchLog[DEBUG_TASKS_LOG_SIZE] __SDRAM;
-uint16_t taskSwitchLogPos;
+static uint16_t loadPermille(uint32_t cycles, uint32_t period)
+{
+  return period ? (uint64_t)cycles * 1000 / period : 0;
+}
 
-/**
- *******************************************************************************
- * @brief      Hook for task switch logging
- * @param[in]  taskID Task which is now in RUNNING state
- * @retval     None
- *
- * @par Description
- * @details    This function logs the time when a task entered the RUNNING state.
- *******************************************************************************
- */
-void CoTaskSwitchHook(uint8_t taskID)
+// uxTaskGetSystemState() returns 0 when the array can't hold all the tasks
+static_assert(TASKS_STATS_MAX >= TASKS_COUNT, "TASKS_STATS_MAX must be at least the number of tasks");
+
+void updateCpuStats(CpuStats & stats)
 {
-  /* Log task switch here */
-  taskSwitchLog[taskSwitchLogPos] = (taskID << 24) + ((uint32_t)CoGetOSTime() & 0xFFFFFF);
-  if(++taskSwitchLogPos >= DEBUG_TASKS_LOG_SIZE) {
-    taskSwitchLogPos = 0;
+  static TaskStatus_t status[TASKS_STATS_MAX];
+  uint32_t totalRunTime;
+
+  // the status array is shared by the tasks which refresh their stats (menus, CLI)
+  vTaskSuspendAll();
+  UBaseType_t count = uxTaskGetSystemState(status, TASKS_STATS_MAX, &totalRunTime);
+
+  // all counters are 32 bits cycles, the differences are right as long as the period is under 2^32 cycles (> 20s)
+  uint32_t now = ticksNow();
+  uint32_t period = now - stats.lastStatsTime;
+  stats.lastStatsTime = now;
+  stats.period = period / SYSTEM_TICKS_1US;
+  stats.tasksTotal = (count ? count : uxTaskGetNumberOfTasks());
+
+  for (UBaseType_t i = 0; i < count; i++) {
+    uint32_t lastRunTime = status[i].ulRunTimeCounter;
+    for (auto & last: stats.lastTasksRunTime) {
+      if (last.number == status[i].xTaskNumber) {
+        lastRunTime = last.runTime;
+        break;
+      }
+    }
+    TaskStats & task = stats.tasks[i];
+    task.name = status[i].pcTaskName;
+    task.load = loadPermille(status[i].ulRunTimeCounter - lastRunTime, period);
+    task.stackFree = status[i].usStackHighWaterMark;
+  }
+
+  for (UBaseType_t i = 0; i < TASKS_STATS_MAX; i++) {
+    stats.lastTasksRunTime[i].number = (i < count ? status[i].xTaskNumber : 0);
+    stats.lastTasksRunTime[i].runTime = (i < count ? status[i].ulRunTimeCounter : 0);
   }
+  stats.tasksCount = count;
+  xTaskResumeAll();
+
+#if defined(DEBUG_INTERRUPTS)
+  // the interrupts time is also accounted to the task they have interrupted
+  uint32_t cycles = interruptsCycles;
+  stats.interruptsLoad = loadPermille(cycles - stats.lastInterruptsCycles, period);
+  stats.lastInterruptsCycles = cycles;
+#endif
 }
 
 #endif // #if defined(DEBUG_TASKS)
@@ -267,3 +333,85 @@ const char * const debugTimerNames[DEBUG_TIMERS_COUNT] = {
 };
 
 #endif
+
+#if defined(DEBUG_LATENCY_MEASURE)
+
+#if defined(SIMU)
+  #define LATENCY_TICKS_PER_US  1
+#else
+  #define LATENCY_TICKS_PER_US  SYSTEM_TICKS_1US
+#endif
+
+struct LatencyStats latencyStats;
+
+const char * const latencyStageNames[LATENCY_STAGES_COUNT] = {
+  "End to end",  // LATENCY_ADC
+  "Mixer start",
+  "Mixer end",
+  "Pulses",
+  "Transmit",
+};
+
+static uint32_t latencyStamps[LATENCY_STAGES_COUNT];
+static volatile uint8_t latencyNextStage;  // LATENCY_ADC when no sample is tagged
+
+static inline uint32_t latencyTime()
+{
+#if defined(SIMU)
+  return simuTimerMicros();
+#else
+  return ticksNow();
+#endif
+}
+
+static void addLatency(LatencyStageStats & stats, uint32_t us)
+{
+  if (latencyStats.count == 0 || us < stats.min)
+    stats.min = us;
+  if (us > stats.max)
+    stats.max = us;
+  stats.sum += us;
+}
+
+// the stages of the tagged sample are only taken in order: the mixer runs which happen
+// before its frame is built are part of its latency, they carry the same input change
+void latencyStamp(enum LatencyStage stage)
+{
+  uint32_t now = latencyTime();
+
+  if (stage == LATENCY_ADC && latencyNextStage != LATENCY_ADC) {
+    if ((now - latencyStamps[LATENCY_ADC]) / LATENCY_TICKS_PER_US < LATENCY_TIMEOUT_US)
+      return;
+    // the module is off, or the pulses are paused
+    ++latencyStats.dropped;
+    latencyNextStage = LATENCY_ADC;
+  }
+
+  if (stage != latencyNextStage)
+    return;
+
+  latencyStamps[stage] = now;
+  if (stage != LATENCY_TRANSMIT) {
+    latencyNextStage = stage + 1;
+    return;
+  }
+
+  for (uint8_t i = LATENCY_MIXER_START; i < LATENCY_STAGES_COUNT; i++) {
+    addLatency(latencyStats.stages[i], (latencyStamps[i] - latencyStamps[i - 1]) / LATENCY_TICKS_PER_US);
+  }
+
+  uint32_t total = (now - latencyStamps[LATENCY_ADC]) / LATENCY_TICKS_PER_US;
+  addLatency(latencyStats.stages[LATENCY_ADC], total);
+  ++latencyStats.histogram[min<uint32_t>(total / LATENCY_HISTOGRAM_BIN_US, LATENCY_HISTOGRAM_BINS - 1)];
+  ++latencyStats.count;
+
+  latencyNextStage = LATENCY_ADC;
+}
+
+void resetLatencyStats()
+{
+  latencyNextStage = LATENCY_ADC;
+  memclear(&latencyStats, sizeof(latencyStats));
+}
+
+#endif // #if defined(DEBUG_LATENCY_MEASURE)
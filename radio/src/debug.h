@@ -102,7 +102,18 @@ uint8_t aux2SerialTracesEnabled();
 
 #if defined(DEBUG_TRACE_BUFFER)
 
-#define TRACE_BUFFER_LEN  50
+/*
+  Binary events ring: each event is stored with a timestamp and a 32 bits data, without any
+  formatting, so it may be used from the mixer, pulses, telemetry and interrupt handlers.
+  The dump is decoded on the host with radio/util/trace2json.py (Chrome trace / Perfetto).
+*/
+#define TRACE_BUFFER_LEN  128  // must be a power of 2
+
+#if defined(SIMU)
+  #define TRACE_TICKS_PER_US  1
+#else
+  #define TRACE_TICKS_PER_US  SYSTEM_TICKS_1US
+#endif
 
 enum TraceEvent {
   trace_start = 1,
@@ -142,13 +153,20 @@ enum TraceEvent {
   ff_f_write_move_window,
 
   audio_getNextFilledBuffer_skip = 60,
+
+  // tasks loops, each *_start / *_end pair is a duration in the decoded trace
+  task_mixer_start = 80,
+  task_mixer_end,
+  task_menus_start,
+  task_menus_end,
+  task_audio_start,
+  task_audio_end,
 };
 
 struct TraceElement {
-  gtime_t time;
-  uint8_t time_ms;
-  enum TraceEvent event;
+  uint32_t time;  // TRACE_TICKS_PER_US units
   uint32_t data;
+  uint8_t event;  // enum TraceEvent
 };
 
 #if defined(__cplusplus)
@@ -157,6 +175,8 @@ extern "C" {
 void trace_event(enum TraceEvent event, uint32_t data);
 void trace_event_i(enum TraceEvent event, uint32_t data);
 const struct TraceElement * getTraceElement(uint16_t idx);
+uint16_t getTraceElementsCount();
+void clearTraceBuffer();
 void dumpTraceBuffer();
 #if defined(__cplusplus)
 }
@@ -189,6 +209,11 @@ void dumpTraceBuffer();
   #define TRACE_AUDIO_EVENT(condition, event, data)
   #define TRACEI_AUDIO_EVENT(condition, event, data)
 #endif
+#if defined(TRACE_TASKS)
+  #define TRACE_TASK_EVENT(event, data)  TRACE_EVENT(true, event, data)
+#else
+  #define TRACE_TASK_EVENT(event, data)
+#endif
 
 
 #if defined(JITTER_MEASURE)  && defined(__cplusplus)
@@ -238,6 +263,8 @@ enum InterruptNames {
   INT_TIM2,
   INT_TRAINER,
   INT_BLUETOOTH,
+  INT_INTMODULE,
+  INT_EXTMODULE,
   INT_OTG_FS,
 #if defined(DEBUG_USB_INTERRUPTS)
   INT_OTG_FS_SPURIOUS,
@@ -272,6 +299,9 @@ enum InterruptNames {
   INT_TELEM_DMA,
   INT_TELEM_USART,
   INT_TRAINER,
+  INT_AUDIO_DMA,
+  INT_INTMODULE,
+  INT_EXTMODULE,
   INT_OTG_FS,
 #if defined(DEBUG_USB_INTERRUPTS)
   INT_OTG_FS_SPURIOUS,
@@ -297,16 +327,35 @@ enum InterruptNames {
 struct InterruptCounters
 {
   uint32_t cnt[INT_LAST];
+  uint32_t cycles[INT_LAST];  // CPU cycles spent in the handler
   uint32_t resetTime;
 };
 
 extern const char * const interruptNames[INT_LAST];
 extern struct InterruptCounters interruptCounters;
+extern uint32_t interruptsCycles;  // all handlers, never reset
+
+#if defined(__cplusplus)
+// counts the handler call, and its duration until the end of the scope
+class InterruptCyclesCounter
+{
+  public:
+    explicit InterruptCyclesCounter(uint8_t index);
+    ~InterruptCyclesCounter();
+
+  protected:
+    uint8_t index;
+    uint32_t start;
+};
 
+// must be the first statement of the handler
+#define DEBUG_INTERRUPT(int)    InterruptCyclesCounter _interruptCyclesCounter(int)
+#else
 #define DEBUG_INTERRUPT(int)    (++interruptCounters.cnt[int])
+#endif
 
 #if defined(DEBUG_USB_INTERRUPTS)
-  #define DEBUG_USB_INTERRUPT(int)  DEBUG_INTERRUPT(int)
+  #define DEBUG_USB_INTERRUPT(int)  (++interruptCounters.cnt[int])
 #else
   #define DEBUG_USB_INTERRUPT(int)
 #endif
@@ -320,21 +369,36 @@ extern struct InterruptCounters interruptCounters;
 
 #if defined(DEBUG_TASKS)
 
-#define DEBUG_TASKS_LOG_SIZE    512
+// FreeRTOS run time stats, clocked by the DWT cycles counter (see FreeRTOSConfig.h)
+// at least TASKS_COUNT (mixer, menus, audio, CLI and idle tasks), with some margin
+#define TASKS_STATS_MAX         8
 
-// each 32bit is used as:
-//    top 8 bits: task id
-//    botom 24 bits: system tick counter
-extern uint32_t taskSwitchLog[DEBUG_TASKS_LOG_SIZE];
-extern uint16_t taskSwitchLogPos;
+struct TaskStats
+{
+  const char * name;
+  uint16_t load;       // 0.1% of the CPU time
+  uint16_t stackFree;  // 32 bits words never used since the task start
+};
 
-#if defined(__cplusplus)
-extern "C" {
-#endif
-extern void CoTaskSwitchHook(uint8_t taskID);
-#if defined(__cplusplus)
-}
-#endif
+struct CpuStats
+{
+  uint32_t period;     // us
+  uint8_t tasksCount;  // tasks reported in tasks[]
+  uint8_t tasksTotal;  // tasks running, more than tasksCount if tasks[] is too small
+  struct TaskStats tasks[TASKS_STATS_MAX];
+  uint16_t interruptsLoad;  // 0.1%, only with DEBUG_INTERRUPTS
+
+  // the previous snapshot, each user of the stats has its own
+  struct {
+    uint32_t number;
+    uint32_t runTime;
+  } lastTasksRunTime[TASKS_STATS_MAX];
+  uint32_t lastStatsTime;
+  uint32_t lastInterruptsCycles;
+};
+
+// refresh the stats with the loads since their previous update
+void updateCpuStats(CpuStats & stats);
 
 #endif // #if defined(DEBUG_TASKS)
 
@@ -432,5 +496,60 @@ extern const char * const debugTimerNames[DEBUG_TIMERS_COUNT];
 
 #endif //#if defined(DEBUG_TIMERS)
 
-#endif // _DEBUG_H_
+#if defined(DEBUG_LATENCY_MEASURE)
+
+/*
+  Mixer to RF latency measurement: one input sample at a time is tagged when the
+  mixer has read the ADC, and each stage it goes through is timestamped until the
+  transmission of the first module frame which carries it starts.
+*/
+
+#define LATENCY_HISTOGRAM_BINS      32
+#define LATENCY_HISTOGRAM_BIN_US    250   // the last bin holds everything above
+#define LATENCY_TIMEOUT_US          100000
+
+enum LatencyStage {
+  LATENCY_ADC,
+  LATENCY_MIXER_START,
+  LATENCY_MIXER_END,
+  LATENCY_PULSES,
+  LATENCY_TRANSMIT,
+  LATENCY_STAGES_COUNT
+};
+
+struct LatencyStageStats
+{
+  uint32_t min;  // us since the previous stage
+  uint32_t max;
+  uint64_t sum;
+};
+
+struct LatencyStats
+{
+  uint32_t count;
+  uint32_t dropped;  // samples which never reached the transmission
+  struct LatencyStageStats stages[LATENCY_STAGES_COUNT];  // stages[LATENCY_ADC] is end to end
+  uint32_t histogram[LATENCY_HISTOGRAM_BINS];  // end to end
+};
+
+extern struct LatencyStats latencyStats;
+extern const char * const latencyStageNames[LATENCY_STAGES_COUNT];
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+void latencyStamp(enum LatencyStage stage);
+void resetLatencyStats();
+#if defined(__cplusplus)
+}
+#endif
+
+#define LATENCY_STAMP(stage)      latencyStamp(stage)
+
+#else //#if defined(DEBUG_LATENCY_MEASURE)
+
+#define LATENCY_STAMP(stage)
+
+#endif //#if defined(DEBUG_LATENCY_MEASURE)
+
+#endif // _DEBUG_H_
@@ -147,12 +147,17 @@ DRESULT DiskCache::read(BYTE drv, BYTE * buff, DWORD sector, UINT count)
   return blocks[lastBlock].fill(drv, buff, sector, count);
 }
 
-DRESULT DiskCache::write(BYTE drv, const BYTE* buff, DWORD sector, UINT count)
+void DiskCache::free(DWORD sector, UINT count)
 {
-  ++stats.noWrites;
-  for(int n=0; n < DISK_CACHE_BLOCKS_NUM; ++n) {
+  for (int n=0; n < DISK_CACHE_BLOCKS_NUM; ++n) {
     blocks[n].free(sector, count);
   }
+}
+
+DRESULT DiskCache::write(BYTE drv, const BYTE* buff, DWORD sector, UINT count)
+{
+  ++stats.noWrites;
+  free(sector, count);
   return __disk_write(drv, buff, sector, count);  
 }
 
@@ -61,6 +61,7 @@ class DiskCache
     DRESULT write(BYTE drv, const BYTE* buff, DWORD sector, UINT count);
     const DiskCacheStats & getStats() const;
     int getHitRate() const;
+    void free(DWORD sector, UINT count);
     void clear();
 
   private:
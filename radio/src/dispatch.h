@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _DISPATCH_H_
+#define _DISPATCH_H_
+
+#include <inttypes.h>
+#include "index_sequence.h"
+
+/*
+  Index -> kind tables generated at compile time.
+  The Kinds class provides COUNT and a constexpr kind(index) function which
+  describes the index ranges of the board, it is only evaluated by the compiler.
+  At runtime a lookup is a single byte read, and the caller dispatches on the
+  kind with a dense switch.
+*/
+template <unsigned count>
+struct DispatchKinds {
+  uint8_t kind[count];
+};
+
+template <typename Kinds>
+struct DispatchTableGenerator {
+  template <unsigned... values>
+  static constexpr DispatchKinds<Kinds::COUNT> generate(IndexSequence<values...>)
+  {
+    return {{Kinds::kind(values)...}};
+  }
+};
+
+template <typename Kinds>
+class DispatchTable
+{
+  public:
+    static constexpr DispatchKinds<Kinds::COUNT> table = DispatchTableGenerator<Kinds>::generate(typename MakeIndexSequence<Kinds::COUNT>::type());
+
+    static inline uint8_t get(unsigned index)
+    {
+      return index < Kinds::COUNT ? table.kind[index] : Kinds::OUT_OF_RANGE;
+    }
+};
+
+template <typename Kinds>
+constexpr DispatchKinds<Kinds::COUNT> DispatchTable<Kinds>::table;
+
+#endif // _DISPATCH_H_
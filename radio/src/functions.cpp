@@ -119,6 +119,30 @@ bool isRepeatDelayElapsed(const CustomFunctionData * functions, CustomFunctionsC
   }
 }
 
+/*
+  Only entries with a switch are evaluated. Disabled entries are skipped too,
+  unless they were active, so that they get a last inactive pass.
+  Their switches are read on every cycle: the level triggered functions
+  (trainer, override, volume, backlight...) are reasserted each time, the
+  play functions only run on their switch edge and at their repeat deadline.
+*/
+void updateFunctionsEntries(const CustomFunctionData * functions, CustomFunctionsContext & functionsContext)
+{
+  // an edit made while the list is rebuilt invalidates it again
+  functionsContext.entriesValid = true;
+
+  uint8_t count = 0;
+  for (uint8_t i=0; i<MAX_SPECIAL_FUNCTIONS; i++) {
+    const CustomFunctionData * cfn = &functions[i];
+    if (!CFN_SWITCH(cfn))
+      continue;
+    if (HAS_ENABLE_PARAM(CFN_FUNC(cfn)) && !CFN_ACTIVE(cfn) && !(functionsContext.activeSwitches & ((MASK_CFN_TYPE)1 << i)))
+      continue;
+    functionsContext.entries[count++] = i;
+  }
+  functionsContext.entriesCount = count;
+}
+
 #define VOLUME_HYSTERESIS 10            // how much must a input value change to actually be considered for new volume setting
 getvalue_t requiredSpeakerVolumeRawLast = 1024 + 1; //initial value must be outside normal range
 
@@ -142,7 +166,12 @@ void evalFunctions(const CustomFunctionData * functions, CustomFunctionsContext
   }
 #endif
 
-  for (uint8_t i=0; i<MAX_SPECIAL_FUNCTIONS; i++) {
+  if (!functionsContext.entriesValid) {
+    updateFunctionsEntries(functions, functionsContext);
+  }
+
+  for (uint8_t entry=0; entry<functionsContext.entriesCount; entry++) {
+    uint8_t i = functionsContext.entries[entry];
     const CustomFunctionData * cfn = &functions[i];
     swsrc_t swtch = CFN_SWITCH(cfn);
     if (swtch) {
@@ -154,6 +183,14 @@ void evalFunctions(const CustomFunctionData * functions, CustomFunctionsContext
         active &= (bool)CFN_ACTIVE(cfn);
       }
 
+#if defined(SDCARD)
+      // nothing to play before the next switch edge or the repeat deadline
+      if (active && HAS_REPEAT_PARAM(CFN_FUNC(cfn)) && !isRepeatDelayElapsed(functions, functionsContext, i)) {
+        newActiveSwitches |= switch_mask;
+        continue;
+      }
+#endif
+
       if (active) {
         switch (CFN_FUNC(cfn)) {
 
@@ -269,24 +306,23 @@ void evalFunctions(const CustomFunctionData * functions, CustomFunctionsContext
           case FUNC_HAPTIC:
 #endif
           {
-            if (isRepeatDelayElapsed(functions, functionsContext, i)) {
-              if (!IS_PLAYING(PLAY_INDEX)) {
-                if (CFN_FUNC(cfn) == FUNC_PLAY_SOUND) {
-                  if (audioQueue.isEmpty()) {
-                    AUDIO_PLAY(AU_SPECIAL_SOUND_FIRST + CFN_PARAM(cfn));
-                  }
-                }
-                else if (CFN_FUNC(cfn) == FUNC_PLAY_VALUE) {
-                  PLAY_VALUE(CFN_PARAM(cfn), PLAY_INDEX);
+            // the repeat delay was checked above
+            if (!IS_PLAYING(PLAY_INDEX)) {
+              if (CFN_FUNC(cfn) == FUNC_PLAY_SOUND) {
+                if (audioQueue.isEmpty()) {
+                  AUDIO_PLAY(AU_SPECIAL_SOUND_FIRST + CFN_PARAM(cfn));
                 }
+              }
+              else if (CFN_FUNC(cfn) == FUNC_PLAY_VALUE) {
+                PLAY_VALUE(CFN_PARAM(cfn), PLAY_INDEX);
+              }
 #if defined(HAPTIC)
-                else if (CFN_FUNC(cfn) == FUNC_HAPTIC) {
-                  haptic.event(AU_SPECIAL_SOUND_LAST+CFN_PARAM(cfn));
-                }
+              else if (CFN_FUNC(cfn) == FUNC_HAPTIC) {
+                haptic.event(AU_SPECIAL_SOUND_LAST+CFN_PARAM(cfn));
+              }
 #endif
-                else {
-                  playCustomFunctionFile(cfn, PLAY_INDEX);
-                }
+              else {
+                playCustomFunctionFile(cfn, PLAY_INDEX);
               }
             }
             break;
@@ -139,6 +139,253 @@ typedef struct gpsDataNmea_s
   uint32_t time;
 } gpsDataNmea_t;
 
+/* UBX binary protocol (u-blox receivers)
+
+   The receiver is asked to output UBX NAV-PVT frames, which carry position, fix, speed,
+   course and time in one binary frame, at a higher rate than the NMEA sentences.
+   NAV-PVT has no HDOP, it comes from NAV-DOP frames sent at a lower rate.
+   Once they are received, the NMEA GGA and RMC sentences are turned off. If they stop
+   (receiver reset, unplugged...) the NMEA sentences are parsed again and the receiver
+   is configured again.
+*/
+
+#define UBX_SYNC_CHAR_1      0xB5
+#define UBX_SYNC_CHAR_2      0x62
+#define UBX_CLASS_NAV        0x01
+#define UBX_CLASS_CFG        0x06
+#define UBX_NAV_DOP          0x04
+#define UBX_NAV_PVT          0x07
+#define UBX_CFG_MSG          0x01
+#define UBX_CFG_RATE         0x08
+
+#if GPS_USART_BAUDRATE > 9600
+  #define UBX_MEAS_RATE_MS   100   // 10Hz
+#else
+  #define UBX_MEAS_RATE_MS   200   // 5Hz, 10Hz NAV-PVT frames don't fit at 9600 bauds
+#endif
+
+#define UBX_NAV_DOP_RATE     (1000 / UBX_MEAS_RATE_MS)  // one NAV-DOP frame per second
+#define UBX_TIMEOUT          300   // 3s without NAV-PVT frame
+
+PACK(struct ubxNavPvt_t {
+  uint32_t iTOW;
+  uint16_t year;
+  uint8_t month;
+  uint8_t day;
+  uint8_t hour;
+  uint8_t min;
+  uint8_t sec;
+  uint8_t valid;
+  uint32_t tAcc;
+  int32_t nano;
+  uint8_t fixType;
+  uint8_t flags;
+  uint8_t flags2;
+  uint8_t numSV;
+  int32_t lon;          // degrees * 1.0e7
+  int32_t lat;          // degrees * 1.0e7
+  int32_t height;       // mm
+  int32_t hMSL;         // mm
+  uint32_t hAcc;
+  uint32_t vAcc;
+  int32_t velN;
+  int32_t velE;
+  int32_t velD;
+  int32_t gSpeed;       // mm/s
+  int32_t headMot;      // degrees * 1.0e5
+  uint32_t sAcc;
+  uint32_t headAcc;
+  uint16_t pDOP;        // 0.01
+  uint8_t reserved[6];
+  int32_t headVeh;
+  int16_t magDec;
+  uint16_t magAcc;
+});
+
+PACK(struct ubxNavDop_t {
+  uint32_t iTOW;
+  uint16_t gDOP;        // 0.01
+  uint16_t pDOP;
+  uint16_t tDOP;
+  uint16_t vDOP;
+  uint16_t hDOP;
+  uint16_t nDOP;
+  uint16_t eDOP;
+});
+
+enum UbxState {
+  UBX_IDLE,
+  UBX_SYNC,
+  UBX_CLASS,
+  UBX_ID,
+  UBX_LENGTH_LOW,
+  UBX_LENGTH_HIGH,
+  UBX_PAYLOAD,
+  UBX_CHECKSUM_A,
+  UBX_CHECKSUM_B,
+};
+
+struct UbxParser {
+  uint8_t state;
+  uint8_t msgClass;
+  uint8_t msgId;
+  uint8_t checksumA;
+  uint8_t checksumB;
+  uint16_t length;
+  uint16_t offset;
+  union {
+    ubxNavPvt_t navPvt;
+    ubxNavDop_t navDop;
+    uint8_t bytes[sizeof(ubxNavPvt_t)];
+  } payload;
+};
+
+static UbxParser ubx;
+static bool gpsUbxReceived = false;
+static tmr10ms_t gpsUbxLastFrame;
+static uint8_t gpsUbxAttempts = 0;
+
+void gpsSendUBX(uint8_t msgClass, uint8_t msgId, const uint8_t * payload, uint16_t length)
+{
+  uint8_t header[] = { msgClass, msgId, uint8_t(length), uint8_t(length >> 8) };
+  uint8_t checksumA = 0, checksumB = 0;
+
+  TRACE("gps> UBX %02x %02x (%d bytes)", msgClass, msgId, length);
+  gpsSendByte(UBX_SYNC_CHAR_1);
+  gpsSendByte(UBX_SYNC_CHAR_2);
+  for (uint8_t i = 0; i < sizeof(header); i++) {
+    checksumA += header[i];
+    checksumB += checksumA;
+    gpsSendByte(header[i]);
+  }
+  for (uint16_t i = 0; i < length; i++) {
+    checksumA += payload[i];
+    checksumB += checksumA;
+    gpsSendByte(payload[i]);
+  }
+  gpsSendByte(checksumA);
+  gpsSendByte(checksumB);
+}
+
+// Enable NAV-PVT and NAV-DOP outputs and set the navigation rate (do this only once a second,
+// and give up after a few attempts if the receiver doesn't understand UBX)
+void gpsConfigureUBX()
+{
+  static gtime_t lastGpsCmdSent = 0;
+  if (g_rtcTime == lastGpsCmdSent || gpsUbxAttempts >= 5)
+    return;
+  lastGpsCmdSent = g_rtcTime;
+  gpsUbxAttempts++;
+
+  const uint8_t cfgMsg[] = { UBX_CLASS_NAV, UBX_NAV_PVT, 1 };
+  gpsSendUBX(UBX_CLASS_CFG, UBX_CFG_MSG, cfgMsg, sizeof(cfgMsg));
+
+  const uint8_t cfgDop[] = { UBX_CLASS_NAV, UBX_NAV_DOP, UBX_NAV_DOP_RATE };
+  gpsSendUBX(UBX_CLASS_CFG, UBX_CFG_MSG, cfgDop, sizeof(cfgDop));
+
+  const uint8_t cfgRate[] = { uint8_t(UBX_MEAS_RATE_MS), uint8_t(UBX_MEAS_RATE_MS >> 8), 1, 0, 1, 0 };
+  gpsSendUBX(UBX_CLASS_CFG, UBX_CFG_RATE, cfgRate, sizeof(cfgRate));
+}
+
+static bool gpsProcessNavPvt(const ubxNavPvt_t & pvt)
+{
+  gpsUbxReceived = true;
+  gpsUbxLastFrame = get_tmr10ms();
+
+  uint8_t fix = (pvt.flags & 0x01) && pvt.fixType >= 2; // gnssFixOK, 2D or 3D fix
+  gpsData.fix = fix;
+  gpsData.numSat = pvt.numSV;
+  if (fix) {
+    __disable_irq();    // do the atomic update of lat/lon
+    gpsData.latitude = pvt.lat / 10;
+    gpsData.longitude = pvt.lon / 10;
+    gpsData.altitude = pvt.hMSL / 1000;
+    __enable_irq();
+  }
+  gpsData.speed = pvt.gSpeed / 10;  // cm/s, as the NMEA RMC speed
+  gpsData.groundCourse = pvt.headMot / 10000;
+
+#if defined(RTCLOCK)
+  // set RTC clock if needed
+  if (g_eeGeneral.adjustRTC && fix && (pvt.valid & 0x03) == 0x03) {
+    rtcAdjust(pvt.year, pvt.month, pvt.day, pvt.hour, pvt.min, pvt.sec);
+  }
+#endif
+
+  return true;
+}
+
+bool gpsNewFrameUBX(uint8_t c)
+{
+  switch (ubx.state) {
+    case UBX_IDLE:
+      if (c == UBX_SYNC_CHAR_1)
+        ubx.state = UBX_SYNC;
+      return false;
+
+    case UBX_SYNC:
+      ubx.state = (c == UBX_SYNC_CHAR_2 ? UBX_CLASS : UBX_IDLE);
+      return false;
+
+    case UBX_CLASS:
+      ubx.msgClass = c;
+      ubx.checksumA = c;
+      ubx.checksumB = c;
+      ubx.state = UBX_ID;
+      return false;
+
+    case UBX_ID:
+      ubx.msgId = c;
+      ubx.state = UBX_LENGTH_LOW;
+      break;
+
+    case UBX_LENGTH_LOW:
+      ubx.length = c;
+      ubx.state = UBX_LENGTH_HIGH;
+      break;
+
+    case UBX_LENGTH_HIGH:
+      ubx.length += c << 8;
+      ubx.offset = 0;
+      if (ubx.length > sizeof(ubx.payload)) {
+        // none of the decoded frames is that big, look for the next one
+        ubx.state = UBX_IDLE;
+        return false;
+      }
+      ubx.state = (ubx.length > 0 ? UBX_PAYLOAD : UBX_CHECKSUM_A);
+      break;
+
+    case UBX_PAYLOAD:
+      ubx.payload.bytes[ubx.offset] = c;
+      if (++ubx.offset >= ubx.length)
+        ubx.state = UBX_CHECKSUM_A;
+      break;
+
+    case UBX_CHECKSUM_A:
+      ubx.state = (c == ubx.checksumA ? UBX_CHECKSUM_B : UBX_IDLE);
+      if (ubx.state == UBX_IDLE)
+        gpsData.errorCount++;
+      return false;
+
+    case UBX_CHECKSUM_B:
+      ubx.state = UBX_IDLE;
+      if (c != ubx.checksumB) {
+        gpsData.errorCount++;
+        return false;
+      }
+      gpsData.packetCount++;
+      if (ubx.msgClass == UBX_CLASS_NAV && ubx.msgId == UBX_NAV_PVT && ubx.length == sizeof(ubxNavPvt_t))
+        return gpsProcessNavPvt(ubx.payload.navPvt);
+      if (ubx.msgClass == UBX_CLASS_NAV && ubx.msgId == UBX_NAV_DOP && ubx.length == sizeof(ubxNavDop_t))
+        gpsData.hdop = ubx.payload.navDop.hDOP;
+      return false;
+  }
+
+  ubx.checksumA += c;
+  ubx.checksumB += ubx.checksumA;
+  return false;
+}
+
 bool gpsNewFrameNMEA(char c)
 {
   static gpsDataNmea_t gps_Msg;
@@ -166,7 +413,9 @@ bool gpsNewFrameNMEA(char c)
         else if (string[0] == 'G' && string[2] == 'R' && string[3] == 'M' && string[4] == 'C') {
           gps_frame = FRAME_RMC;
         }
-        else {
+        if (gps_frame == NO_FRAME || gpsUbxReceived) {
+          // UBX NAV-PVT frames already carry the GGA / RMC data
+          gps_frame = NO_FRAME;
           // turn off this frame (do this only once a second)
           static gtime_t lastGpsCmdSent = 0;
           if (string[0] == 'G' && g_rtcTime != lastGpsCmdSent) {
@@ -299,7 +548,7 @@ bool gpsNewFrameNMEA(char c)
       checksum_param = 0;
       break;
     default:
-      if (offset < 15)
+      if (offset < sizeof(string) - 1)  // keep room for the terminating zero
         string[offset++] = c;
       if (!checksum_param)
         parity ^= c;
@@ -309,7 +558,11 @@ bool gpsNewFrameNMEA(char c)
 
 bool gpsNewFrame(uint8_t c)
 {
-  return gpsNewFrameNMEA(c);
+  // UBX frames are binary, they must not be seen by the NMEA parser
+  if (ubx.state != UBX_IDLE || c == UBX_SYNC_CHAR_1)
+    return gpsNewFrameUBX(c);
+  else
+    return gpsNewFrameNMEA(c);
 }
 
 void gpsNewData(uint8_t c)
@@ -325,6 +578,19 @@ void gpsWakeup()
   while (gpsGetByte(&byte)) {
     gpsNewData(byte);
   }
+
+  if (gpsUbxReceived && (tmr10ms_t)(get_tmr10ms() - gpsUbxLastFrame) > UBX_TIMEOUT) {
+    // NAV-PVT frames stopped, go back to NMEA until the receiver is configured again
+    TRACE("gps: UBX timeout");
+    gpsUbxReceived = false;
+    gpsUbxAttempts = 0;
+    gpsData.fix = 0;
+  }
+
+  // a receiver has been detected, ask it for UBX frames
+  if (!gpsUbxReceived && gpsData.packetCount > 0) {
+    gpsConfigureUBX();
+  }
 }
 
 char hex(uint8_t b) {
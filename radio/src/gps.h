@@ -41,6 +41,9 @@ struct gpsdata_t
 extern gpsdata_t gpsData;
 void gpsWakeup();
 
+void gpsNewData(uint8_t c);
+
 void gpsSendFrame(const char * frame);
+void gpsSendUBX(uint8_t msgClass, uint8_t msgId, const uint8_t * payload, uint16_t length);
 
 #endif // _GPS_H_
@@ -24,9 +24,41 @@
 
 pixel_t displayBuf[DISPLAY_BUFFER_SIZE] __DMA;
 
+uint8_t lcdDirtyPages = 0xFF;
+static uint8_t lcdSentPages = 0;
+static pixel_t lcdSentBuf[DISPLAY_BUFFER_SIZE];
+
 void lcdClear()
 {
   memset(displayBuf, 0, DISPLAY_BUFFER_SIZE);
+  lcdDirtyPages = 0xFF;
+}
+
+// The pages which have been drawn since the last refresh are compared with a copy of
+// what has been sent to the controller, the ones which didn't change won't be sent again
+uint8_t lcdGetChangedPages()
+{
+  uint8_t changed = 0;
+  for (uint8_t page = 0; page < LCD_PAGES; page++) {
+    uint8_t mask = 1 << page;
+    if ((lcdDirtyPages & mask) || !(lcdSentPages & mask)) {
+      const pixel_t * p = &displayBuf[page * LCD_PAGE_SIZE];
+      pixel_t * sent = &lcdSentBuf[page * LCD_PAGE_SIZE];
+      if (!(lcdSentPages & mask) || memcmp(p, sent, LCD_PAGE_SIZE * sizeof(pixel_t))) {
+        memcpy(sent, p, LCD_PAGE_SIZE * sizeof(pixel_t));
+        changed |= mask;
+      }
+    }
+  }
+  lcdDirtyPages = 0;
+  lcdSentPages = 0xFF;
+  return changed;
+}
+
+void lcdInvalidate()
+{
+  lcdSentPages = 0;
+  lcdDirtyPages = 0xFF;
 }
 
 coord_t lcdLastRightPos;
@@ -979,6 +1011,7 @@ void lcdDraw1bitBitmap(coord_t x, coord_t y, const uint8_t * img, uint8_t idx, L
       uint8_t b = inv ? ~(*q++) : *q++;
       
       if (p < DISPLAY_END) {
+        LCD_SET_DIRTY(p);
 
         if (!yShift) {
           *p = b;
@@ -987,6 +1020,7 @@ void lcdDraw1bitBitmap(coord_t x, coord_t y, const uint8_t * img, uint8_t idx, L
           *p = (*p & ((1 << yShift) - 1)) | (b << yShift);
 
           if (p + LCD_W < DISPLAY_END) {
+            LCD_SET_DIRTY(p + LCD_W);
             p[LCD_W] = (p[LCD_W] & (0xFF >> yShift)) | (b >> (8 - yShift));
           }
         }
@@ -1001,6 +1035,7 @@ void lcdDraw1bitBitmap(coord_t x, coord_t y, const uint8_t * img, uint8_t idx, L
 void lcdMaskPoint(uint8_t * p, uint8_t mask, LcdFlags att)
 {
   ASSERT_IN_DISPLAY(p);
+  LCD_SET_DIRTY(p);
 
   if (att & FORCE)
     *p |= mask;
@@ -1024,6 +1059,7 @@ void lcdInvertLine(int8_t line)
   if (line >= LCD_LINES) return;
 
   uint8_t *p  = &displayBuf[line * LCD_W];
+  LCD_SET_DIRTY(p);
   for (coord_t x=0; x<LCD_W; x++) {
     ASSERT_IN_DISPLAY(p);
     *p++ ^= 0xff;
@@ -313,6 +313,31 @@ void menuStatisticsDebug2(event_t event)
   y += FH;
 #endif
 
+#if defined(DEBUG_TASKS)
+  // CPU load and free stack of each task, refreshed every second
+  static CpuStats cpuStats;
+  static tmr10ms_t lastCpuStatsTime = 0;
+  if ((tmr10ms_t)(get_tmr10ms() - lastCpuStatsTime) >= 100) {
+    lastCpuStatsTime = get_tmr10ms();
+    updateCpuStats(cpuStats);
+  }
+  for (uint8_t i = 0; i < cpuStats.tasksCount && y < 7*FH; i++) {
+    const TaskStats & task = cpuStats.tasks[i];
+    lcdDrawTextAlignedLeft(y, task.name);
+    lcdDrawNumber(MENU_DEBUG_COL1_OFS, y, task.load, PREC1|RIGHT);
+    lcdDrawChar(lcdNextPos, y, '%');
+    lcdDrawNumber(LCD_W, y, task.stackFree, RIGHT);
+    y += FH;
+  }
+#if defined(DEBUG_INTERRUPTS)
+  if (y < 7*FH) {
+    lcdDrawTextAlignedLeft(y, "Interrupts");
+    lcdDrawNumber(MENU_DEBUG_COL1_OFS, y, cpuStats.interruptsLoad, PREC1|RIGHT);
+    lcdDrawChar(lcdNextPos, y, '%');
+  }
+#endif
+#endif
+
   lcdDrawText(LCD_W/2, 7*FH+1, STR_MENUTORESET, CENTERED);
   lcdInvertLastLine();
 }
@@ -35,9 +35,41 @@ inline bool lcdIsPointOutside(coord_t x, coord_t y)
   return (x<0 || x>=LCD_W || y<0 || y>=LCD_H);
 }
 
+uint8_t lcdDirtyPages = 0xFF;
+static uint8_t lcdSentPages = 0;
+static pixel_t lcdSentBuf[DISPLAY_BUFFER_SIZE];
+
 void lcdClear()
 {
   memset(displayBuf, 0, DISPLAY_BUFFER_SIZE * sizeof(pixel_t));
+  lcdDirtyPages = 0xFF;
+}
+
+// The pages which have been drawn since the last refresh are compared with a copy of
+// what has been sent to the controller, the ones which didn't change won't be sent again
+uint8_t lcdGetChangedPages()
+{
+  uint8_t changed = 0;
+  for (uint8_t page = 0; page < LCD_PAGES; page++) {
+    uint8_t mask = 1 << page;
+    if ((lcdDirtyPages & mask) || !(lcdSentPages & mask)) {
+      const pixel_t * p = &displayBuf[page * LCD_PAGE_SIZE];
+      pixel_t * sent = &lcdSentBuf[page * LCD_PAGE_SIZE];
+      if (!(lcdSentPages & mask) || memcmp(p, sent, LCD_PAGE_SIZE * sizeof(pixel_t))) {
+        memcpy(sent, p, LCD_PAGE_SIZE * sizeof(pixel_t));
+        changed |= mask;
+      }
+    }
+  }
+  lcdDirtyPages = 0;
+  lcdSentPages = 0xFF;
+  return changed;
+}
+
+void lcdInvalidate()
+{
+  lcdSentPages = 0;
+  lcdDirtyPages = 0xFF;
 }
 
 coord_t lcdLastRightPos;
@@ -830,6 +862,7 @@ void lcdMaskPoint(uint8_t *p, uint8_t mask, LcdFlags att)
   if ((p) >= DISPLAY_END) {
     return;
   }
+  LCD_SET_DIRTY(p);
 
   if (att&FILL_WHITE) {
     // TODO I could remove this, it's used for the top bar
@@ -911,6 +944,7 @@ void lcdInvertLine(int8_t line)
   if (line >= LCD_LINES) return;
 
   uint8_t *p  = &displayBuf[line * 4 * LCD_W];
+  LCD_SET_DIRTY(p);
   for (coord_t x=0; x<LCD_W*4; x++) {
     ASSERT_IN_DISPLAY(p);
     *p++ ^= 0xff;
@@ -957,9 +991,11 @@ void lcdDrawBitmap(coord_t x, coord_t y, const uint8_t * img, coord_t offset, co
     for (coord_t i=0; i<width; i++) {
       if (p >= DISPLAY_END) return;
       uint8_t b = *q++;
+      LCD_SET_DIRTY(p);
       if (y & 1) {
         *p = (*p & 0x0f) + ((b & 0x0f) << 4);
         if ((p+LCD_W) < DISPLAY_END) {
+          LCD_SET_DIRTY(p+LCD_W);
           *(p+LCD_W) = (*(p+LCD_W) & 0xf0) + ((b & 0xf0) >> 4);
         }
       }
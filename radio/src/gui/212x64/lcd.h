@@ -106,6 +106,14 @@ extern coord_t lcdNextPos;
 #define DISPLAY_END                    (displayBuf + DISPLAY_BUFFER_SIZE)
 #define ASSERT_IN_DISPLAY(p)           assert((p) >= displayBuf && (p) < DISPLAY_END)
 
+// Dirty pages tracking, one page is 8 pixel rows
+#define LCD_PAGES                      (LCD_H / 8)
+#define LCD_PAGE_SIZE                  (LCD_W * 4)
+extern uint8_t lcdDirtyPages;
+#define LCD_SET_DIRTY(p)               lcdDirtyPages |= 1 << ((uint32_t)((p) - displayBuf) / LCD_PAGE_SIZE)
+uint8_t lcdGetChangedPages();
+void lcdInvalidate();
+
 void lcdDrawChar(coord_t x, coord_t y, uint8_t c);
 void lcdDrawChar(coord_t x, coord_t y, uint8_t c, LcdFlags mode);
 void lcdDrawCenteredText(coord_t y, const char * s, LcdFlags flags = 0);
@@ -252,6 +252,30 @@ void menuStatisticsDebug2(event_t event)
   lcdDrawTextAlignedLeft(MENU_DEBUG_ROW1, "Tlm RX Err");
   lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW1, telemetryErrors, RIGHT);
 
+#if defined(DEBUG_TASKS)
+  // CPU load and free stack of each task, refreshed every second
+  static CpuStats cpuStats;
+  static tmr10ms_t lastCpuStatsTime = 0;
+  if ((tmr10ms_t)(get_tmr10ms() - lastCpuStatsTime) >= 100) {
+    lastCpuStatsTime = get_tmr10ms();
+    updateCpuStats(cpuStats);
+  }
+  coord_t y = MENU_DEBUG_ROW2;
+  for (uint8_t i = 0; i < cpuStats.tasksCount && y < 7*FH; i++) {
+    const TaskStats & task = cpuStats.tasks[i];
+    coord_t x = (i & 1) ? LCD_W/2 : 0;
+    lcdDrawText(x, y, task.name);
+    lcdDrawNumber(x + 11*FW, y, task.load, PREC1|RIGHT);
+    lcdDrawChar(lcdNextPos, y, '%');
+    lcdDrawNumber(x + LCD_W/2 - 1, y, task.stackFree, RIGHT|SMLSIZE);
+    if (i & 1) y += FH;
+  }
+#if defined(DEBUG_INTERRUPTS)
+  lcdDrawText(LCD_W/2, 6*FH, "Interrupts");
+  lcdDrawNumber(LCD_W/2 + 11*FW, 6*FH, cpuStats.interruptsLoad, PREC1|RIGHT);
+  lcdDrawChar(lcdNextPos, 6*FH, '%');
+#endif
+#endif
 
   lcdDrawText(LCD_W/2, 7*FH+1, STR_MENUTORESET, CENTERED);
   lcdInvertLastLine();
@@ -301,9 +325,8 @@ void menuTraceBuffer(event_t event)
 
     const struct TraceElement * te = getTraceElement(k);
     if (te) {
-      //time
-      int32_t tme = te->time % SECS_PER_DAY;
-      drawTimer(4*FW, y, tme, TIMEHOUR|LEFT, TIMEHOUR|LEFT);
+      //time (ms)
+      lcdDrawNumber(4*FW, y, te->time / TRACE_TICKS_PER_US / 1000, LEFT);
       //event
       lcdDrawNumber(14*FW, y, te->event, LEADING0|LEFT, 3);
       //data
@@ -19,8 +19,26 @@
  */
 
 #include "opentx.h"
+#include "fonts.h"
+#include "index_sequence.h"
 
-const uint16_t font_xxs_specs[] = {
+// Widths of the glyphs before the CJK ones, computed at compile time from the font specs
+template <unsigned N>
+struct FontWidths
+{
+  uint8_t widths[N];
+};
+
+// specs[0] is the font height, followed by the glyphs boundaries
+template <unsigned N, unsigned... I>
+constexpr FontWidths<sizeof...(I)> getFontWidths(const uint16_t (&specs)[N], IndexSequence<I...>)
+{
+  return {{ uint8_t(I + 2 < N ? specs[I + 2] - specs[I + 1] : 0)... }};
+}
+
+#define FONT_WIDTHS(specs)             getFontWidths(specs, MakeIndexSequence<CJK_FIRST_LETTER_INDEX>::type())
+
+constexpr uint16_t font_xxs_specs[] = {
 #include "font_9.specs"
 };
 
@@ -31,7 +49,7 @@ const unsigned char font_xxs[] = {
 #if LCD_H > 272
 
 #if defined(BOOT)
-const uint16_t font_std_en_specs[] = {
+constexpr uint16_t font_std_en_specs[] = {
 #include "font_17en.specs"
 };
 
@@ -40,7 +58,7 @@ const unsigned char font_std_en[] = {
 };
 #endif
 
-const uint16_t font_xs_specs[] = {
+constexpr uint16_t font_xs_specs[] = {
 #include "font_15.specs"
 };
 
@@ -48,7 +66,7 @@ const unsigned char font_xs[] = {
 #include "font_15.lbm"
 };
 
-const uint16_t font_std_specs[] = {
+constexpr uint16_t font_std_specs[] = {
 #include "font_17.specs"
 };
 
@@ -56,7 +74,7 @@ const unsigned char font_std[] = {
 #include "font_17.lbm"
 };
 
-const uint16_t font_bold_specs[] = {
+constexpr uint16_t font_bold_specs[] = {
 #include "font_bold17.specs"
 };
 
@@ -67,7 +85,7 @@ const unsigned char font_bold[] = {
 #else // LCD_H <= 272
 
 #if defined(BOOT)
-const uint16_t font_std_en_specs[] = {
+constexpr uint16_t font_std_en_specs[] = {
 #include "font_16en.specs"
 };
 
@@ -76,7 +94,7 @@ const unsigned char font_std_en[] = {
 };
 #endif
 
-const uint16_t font_xs_specs[] = {
+constexpr uint16_t font_xs_specs[] = {
 #include "font_13.specs"
 };
 
@@ -84,7 +102,7 @@ const unsigned char font_xs[] = {
 #include "font_13.lbm"
 };
 
-const uint16_t font_std_specs[] = {
+constexpr uint16_t font_std_specs[] = {
 #include "font_16.specs"
 };
 
@@ -92,7 +110,7 @@ const unsigned char font_std[] = {
 #include "font_16.lbm"
 };
 
-const uint16_t font_bold_specs[] = {
+constexpr uint16_t font_bold_specs[] = {
 #include "font_bold16.specs"
 };
 
@@ -102,7 +120,7 @@ const unsigned char font_bold[] = {
 
 #endif // LCD_H > 272
 
-const uint16_t font_l_specs[] = {
+constexpr uint16_t font_l_specs[] = {
 #include "font_24.specs"
 };
 
@@ -110,7 +128,7 @@ const unsigned char font_l[] = {
 #include "font_24.lbm"
 };
 
-const uint16_t font_xl_specs[] = {
+constexpr uint16_t font_xl_specs[] = {
 #include "font_32.specs"
 };
 
@@ -118,7 +136,7 @@ const unsigned char font_xl[] = {
 #include "font_32.lbm"
 };
 
-const uint16_t font_xxl_specs[] = {
+constexpr uint16_t font_xxl_specs[] = {
 #include "font_64.specs"
 };
 
@@ -130,6 +148,8 @@ const unsigned char font_xxl[] = {
 // -2 for: overall length and last boundary
 const uint16_t fontCharactersTable[FONTS_COUNT] = { sizeof(font_std_en_specs)/2-2 };
 const uint16_t * const fontspecsTable[FONTS_COUNT] = { font_std_en_specs };
+constexpr FontWidths<CJK_FIRST_LETTER_INDEX> font_std_en_widths = FONT_WIDTHS(font_std_en_specs);
+const uint8_t * const fontWidthsTable[FONTS_COUNT] = { font_std_en_widths.widths };
 const uint8_t * fontsTable[FONTS_COUNT] = { font_std_en };
 const int fontsSizeTable[FONTS_COUNT] = { sizeof(font_std_en) };
 #else
@@ -143,6 +163,15 @@ const uint16_t *const fontspecsTable[FONTS_COUNT] = {
     font_std_specs, font_bold_specs, font_xxs_specs, font_xs_specs,
     font_l_specs,   font_xl_specs,   font_xxl_specs
 };
+constexpr FontWidths<CJK_FIRST_LETTER_INDEX> fontWidths[FONTS_COUNT] = {
+    FONT_WIDTHS(font_std_specs), FONT_WIDTHS(font_bold_specs), FONT_WIDTHS(font_xxs_specs),
+    FONT_WIDTHS(font_xs_specs),  FONT_WIDTHS(font_l_specs),    FONT_WIDTHS(font_xl_specs),
+    FONT_WIDTHS(font_xxl_specs)
+};
+const uint8_t * const fontWidthsTable[FONTS_COUNT] = {
+    fontWidths[0].widths, fontWidths[1].widths, fontWidths[2].widths, fontWidths[3].widths,
+    fontWidths[4].widths, fontWidths[5].widths, fontWidths[6].widths
+};
 const uint8_t *fontsTable[FONTS_COUNT] = {
     font_std, font_bold, font_xxs, font_xs, font_l, font_xl, font_xxl
 };
@@ -20,4 +20,7 @@
 
 #pragma once
 
+// Widths of the glyphs before the CJK ones, in flash
+extern const uint8_t * const fontWidthsTable[FONTS_COUNT];
+
 void loadFonts();
@@ -20,6 +20,7 @@
 
 #include "lcd.h"
 #include "opentx.h"
+#include "fonts.h"
 
 uint8_t getMappedChar(uint8_t c)
 {
@@ -50,7 +51,9 @@ uint8_t getFontHeight(LcdFlags flags)
 
 int getTextWidth(const char * s, int len, LcdFlags flags)
 {
-  const uint16_t * specs = fontspecsTable[FONT_INDEX(flags)];
+  uint32_t fontindex = FONT_INDEX(flags);
+  const uint16_t * specs = fontspecsTable[fontindex];
+  const uint8_t * widths = fontWidthsTable[fontindex];
 
   int result = 0;
   for (int i = 0; len == 0 || i < len; ++i) {
@@ -66,8 +69,9 @@ int getTextWidth(const char * s, int len, LcdFlags flags)
       c += CJK_FIRST_LETTER_INDEX;
       result += getFontPatternWidth(specs, c) + 1;
     }
-    else if ((c >= 0x20u) && (c < fontCharactersTable[FONT_INDEX(flags)] + 0x20u)) {
-      result += getCharWidth(c, specs);
+    else if ((c >= 0x20u) && (c < fontCharactersTable[fontindex] + 0x20u)) {
+      c = getMappedChar(c);
+      result += (c < CJK_FIRST_LETTER_INDEX ? widths[c] : getFontPatternWidth(specs, c));
     }
     else {
       TRACE("char out-of bound: 0x%X", c);
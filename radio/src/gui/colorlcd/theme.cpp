@@ -234,6 +234,13 @@ void OpenTxTheme::drawUsbPluggedScreen(BitmapBuffer * dc) const
   dc->drawBitmapPattern((LCD_W - LBM_USB_PLUGGED_W) / 2,
                         (LCD_H - LBM_USB_PLUGGED_H) / 2,
                         LBM_USB_PLUGGED, COLOR_THEME_SECONDARY1);
+#if defined(USB_MSC_CACHE) && !defined(SIMU)
+  if (getSelectedUsbMode() == USB_MASS_STORAGE_MODE) {
+    dc->drawNumber(LCD_W / 2, (LCD_H + LBM_USB_PLUGGED_H) / 2 + 10,
+                   usbMscCache.getThroughput(),
+                   CENTERED | COLOR_THEME_SECONDARY1, 0, nullptr, " KB/s");
+  }
+#endif
 }
 
 
@@ -143,6 +143,21 @@ void StatisticsViewPage::build(FormWindow * window)
                   }, BUTTON_BACKGROUND | NO_FOCUS);
 }
 
+#if defined(DEBUG_TASKS)
+static CpuStats cpuStats;
+
+// the loads are computed over one second at least
+static const CpuStats & getCpuStats()
+{
+  static tmr10ms_t lastCpuStatsTime = 0;
+  if ((tmr10ms_t)(get_tmr10ms() - lastCpuStatsTime) >= 100) {
+    lastCpuStatsTime = get_tmr10ms();
+    updateCpuStats(cpuStats);
+  }
+  return cpuStats;
+}
+#endif
+
 void DebugViewPage::build(FormWindow * window)
 {
   FormGridLayout grid;
@@ -200,6 +215,34 @@ void DebugViewPage::build(FormWindow * window)
   }, 0, "[Audio] ", nullptr);
   grid.nextLine();
 
+#if defined(DEBUG_TASKS)
+  // CPU load and free stack of each task
+  updateCpuStats(cpuStats);
+  for (uint8_t i = 0; i < cpuStats.tasksCount; i++) {
+    new DynamicText(window, grid.getLabelSlot(), [=] {
+        const CpuStats & stats = getCpuStats();
+        return std::string(i < stats.tasksCount ? stats.tasks[i].name : "");
+    });
+    new DynamicNumber<uint16_t>(window, grid.getFieldSlot(2, 0), [=] {
+        const CpuStats & stats = getCpuStats();
+        return i < stats.tasksCount ? stats.tasks[i].load : 0;
+    }, PREC1, nullptr, "%");
+    new DebugInfoNumber<uint16_t>(window, grid.getFieldSlot(2, 1), [=] {
+        const CpuStats & stats = getCpuStats();
+        return i < stats.tasksCount ? stats.tasks[i].stackFree : 0;
+    }, 0, "[Stack] ", nullptr);
+    grid.nextLine();
+  }
+
+#if defined(DEBUG_INTERRUPTS)
+  new StaticText(window, grid.getLabelSlot(), "Interrupts");
+  new DynamicNumber<uint16_t>(window, grid.getFieldSlot(), [] {
+      return getCpuStats().interruptsLoad;
+  }, PREC1, nullptr, "%");
+  grid.nextLine();
+#endif
+#endif
+
 #if defined(DEBUG_LATENCY)
   new StaticText(window, grid.getLabelSlot(), STR_HEARTBEAT_LABEL);
   if (heartbeatCapture.valid)
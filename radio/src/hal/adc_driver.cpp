@@ -119,9 +119,8 @@ static bool adcSingleRead()
   return true;
 }
 
-// Declare adcRead() weak so it can be re-declared
-#pragma weak adcRead
-bool adcRead()
+// 4 conversions averaged, the caller waits for each of them
+static bool adcReadSingleConversions()
 {
   uint16_t temp[NUM_ANALOGS] = { 0 };
 
@@ -143,6 +142,38 @@ bool adcRead()
     adcValues[x] = temp[x] >> 2;
   }
 
+  return true;
+}
+
+// the driver samples continuously, the latest values are available immediately
+static bool adcReadLatest()
+{
+  if (!etx_hal_adc_driver->read_latest())
+    return false;
+
+#if defined(JITTER_MEASURE)
+  if (JITTER_MEASURE_ACTIVE()) {
+    for (uint8_t x=FIRST_ANALOG_ADC; x<NUM_ANALOGS; x++) {
+      rawJitter[x].measure(adcValues[x]);
+    }
+  }
+#endif
+
+  return true;
+}
+
+// Declare adcRead() weak so it can be re-declared
+#pragma weak adcRead
+bool adcRead()
+{
+  if (etx_hal_adc_driver && etx_hal_adc_driver->read_latest) {
+    if (!adcReadLatest())
+      return false;
+  }
+  else if (!adcReadSingleConversions()) {
+    return false;
+  }
+
 #if NUM_PWMSTICKS > 0
   if (STICKS_PWM_ENABLED()) {
     sticksPwmRead(adcValues);
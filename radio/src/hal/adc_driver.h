@@ -49,6 +49,10 @@ struct etx_hal_adc_driver_t {
   bool (*init)();
   bool (*start_conversion)();
   void (*wait_completion)();  
+
+  // free running drivers: copy the latest (oversampled) values into adcValues
+  // without waiting, replaces start_conversion() / wait_completion()
+  bool (*read_latest)();
 };
 
 bool adcInit(const etx_hal_adc_driver_t* driver);
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _INDEX_SEQUENCE_H_
+#define _INDEX_SEQUENCE_H_
+
+/*
+  0, 1, ... count - 1 as a template parameter pack (std::make_index_sequence is C++14),
+  used to generate tables at compile time:
+    template <unsigned... values> f(IndexSequence<values...>) { return {{g(values)...}}; }
+    f(typename MakeIndexSequence<count>::type());
+*/
+template <unsigned... values>
+struct IndexSequence {};
+
+template <unsigned count, unsigned... values>
+struct MakeIndexSequence: MakeIndexSequence<count - 1, count - 1, values...> {};
+
+template <unsigned... values>
+struct MakeIndexSequence<0, values...> {
+  typedef IndexSequence<values...> type;
+};
+
+#endif // _INDEX_SEQUENCE_H_
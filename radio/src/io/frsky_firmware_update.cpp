@@ -28,18 +28,6 @@
   #include "libopenui/src/libopenui_file.h"
 #endif
 
-#define PRIM_REQ_POWERUP    0
-#define PRIM_REQ_VERSION    1
-#define PRIM_CMD_DOWNLOAD   3
-#define PRIM_DATA_WORD      4
-#define PRIM_DATA_EOF       5
-
-#define PRIM_ACK_POWERUP    0x80
-#define PRIM_ACK_VERSION    0x81
-#define PRIM_REQ_DATA_ADDR  0x82
-#define PRIM_END_DOWNLOAD   0x83
-#define PRIM_DATA_CRC_ERR   0x84
-
 const char * readFrSkyFirmwareInformation(const char * filename, FrSkyFirmwareInformation & data)
 {
   FIL file;
@@ -134,88 +122,81 @@ bool FrskyDeviceFirmwareUpdate::readBuffer(uint8_t * buffer, uint8_t count, uint
 }
 #endif
 
-const uint8_t * FrskyDeviceFirmwareUpdate::readFullDuplexFrame(ModuleFifo & fifo, uint32_t timeout)
+// the poll functions return a frame as soon as one is complete, without waiting
+const uint8_t * FrskyDeviceFirmwareUpdate::pollFullDuplexFrame(ModuleFifo & fifo)
 {
-  uint8_t len = 0;
-  bool bytestuff = false;
-  while (len < 10) {
-    uint32_t elapsed = 0;
-    uint8_t byte;
-    while (!fifo.pop(byte)) {
-      RTOS_WAIT_MS(1);
-      if (elapsed++ >= timeout) {
-        return nullptr;
-      }
-    }
+  uint8_t byte;
+  while (fifo.pop(byte)) {
     if (byte == 0x7D) {
-      bytestuff = true;
+      frameByteStuff = true;
       continue;
     }
-    if (bytestuff) {
-      frame[len] = 0x20 ^ byte;
-      bytestuff = false;
+    if (frameByteStuff) {
+      rxFrame[frameLength] = 0x20 ^ byte;
+      frameByteStuff = false;
     }
     else {
-      frame[len] = byte;
+      rxFrame[frameLength] = byte;
     }
-    if (len > 0 || byte == 0x7E) {
-      ++len;
+    if (frameLength > 0 || byte == 0x7E) {
+      if (++frameLength == 10) {
+        frameLength = 0;
+        return &rxFrame[1];
+      }
     }
   }
-  return &frame[1];
+  return nullptr;
 }
 
-const uint8_t * FrskyDeviceFirmwareUpdate::readHalfDuplexFrame(uint32_t timeout)
+const uint8_t * FrskyDeviceFirmwareUpdate::pollHalfDuplexFrame()
 {
-  for (int i = timeout; i >= 0; i--) {
-    uint8_t byte ;
-    while (telemetryGetByte(&byte)) {
-      if (pushFrskyTelemetryData(byte)) {
-        return telemetryRxBuffer;
-      }
+  uint8_t byte;
+  while (telemetryGetByte(&byte)) {
+    if (pushFrskyTelemetryData(byte)) {
+      return telemetryRxBuffer;
     }
-    RTOS_WAIT_MS(1);
   }
   return nullptr;
 }
 
-const uint8_t * FrskyDeviceFirmwareUpdate::readFrame(uint32_t timeout)
+const uint8_t * FrskyDeviceFirmwareUpdate::pollFrame()
 {
-  RTOS_WAIT_MS(1);
-
   switch (module) {
 #if defined(INTERNAL_MODULE_PXX2)
     case INTERNAL_MODULE:
-      return readFullDuplexFrame(intmoduleFifo, timeout);
+      return pollFullDuplexFrame(intmoduleFifo);
 #endif
 
     default:
-      return readHalfDuplexFrame(timeout);
+      return pollHalfDuplexFrame();
   }
 }
 
+// each received frame is an event for the state machine, the file is read
+// ahead while the device has nothing to say
 bool FrskyDeviceFirmwareUpdate::waitState(State newState, uint32_t timeout)
 {
-#if defined(SIMU)
-  UNUSED(state);
-  UNUSED(timeout);
-  static uint8_t pass = 0;
-  if (++pass == 10) {
-    pass = 0;
-    RTOS_WAIT_MS(1);
-  }
-  return true;
-#else
   watchdogSuspend(timeout / 10);
 
-  const uint8_t * frame = readFrame(timeout);
-  if (!frame) {
-    return false;
+  uint32_t start = RTOS_GET_MS();
+  while (true) {
+    const uint8_t * frame = pollFrame();
+    if (frame) {
+      processFrame(frame);
+      if (state == newState) {
+        return true;
+      }
+      if (state == SPORT_FAIL) {
+        return false;
+      }
+    }
+    else if (RTOS_GET_MS() - start >= timeout) {
+      return false;
+    }
+    else if (!fileBuffer || !fileBuffer->prefetch()) {
+      RTOS_WAIT_MS(1);
+    }
   }
-
-  processFrame(frame);
-  return state == newState;
-#endif
 }
 
 void FrskyDeviceFirmwareUpdate::startFrame(uint8_t command)
@@ -422,9 +403,6 @@ const char * FrskyDeviceFirmwareUpdate::uploadFileToHorusXJT(const char * filena
 
 const char * FrskyDeviceFirmwareUpdate::uploadFileNormal(const char * filename, FIL * file, ProgressHandler progressHandler)
 {
-  uint32_t buffer[1024 / sizeof(uint32_t)];
-  UINT count;
-
   const char * result = sendPowerOn();
   if (result)
     return result;
@@ -436,38 +414,40 @@ const char * FrskyDeviceFirmwareUpdate::uploadFileNormal(const char * filename,
   RTOS_WAIT_MS(200);
   telemetryClearFifo();
 
+  FirmwareFileBuffer<1024> buffer(file, f_size(file) - f_tell(file));
+  uint32_t words = buffer.getSize() >> 2;
+  uint32_t base = 0;
+
+  fileBuffer = &buffer;
   state = SPORT_DATA_TRANSFER;
   startFrame(PRIM_CMD_DOWNLOAD);
   sendFrame();
 
-  while (true) {
-    if (f_read(file, buffer, 1024, &count) != FR_OK) {
-      return "Error reading file";
+  for (uint32_t i = 0; i < words; i++) {
+    if (!waitState(SPORT_DATA_REQ, 2000)) {
+      result = "Data refused";
+      break;
     }
-
-    count >>= 2;
-
-    for (uint32_t i=0; i<count; i++) {
-      if (!waitState(SPORT_DATA_REQ, 2000)) {
-        return "Data refused";
-      }
-      startFrame(PRIM_DATA_WORD);
-      uint32_t offset = (address & 1023) >> 2; // 32 bit word offset into buffer
-      *((uint32_t *)(frame + 2)) = buffer[offset];
-      frame[6] = address & 0x000000FF;
-      state = SPORT_DATA_TRANSFER,
-      sendFrame();
-      if (i == 0) {
-        progressHandler(getBasename(filename), STR_WRITING, file->fptr, file->obj.objsize);
-      }
+    if (i == 0) {
+      base = address & ~1023u;
     }
-
-    if (count < 256) {
+    const uint8_t * data = (address >= base ? buffer.get(address - base, sizeof(uint32_t)) : nullptr);
+    if (!data) {
+      result = "Error reading file";
       break;
     }
+    startFrame(PRIM_DATA_WORD);
+    memcpy(frame + 2, data, sizeof(uint32_t));
+    frame[6] = address & 0x000000FF;
+    state = SPORT_DATA_TRANSFER;
+    sendFrame();
+    if ((i & 255) == 0) {
+      progressHandler(getBasename(filename), STR_WRITING, i << 2, words << 2);
+    }
   }
 
-  return endTransfer();
+  fileBuffer = nullptr;
+  return result ? result : endTransfer();
 }
 
 const char * FrskyDeviceFirmwareUpdate::endTransfer()
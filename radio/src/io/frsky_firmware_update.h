@@ -28,6 +28,19 @@
 #include "ff.h"
 #include "popups.h"
 
+// S.Port device bootloader primitives
+#define PRIM_REQ_POWERUP    0
+#define PRIM_REQ_VERSION    1
+#define PRIM_CMD_DOWNLOAD   3
+#define PRIM_DATA_WORD      4
+#define PRIM_DATA_EOF       5
+
+#define PRIM_ACK_POWERUP    0x80
+#define PRIM_ACK_VERSION    0x81
+#define PRIM_REQ_DATA_ADDR  0x82
+#define PRIM_END_DOWNLOAD   0x83
+#define PRIM_DATA_CRC_ERR   0x84
+
 enum FrskyFirmwareProductFamily {
   FIRMWARE_FAMILY_INTERNAL_MODULE,
   FIRMWARE_FAMILY_EXTERNAL_MODULE,
@@ -111,6 +124,76 @@ PACK(struct FrSkyFirmwareInformation {
 
 const char * readFrSkyFirmwareInformation(const char * filename, FrSkyFirmwareInformation & data);
 
+// Firmware file read in chunks, double buffered: the chunk following the one
+// being transferred is read while waiting for the device
+template <unsigned CHUNK_SIZE>
+class FirmwareFileBuffer {
+  public:
+    FirmwareFileBuffer(FIL * file, uint32_t size):
+      file(file),
+      start(f_tell(file)),
+      size(size)
+    {
+    }
+
+    // returns len bytes at this offset of the firmware (zero padded after its end),
+    // nullptr on read error or when they would cross a chunk boundary
+    const uint8_t * get(uint32_t offset, uint32_t len)
+    {
+      uint32_t index = offset / CHUNK_SIZE;
+      offset %= CHUNK_SIZE;
+      if (offset + len > CHUNK_SIZE || !load(index)) {
+        return nullptr;
+      }
+      current = index;
+      return &chunks[index & 1][offset];
+    }
+
+    // reads the chunk following the last one accessed, returns false if there was nothing to read
+    bool prefetch()
+    {
+      uint32_t next = current + 1;
+      if (next * CHUNK_SIZE >= size || loaded[next & 1] == next) {
+        return false;
+      }
+      load(next);
+      return true;
+    }
+
+    uint32_t getSize() const
+    {
+      return size;
+    }
+
+  protected:
+    FIL * file;
+    uint32_t start;
+    uint32_t size;
+    uint32_t current = 0;
+    uint32_t loaded[2] = { UINT32_MAX, UINT32_MAX };
+    uint8_t chunks[2][CHUNK_SIZE];
+
+    bool load(uint32_t index)
+    {
+      uint8_t * chunk = chunks[index & 1];
+      if (loaded[index & 1] == index) {
+        return true;
+      }
+      loaded[index & 1] = UINT32_MAX;
+      uint32_t position = start + index * CHUNK_SIZE;
+      if (f_tell(file) != position && f_lseek(file, position) != FR_OK) {
+        return false;
+      }
+      UINT count;
+      if (f_read(file, chunk, CHUNK_SIZE, &count) != FR_OK) {
+        return false;
+      }
+      memset(chunk + count, 0, CHUNK_SIZE - count);
+      loaded[index & 1] = index;
+      return true;
+    }
+};
+
 class FrskyDeviceFirmwareUpdate {
     enum State {
       SPORT_IDLE,
@@ -136,14 +219,18 @@ class FrskyDeviceFirmwareUpdate {
     uint32_t address = 0;
     ModuleIndex module;
     uint8_t frame[12];
+    uint8_t rxFrame[10];
+    uint8_t frameLength = 0;
+    bool frameByteStuff = false;
+    FirmwareFileBuffer<1024> * fileBuffer = nullptr;
 
     void startFrame(uint8_t command);
     void sendFrame();
 
     bool readBuffer(uint8_t * buffer, uint8_t count, uint32_t timeout);
-    const uint8_t * readFullDuplexFrame(ModuleFifo & fifo, uint32_t timeout);
-    const uint8_t * readHalfDuplexFrame(uint32_t timeout);
-    const uint8_t * readFrame(uint32_t timeout);
+    const uint8_t * pollFullDuplexFrame(ModuleFifo & fifo);
+    const uint8_t * pollHalfDuplexFrame();
+    const uint8_t * pollFrame();
     bool waitState(State state, uint32_t timeout);
     void processFrame(const uint8_t * frame);
 
@@ -845,6 +845,126 @@ static int luaGetValue(lua_State * L)
   return 1;
 }
 
+#define LUA_SOURCEHANDLE          "SOURCE*"
+
+/*luadoc
+@function getSourceHandle(sources)
+
+Resolve a list of sources once, to read all of them later with getValues()
+
+@param sources (table) list of sources, each one can be an identifier (number) or a name (string),
+as for getValue(). Non-existing sources are kept and read as zero.
+
+@retval handle (object) an opaque handle to pass to getValues()
+
+@notice Telemetry sensor names are resolved when the handle is created, so a new handle must
+be created when the sensors are discovered or renamed.
+
+@status current Introduced in 2.5.0
+*/
+static int luaGetSourceHandle(lua_State * L)
+{
+  luaL_checktype(L, 1, LUA_TTABLE);
+  lua_Integer len = luaL_len(L, 1);
+  if (len > UINT16_MAX) {
+    // the count is stored in the first entry of the handle
+    return luaL_argerror(L, 1, "too many sources");
+  }
+  unsigned int count = len;
+
+  uint16_t * handle = (uint16_t *)lua_newuserdata(L, (count + 1) * sizeof(uint16_t));
+  handle[0] = count;
+  for (unsigned int i = 1; i <= count; i++) {
+    lua_rawgeti(L, 1, i);
+    int src = 0;
+    if (lua_type(L, -1) == LUA_TNUMBER) {
+      src = lua_tointeger(L, -1);
+    }
+    else {
+      LuaField field;
+      if (luaFindFieldByName(luaL_checkstring(L, -1), field)) {
+        src = field.id;
+      }
+    }
+    handle[i] = src;
+    lua_pop(L, 1);
+  }
+
+  luaL_newmetatable(L, LUA_SOURCEHANDLE);
+  lua_setmetatable(L, -2);
+
+  return 1;
+}
+
+/*luadoc
+@function getValues(handle, values [, mins [, maxs [, delays]]])
+
+Read the current value of all the sources of a handle in one call
+
+@param handle (object) sources handle returned by getSourceHandle()
+
+@param values (table) receives the current value of the n-th source at index n,
+with the same format as returned by getValue()
+
+@param mins (table) optional, receives the minimum value of each telemetry source, nil for other sources
+
+@param maxs (table) optional, receives the maximum value of each telemetry source, nil for other sources
+
+@param delays (table) optional, receives the delay since the last value was received for each telemetry source,
+nil for other sources or when no value was received
+
+@retval values the values table
+
+@notice The tables are filled in place, so they can be allocated once and reused on each cycle
+to avoid creating garbage.
+
+@status current Introduced in 2.5.0
+*/
+static int luaGetValues(lua_State * L)
+{
+  uint16_t * handle = (uint16_t *)luaL_checkudata(L, 1, LUA_SOURCEHANDLE);
+  luaL_checktype(L, 2, LUA_TTABLE);
+  bool mins = lua_istable(L, 3);
+  bool maxs = lua_istable(L, 4);
+  bool delays = lua_istable(L, 5);
+
+  for (unsigned int i = 1; i <= handle[0]; i++) {
+    int src = handle[i];
+    luaGetValueAndPush(L, src);
+    lua_rawseti(L, 2, i);
+
+    if (mins || maxs || delays) {
+      bool telemetry = (src >= MIXSRC_FIRST_TELEM && src <= MIXSRC_LAST_TELEM);
+      int first = (telemetry ? src - (src - MIXSRC_FIRST_TELEM) % 3 : 0);
+      if (mins) {
+        if (telemetry)
+          luaGetValueAndPush(L, first + 1);
+        else
+          lua_pushnil(L);
+        lua_rawseti(L, 3, i);
+      }
+      if (maxs) {
+        if (telemetry)
+          luaGetValueAndPush(L, first + 2);
+        else
+          lua_pushnil(L);
+        lua_rawseti(L, 4, i);
+      }
+      if (delays) {
+        int8_t delay = (telemetry ? telemetryItems[(first - MIXSRC_FIRST_TELEM) / 3].getDelaySinceLastValue() : -1);
+        if (delay >= 0)
+          lua_pushinteger(L, delay);
+        else
+          lua_pushnil(L);
+        lua_rawseti(L, 5, i);
+      }
+    }
+  }
+
+  lua_pushvalue(L, 2);
+  return 1;
+}
+
 /*luadoc
 @function getRAS()
 
@@ -1590,6 +1710,45 @@ static int luaGetAvailableMemory(lua_State * L)
   return 1;
 }
 
+#if defined(DEBUG_TASKS)
+/*luadoc
+@function getCpuStats()
+
+Get the CPU load of each task since the previous call to getCpuStats() (only in firmwares built with DEBUG_TASKS)
+
+@retval table with elements:
+ * `period` (number) duration covered by the values in us
+ * `interrupts` (number) time spent in interrupts handlers, in 0.1% (only with DEBUG_INTERRUPTS)
+ * `tasks` (table) one element per task, with `name` (string), `load` (number, 0.1%)
+   and `stack` (number, words never used by the task)
+
+@status current Introduced in 2.5.0
+*/
+static int luaGetCpuStats(lua_State * L)
+{
+  static CpuStats cpuStats;
+  updateCpuStats(cpuStats);
+  lua_newtable(L);
+  lua_pushtableinteger(L, "period", cpuStats.period);
+#if defined(DEBUG_INTERRUPTS)
+  lua_pushtableinteger(L, "interrupts", cpuStats.interruptsLoad);
+#endif
+  lua_pushstring(L, "tasks");
+  lua_newtable(L);
+  for (uint8_t i = 0; i < cpuStats.tasksCount; i++) {
+    const TaskStats & task = cpuStats.tasks[i];
+    lua_pushinteger(L, i + 1);
+    lua_newtable(L);
+    lua_pushtablestring(L, "name", task.name);
+    lua_pushtableinteger(L, "load", task.load);
+    lua_pushtableinteger(L, "stack", task.stackFree);
+    lua_settable(L, -3);
+  }
+  lua_settable(L, -3);
+  return 1;
+}
+#endif
+
 /*luadoc
 @function resetGlobalTimer([type])
 
@@ -1798,6 +1957,8 @@ const luaL_Reg opentxLib[] = {
   { "getGlobalTimer", luaGetGlobalTimer },
   { "getRotEncSpeed", luaGetRotEncSpeed },
   { "getValue", luaGetValue },
+  { "getSourceHandle", luaGetSourceHandle },
+  { "getValues", luaGetValues },
   { "getRAS", luaGetRAS },
   { "getTxGPS", luaGetTxGPS },
   { "getFieldInfo", luaGetFieldInfo },
@@ -1820,6 +1981,9 @@ const luaL_Reg opentxLib[] = {
   { "loadScript", luaLoadScript },
   { "getUsage", luaGetUsage },
   { "getAvailableMemory", luaGetAvailableMemory },
+#if defined(DEBUG_TASKS)
+  { "getCpuStats", luaGetCpuStats },
+#endif
   { "resetGlobalTimer", luaResetGlobalTimer },
 #if LCD_DEPTH > 1 && !defined(COLORLCD)
   { "GREY", luaGrey },
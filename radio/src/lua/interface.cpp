@@ -228,6 +228,9 @@ void luaDisable()
 {
   POPUP_WARNING("Lua disabled!");
   luaState = INTERPRETER_PANIC;
+#if defined(LUA_CHUNK_CACHE_SIZE) && LUA_CHUNK_CACHE_SIZE > 0
+  luaChunkCacheClear();
+#endif
 }
 
 void luaClose(lua_State ** L)
@@ -327,17 +330,25 @@ void luaFree(lua_State * L, ScriptInternalData & sid)
 }
 
 #if defined(LUA_COMPILER)
+struct LuaDumpOutput {
+  FIL file;
+  lua_Writer copyWriter;  // optional second output, its errors are ignored
+  void * copyData;
+};
+
 /// callback for luaU_dump()
 static int luaDumpWriter(lua_State * L, const void* p, size_t size, void* u)
 {
-  UNUSED(L);
+  LuaDumpOutput * output = (LuaDumpOutput *)u;
   UINT written;
-  FRESULT result = f_write((FIL *)u, p, size, &written);
+  if (output->copyWriter)
+    output->copyWriter(L, p, size, output->copyData);
+  FRESULT result = f_write(&output->file, p, size, &written);
   return (result != FR_OK && !written);
 }
 
 /*
-  @fn luaDumpState(lua_State * L, const char * filename, const FILINFO * finfo, int stripDebug)
+  @fn luaDumpState(lua_State * L, const char * filename, const FILINFO * finfo, int stripDebug, lua_Writer copyWriter, void * copyData)
   Save compiled bytecode from a given Lua stack to a file.
   @param L The Lua stack to dump.
   @param filename Full path and name of file to save to (typically with .luac extension).
@@ -345,15 +356,18 @@ static int luaDumpWriter(lua_State * L, const void* p, size_t size, void* u)
   @param stripDebug This is passed directly to luaU_dump()
     1 = remove debug info from bytecode (smaller but errors are less informative)
     0 = keep debug info
+  @param copyWriter Can be NULL. If not NULL, also receives the bytecode (with copyData), so that it doesn't need to be dumped twice
 */
-static void luaDumpState(lua_State * L, const char * filename, const FILINFO * finfo, int stripDebug)
+static void luaDumpState(lua_State * L, const char * filename, const FILINFO * finfo, int stripDebug, lua_Writer copyWriter = nullptr, void * copyData = nullptr)
 {
-  FIL D;
-  if (f_open(&D, filename, FA_WRITE | FA_CREATE_ALWAYS) == FR_OK) {
+  LuaDumpOutput output;
+  output.copyWriter = copyWriter;
+  output.copyData = copyData;
+  if (f_open(&output.file, filename, FA_WRITE | FA_CREATE_ALWAYS) == FR_OK) {
     lua_lock(L);
-    luaU_dump(L, getproto(L->top - 1), luaDumpWriter, &D, stripDebug);
+    luaU_dump(L, getproto(L->top - 1), luaDumpWriter, &output, stripDebug);
     lua_unlock(L);
-    if (f_close(&D) == FR_OK) {
+    if (f_close(&output.file) == FR_OK) {
       if (finfo != nullptr)
         f_utime(filename, finfo);  // set the file mod time
       TRACE("luaDumpState(%s): Saved bytecode to file.", filename);
@@ -363,6 +377,196 @@ static void luaDumpState(lua_State * L, const char * filename, const FILINFO * f
 }
 #endif  // LUA_COMPILER
 
+#if defined(LUA_CHUNK_CACHE_SIZE) && LUA_CHUNK_CACHE_SIZE > 0
+/*
+  Compiled chunks cache.
+  The Lua states are closed on each model switch, so the loaded prototypes can't be kept.
+  Instead we keep the bytecode of the last loaded scripts in RAM and undump it from memory
+  on the next load. The bytecode is never dumped for the cache only: it is either the content
+  of the .luac file which was loaded, or a copy of the one written when a source is compiled.
+  Entries are keyed by the path of the loaded file, its timestamp/size and the kind of chunk.
+  The cache is allocated outside of the Lua heap, it is released when a Lua allocation fails.
+*/
+#define LUA_CHUNK_CACHE_ENTRIES  32
+
+enum LuaChunkKind {
+  LUA_CHUNK_SOURCE,   // source compiled with its debug info, same as loading the .lua file
+  LUA_CHUNK_BINARY,   // content of a precompiled file
+};
+
+struct LuaChunkCacheEntry {
+  char * data;        // null-terminated file path, followed by the bytecode
+  uint32_t size;      // bytecode size
+  uint32_t stamp;     // file date/time
+  uint32_t fsize;     // file size
+  uint32_t lastUse;
+  uint8_t kind;
+};
+
+static LuaChunkCacheEntry luaChunkCache[LUA_CHUNK_CACHE_ENTRIES];
+static LuaChunkCacheEntry * luaChunkCacheLoading = nullptr;  // entry being undumped, can't be released
+static uint32_t luaChunkCacheUsed = 0;
+static uint32_t luaChunkCacheCounter = 0;
+
+struct LuaChunkBuffer {
+  char * data;        // null-terminated file path, followed by the bytecode
+  uint32_t size;
+  uint32_t capacity;
+};
+
+static bool luaChunkBufferInit(LuaChunkBuffer & buffer, const char * filename, uint32_t capacity)
+{
+  uint32_t pathLen = strlen(filename) + 1;
+  buffer.size = pathLen;
+  buffer.capacity = pathLen + capacity;
+  buffer.data = (buffer.capacity <= LUA_CHUNK_CACHE_SIZE ? (char *)malloc(buffer.capacity) : nullptr);
+  if (!buffer.data)
+    return false;
+  memcpy(buffer.data, filename, pathLen);
+  return true;
+}
+
+static void luaChunkBufferFree(LuaChunkBuffer & buffer)
+{
+  free(buffer.data);
+  buffer.data = nullptr;
+}
+
+/// callback for luaU_dump() into a RAM buffer, the buffer is dropped when it exceeds the cache size
+static int luaChunkWriter(lua_State * L, const void * p, size_t size, void * u)
+{
+  UNUSED(L);
+  LuaChunkBuffer * buffer = (LuaChunkBuffer *)u;
+  if (!buffer->data)
+    return 1;
+  if (buffer->size + size > buffer->capacity) {
+    uint32_t capacity = max<uint32_t>(2 * buffer->capacity, buffer->size + size);
+    if (capacity > LUA_CHUNK_CACHE_SIZE)
+      capacity = LUA_CHUNK_CACHE_SIZE;
+    char * data = (buffer->size + size <= capacity ? (char *)realloc(buffer->data, capacity) : nullptr);
+    if (!data) {
+      luaChunkBufferFree(*buffer);
+      return 1;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+  }
+  memcpy(buffer->data + buffer->size, p, size);
+  buffer->size += size;
+  return 0;
+}
+
+// Read a whole precompiled file into a buffer
+static bool luaChunkBufferRead(LuaChunkBuffer & buffer, const char * filename, const FILINFO & finfo)
+{
+  FIL file;
+  UINT read;
+
+  if (!luaChunkBufferInit(buffer, filename, finfo.fsize))
+    return false;
+
+  if (f_open(&file, filename, FA_OPEN_EXISTING | FA_READ) == FR_OK) {
+    FRESULT result = f_read(&file, buffer.data + buffer.size, finfo.fsize, &read);
+    f_close(&file);
+    if (result == FR_OK && read == finfo.fsize) {
+      buffer.size += read;
+      return true;
+    }
+  }
+
+  luaChunkBufferFree(buffer);
+  return false;
+}
+
+static void luaChunkCacheFree(LuaChunkCacheEntry & entry)
+{
+  if (entry.data) {
+    luaChunkCacheUsed -= entry.size + strlen(entry.data) + 1;
+    free(entry.data);
+    entry.data = nullptr;
+  }
+}
+
+void luaChunkCacheClear()
+{
+  for (auto & entry: luaChunkCache) {
+    luaChunkCacheFree(entry);
+  }
+}
+
+bool luaChunkCacheRelease()
+{
+  bool released = false;
+  for (auto & entry: luaChunkCache) {
+    if (entry.data && &entry != luaChunkCacheLoading) {
+      luaChunkCacheFree(entry);
+      released = true;
+    }
+  }
+  if (released) {
+    TRACE("luaChunkCacheRelease(): cache released (%u bytes still used)", luaChunkCacheUsed);
+  }
+  return released;
+}
+
+static LuaChunkCacheEntry * luaChunkCacheFind(const char * filename, const FILINFO & finfo, uint8_t kind)
+{
+  uint32_t stamp = (finfo.fdate << 16) + finfo.ftime;
+  for (auto & entry: luaChunkCache) {
+    if (entry.data && entry.kind == kind && !strcmp(entry.data, filename)) {
+      if (entry.stamp == stamp && entry.fsize == (uint32_t)finfo.fsize) {
+        entry.lastUse = ++luaChunkCacheCounter;
+        return &entry;
+      }
+      // the file has changed since it was cached
+      luaChunkCacheFree(entry);
+      return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+// Store the bytecode of a buffer in the cache, which takes the ownership of the buffer
+static void luaChunkCacheAdd(LuaChunkBuffer & buffer, const FILINFO & finfo, uint8_t kind)
+{
+  uint32_t pathLen = strlen(buffer.data) + 1;
+
+  if (buffer.size <= pathLen) {
+    luaChunkBufferFree(buffer);
+    return;
+  }
+
+  // evict least recently used chunks until the new one fits
+  LuaChunkCacheEntry * slot = nullptr;
+  while (true) {
+    LuaChunkCacheEntry * oldest = nullptr;
+    for (auto & entry: luaChunkCache) {
+      if (!entry.data) {
+        slot = &entry;
+      }
+      else if (!oldest || entry.lastUse < oldest->lastUse) {
+        oldest = &entry;
+      }
+    }
+    if (slot && luaChunkCacheUsed + buffer.size <= LUA_CHUNK_CACHE_SIZE)
+      break;
+    luaChunkCacheFree(*oldest);
+  }
+
+  // give back the unused capacity
+  char * data = (char *)realloc(buffer.data, buffer.size);
+  slot->data = (data ? data : buffer.data);
+  slot->size = buffer.size - pathLen;
+  slot->stamp = (finfo.fdate << 16) + finfo.ftime;
+  slot->fsize = finfo.fsize;
+  slot->lastUse = ++luaChunkCacheCounter;
+  slot->kind = kind;
+  luaChunkCacheUsed += buffer.size;
+  buffer.data = nullptr;
+  TRACE("luaChunkCacheAdd(%s): %u bytes (total %u)", slot->data, slot->size, luaChunkCacheUsed);
+}
+#endif  // LUA_CHUNK_CACHE_SIZE
+
 /**
   @fn luaLoadScriptFileToState(lua_State * L, const char * filename, const char * mode)
   Load a Lua script file into a given lua_State (stack).  May use OpenTx's optional pre-compilation
@@ -491,8 +695,55 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
 
 #endif
 
+#if defined(LUA_CHUNK_CACHE_SIZE) && LUA_CHUNK_CACHE_SIZE > 0
+  LuaChunkBuffer chunk = { nullptr, 0, 0 };
+#if defined(LUA_COMPILER)
+  // sources are cached when they get compiled with their debug info, "c" mode always compiles them
+  uint8_t chunkKind = (loadFileType == 2 ? LUA_CHUNK_BINARY : LUA_CHUNK_SOURCE);
+  const FILINFO & fnoCache = (loadFileType == 2 ? fnoLuaC : fnoLuaS);
+  bool cacheable = !strchr(lmode, 'c');
+#else
+  // only the precompiled files are cached
+  uint8_t chunkKind = LUA_CHUNK_BINARY;
+  const char * ext = getFileExtension(filenameFull);
+  FILINFO fnoCache;
+  bool cacheable = (ext && !strcasecmp(ext, SCRIPT_BIN_EXT) && f_stat(filenameFull, &fnoCache) == FR_OK);
+#endif
+  LuaChunkCacheEntry * cached = (cacheable ? luaChunkCacheFind(filenameFull, fnoCache, chunkKind) : nullptr);
+  if (cached) {
+    TRACE("luaLoadScriptFileToState(%s, %s): loading %s from cache", filename, lmode, filenameFull);
+    lua_pushfstring(L, "@%s", filenameFull);
+    luaChunkCacheLoading = cached;
+    lstatus = luaL_loadbufferx(L, cached->data + strlen(cached->data) + 1, cached->size, lua_tostring(L, -1), "b");
+    luaChunkCacheLoading = nullptr;
+    lua_remove(L, -2);
+    if (lstatus == LUA_OK) {
+      return SCRIPT_OK;
+    }
+    // fall back to the file
+    lua_pop(L, 1);
+    luaChunkCacheFree(*cached);
+  }
+  else if (cacheable && chunkKind == LUA_CHUNK_BINARY) {
+    // read the file once, the same buffer is undumped and kept in the cache
+    luaChunkBufferRead(chunk, filenameFull, fnoCache);
+  }
+#endif
+
   TRACE("luaLoadScriptFileToState(%s, %s): loading %s", filename, lmode, filenameFull);
 
+#if defined(LUA_CHUNK_CACHE_SIZE) && LUA_CHUNK_CACHE_SIZE > 0
+  if (chunk.data) {
+    lua_pushfstring(L, "@%s", filenameFull);
+    lstatus = luaL_loadbufferx(L, chunk.data + strlen(chunk.data) + 1, chunk.size - strlen(chunk.data) - 1, lua_tostring(L, -1), nullptr);
+    lua_remove(L, -2);
+    if (lstatus == LUA_OK)
+      luaChunkCacheAdd(chunk, fnoCache, chunkKind);
+    else
+      luaChunkBufferFree(chunk);
+  }
+  else
+#endif
   // we don't pass <mode> on to loadfilex() because we want lua to load whatever file we specify, regardless of content
   lstatus = luaL_loadfilex(L, filenameFull, nullptr);
 #if defined(LUA_COMPILER)
@@ -506,8 +757,19 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
   }
   if (lstatus == LUA_OK) {
     if (scriptNeedsCompile && loadFileType == 1) {
+      int stripDebug = (strchr(lmode, 'd') ? 0 : 1);
+#if defined(LUA_CHUNK_CACHE_SIZE) && LUA_CHUNK_CACHE_SIZE > 0
+      // a stripped chunk is not equivalent to the source, it will be cached when the .luac file gets loaded
+      if (!stripDebug)
+        luaChunkBufferInit(chunk, filenameFull, 1024);
       strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
-      luaDumpState(L, filenameFull, &fnoLuaS, (strchr(lmode, 'd') ? 0 : 1));
+      luaDumpState(L, filenameFull, &fnoLuaS, stripDebug, luaChunkWriter, &chunk);
+      if (chunk.data)
+        luaChunkCacheAdd(chunk, fnoLuaS, LUA_CHUNK_SOURCE);
+#else
+      strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
+      luaDumpState(L, filenameFull, &fnoLuaS, stripDebug);
+#endif
     }
     ret = SCRIPT_OK;
   }
@@ -1161,6 +1423,150 @@ static bool resumeLua(bool init, bool allowLcdUsage)
 } //resumeLua(...)
 
 
+#if defined(LUA_COMPILER)
+/*
+  Background pre-compilation of the scripts found in the sub-directories of /SCRIPTS and /WIDGETS.
+  One file is checked on each step, so that the first load of a script after a model switch
+  finds an up-to-date .luac file instead of compiling it synchronously.
+*/
+#define LUA_PRECOMPILE_PERIOD_TICKS  10   // 100 ms between two files
+
+static const char * const luaPrecompileRoots[] = {
+  SCRIPTS_PATH,
+#if defined(COLORLCD)
+  WIDGETS_PATH,
+#endif
+};
+
+struct LuaPrecompileState {
+  bool done;
+  uint8_t root;         // index in luaPrecompileRoots
+  uint8_t depth;        // 0: listing a root directory, 1: listing one of its sub-directories
+  tmr10ms_t nextStep;
+  DIR dirs[2];
+  char path[sizeof(WIDGETS_PATH) + 2 * (FF_MAX_LFN + 1)];
+};
+
+static LuaPrecompileState luaPrecompileState;
+
+static void luaPrecompileFile(const char * filename)
+{
+  char filenameBin[sizeof(luaPrecompileState.path) + 1];
+  FILINFO fnoLuaS, fnoLuaC;
+
+  if (f_stat(filename, &fnoLuaS) != FR_OK)
+    return;
+
+  uint16_t fnamelen = strlen(filename) - (sizeof(SCRIPT_EXT) - 1);
+  memcpy(filenameBin, filename, fnamelen);
+  strcpy(filenameBin + fnamelen, SCRIPT_BIN_EXT);
+
+  if (f_stat(filenameBin, &fnoLuaC) == FR_OK &&
+      (uint32_t)((fnoLuaC.fdate << 16) + fnoLuaC.ftime) >= (uint32_t)((fnoLuaS.fdate << 16) + fnoLuaS.ftime)) {
+    // already up-to-date
+    return;
+  }
+
+  // compile into the main thread, lsScripts may be a yielded coroutine
+  PROTECT_LUA() {
+    if (luaL_loadfilex(L, filename, "t") == LUA_OK) {
+      luaDumpState(L, filenameBin, &fnoLuaS, (strchr(LUA_SCRIPT_LOAD_MODE, 'd') ? 0 : 1));
+    }
+    else {
+      TRACE_ERROR("luaPrecompileFile(%s): %s\n", filename, lua_tostring(L, -1));
+    }
+    lua_pop(L, 1);
+  }
+  else {
+    luaDisable();
+  }
+  UNPROTECT_LUA();
+}
+
+// Check the next file, returns false once all directories have been walked
+static bool luaPrecompileStep()
+{
+  LuaPrecompileState & state = luaPrecompileState;
+  FILINFO fno;
+
+  if (state.done)
+    return false;
+
+  if (strchr(LUA_SCRIPT_LOAD_MODE, 'x') || !sdMounted() || !L) {
+    state.done = true;
+    return false;
+  }
+
+  char * name = state.path + strlen(state.path);
+
+  if (state.depth == 0 && name == state.path) {
+    // start listing the current root
+    if (state.root >= DIM(luaPrecompileRoots)) {
+      TRACE("luaPrecompileStep(): done");
+      state.done = true;
+      return false;
+    }
+    strcpy(state.path, luaPrecompileRoots[state.root]);
+    if (f_opendir(&state.dirs[0], state.path) != FR_OK) {
+      state.path[0] = '\0';
+      state.root++;
+    }
+    return true;
+  }
+
+  if (f_readdir(&state.dirs[state.depth], &fno) != FR_OK || fno.fname[0] == '\0') {
+    // end of directory
+    f_closedir(&state.dirs[state.depth]);
+    if (state.depth == 0) {
+      state.path[0] = '\0';
+      state.root++;
+    }
+    else {
+      *strrchr(state.path, '/') = '\0';
+      state.depth--;
+    }
+    return true;
+  }
+
+  if (fno.fname[0] == '.' || (name - state.path) + 1 + strlen(fno.fname) >= sizeof(state.path))
+    return true;
+
+  if (fno.fattrib & AM_DIR) {
+    if (state.depth == 0) {
+      *name = '/';
+      strcpy(name + 1, fno.fname);
+      if (f_opendir(&state.dirs[1], state.path) == FR_OK)
+        state.depth = 1;
+      else
+        *name = '\0';
+    }
+    return true;
+  }
+
+  const char * ext = getFileExtension(fno.fname);
+  if (state.depth == 1 && ext && !strcasecmp(ext, SCRIPT_EXT)) {
+    *name = '/';
+    strcpy(name + 1, fno.fname);
+    luaPrecompileFile(state.path);
+    *name = '\0';
+  }
+
+  return true;
+}
+#endif
+
+void luaSdRemounted()
+{
+#if defined(LUA_COMPILER)
+  // the directories handles were lost with the unmount, walk the card again
+  memset(&luaPrecompileState, 0, sizeof(luaPrecompileState));
+#endif
+#if defined(LUA_CHUNK_CACHE_SIZE) && LUA_CHUNK_CACHE_SIZE > 0
+  // files may have been replaced from the PC with the same date and size
+  luaChunkCacheClear();
+#endif
+}
+
 bool luaTask(event_t evt, bool allowLcdUsage)
 {
   bool init = false;
@@ -1201,6 +1607,15 @@ bool luaTask(event_t evt, bool allowLcdUsage)
       }
       else luaDisable();
       UNPROTECT_LUA();
+
+#if defined(LUA_COMPILER)
+      // use the idle time of the background pass to pre-compile the scripts
+      if (!allowLcdUsage && scriptInternalData[0].reference != SCRIPT_STANDALONE &&
+          luaState == INTERPRETER_RUNNING && (int32_t)(get_tmr10ms() - luaPrecompileState.nextStep) >= 0) {
+        if (luaPrecompileStep())
+          luaPrecompileState.nextStep = get_tmr10ms() + LUA_PRECOMPILE_PERIOD_TICKS;
+      }
+#endif
   }
   return scriptWasRun;
 }
@@ -1241,13 +1656,13 @@ void luaInit()
 
   if (luaState != INTERPRETER_PANIC) {
 #if defined(USE_BIN_ALLOCATOR)
-    L = lua_newstate(bin_l_alloc, nullptr);   //we use our own allocator!
+    L = lua_newstate(LUA_ALLOC(bin_l_alloc), nullptr);   //we use our own allocator!
 #elif defined(LUA_ALLOCATOR_TRACER)
     memset(&lsScriptsTrace, 0 , sizeof(lsScriptsTrace);
     lsScriptsTrace.script = "lua_newstate(scripts)";
-    L = lua_newstate(tracer_alloc, &lsScriptsTrace);   //we use tracer allocator
+    L = lua_newstate(LUA_ALLOC(tracer_alloc), &lsScriptsTrace);   //we use tracer allocator
 #else
-    L = lua_newstate(l_alloc, nullptr);   //we use Lua default allocator
+    L = lua_newstate(LUA_ALLOC(l_alloc), nullptr);   //we use Lua default allocator
 #endif
     if (L) {
       // install our panic handler
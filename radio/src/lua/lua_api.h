@@ -210,6 +210,29 @@ void registerBitmapClass(lua_State * L);
 void luaSetInstructionsLimit(lua_State* L, int count);
 int luaLoadScriptFileToState(lua_State * L, const char * filename, const char * mode);
 
+#if defined(LUA_CHUNK_CACHE_SIZE) && LUA_CHUNK_CACHE_SIZE > 0
+// Free the compiled chunks kept in RAM
+void luaChunkCacheClear();
+// Same, except the chunk being loaded, returns true if some memory was freed
+bool luaChunkCacheRelease();
+
+// The chunks cache is allocated outside of the Lua heap, it is released before an allocation fails
+template <lua_Alloc alloc>
+void * luaCacheReleasingAlloc(void * ud, void * ptr, size_t osize, size_t nsize)
+{
+  void * res = alloc(ud, ptr, osize, nsize);
+  if (!res && nsize > 0 && luaChunkCacheRelease())
+    res = alloc(ud, ptr, osize, nsize);
+  return res;
+}
+#define LUA_ALLOC(alloc)                luaCacheReleasingAlloc<alloc>
+#else
+#define LUA_ALLOC(alloc)                alloc
+#endif
+
+// The SD card has been mounted again, its content may have changed
+void luaSdRemounted();
+
 // Unregister LUA widget factories
 void luaUnregisterWidgets();
 
@@ -763,13 +763,13 @@ void luaInitThemesAndWidgets()
   TRACE("luaInitThemesAndWidgets");
 
 #if defined(USE_BIN_ALLOCATOR)
-  lsWidgets = lua_newstate(bin_l_alloc, NULL);   //we use our own allocator!
+  lsWidgets = lua_newstate(LUA_ALLOC(bin_l_alloc), NULL);   //we use our own allocator!
 #elif defined(LUA_ALLOCATOR_TRACER)
   memset(&lsWidgetsTrace, 0 , sizeof(lsWidgetsTrace));
   lsWidgetsTrace.script = "lua_newstate(widgets)";
-  lsWidgets = lua_newstate(tracer_alloc, &lsWidgetsTrace);   //we use tracer allocator
+  lsWidgets = lua_newstate(LUA_ALLOC(tracer_alloc), &lsWidgetsTrace);   //we use tracer allocator
 #else
-  lsWidgets = lua_newstate(l_alloc, NULL);   //we use Lua default allocator
+  lsWidgets = lua_newstate(LUA_ALLOC(l_alloc), NULL);   //we use Lua default allocator
 #endif
   if (lsWidgets) {
     // install our panic handler
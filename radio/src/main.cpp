@@ -158,10 +158,22 @@ void handleUsbConnection()
     }
   }
 
+#if defined(USB_MSC_CACHE)
+  if (usbStarted() && getSelectedUsbMode() == USB_MASS_STORAGE_MODE) {
+    // the cache is also used from the USB interrupt
+    NVIC_DisableIRQ(OTG_FS_IRQn);
+    usbMscCache.flushIfIdle();
+    NVIC_EnableIRQ(OTG_FS_IRQn);
+  }
+#endif
+
   if (usbStarted() && !usbPlugged()) {
     usbStop();
     TRACE("USB stopped");
     if (getSelectedUsbMode() == USB_MASS_STORAGE_MODE) {
+#if defined(USB_MSC_CACHE)
+      usbMscCache.stop();
+#endif
       opentxResume();
       pushEvent(EVT_ENTRY);
     }
@@ -481,6 +493,7 @@ void perMain()
 #endif
 
   checkSpeakerVolume();
+  playTimerEvents();
 
   if (!usbPlugged() || (getSelectedUsbMode() == USB_UNSELECTED_MODE)) {
     checkEeprom();
@@ -544,6 +557,10 @@ void perMain()
     // disable access to menus
     lcdClear();
     menuMainView(0);
+#if defined(USB_MSC_CACHE) && !defined(SIMU)
+    lcdDrawText(LCD_W, LCD_H - FH, "KB/s", RIGHT | SMLSIZE);
+    lcdDrawNumber(lcdLastLeftPos - 1, LCD_H - FH, usbMscCache.getThroughput(), RIGHT | SMLSIZE);
+#endif
     lcdRefresh();
 #endif
     return;
@@ -20,6 +20,7 @@
 
 #include "opentx.h"
 #include "timers.h"
+#include "sources.h"
 
 int8_t  virtualInputsTrims[MAX_INPUTS];
 int16_t anas [MAX_INPUTS] = {0};
@@ -298,127 +299,113 @@ int16_t applyLimits(uint8_t channel, int32_t value)
 
 getvalue_t getValue(mixsrc_t i)
 {
-  if (i == MIXSRC_NONE) {
-    return 0;
-  }
-  else if (i <= MIXSRC_LAST_INPUT) {
-    return anas[i-MIXSRC_FIRST_INPUT];
-  }
-#if defined(LUA_INPUTS)
-  else if (i <= MIXSRC_LAST_LUA) {
+  switch (SourceDispatch::get(i)) {
+    case SOURCE_KIND_INPUT:
+      return anas[i - MIXSRC_FIRST_INPUT];
+
 #if defined(LUA_MODEL_SCRIPTS)
-    div_t qr = div(i-MIXSRC_FIRST_LUA, MAX_SCRIPT_OUTPUTS);
-    return scriptInputsOutputs[qr.quot].outputs[qr.rem].value;
-#else
-    return 0;
-#endif
-  }
+    case SOURCE_KIND_LUA:
+    {
+      div_t qr = div(i - MIXSRC_FIRST_LUA, MAX_SCRIPT_OUTPUTS);
+      return scriptInputsOutputs[qr.quot].outputs[qr.rem].value;
+    }
 #endif
 
-  else if (i <= MIXSRC_LAST_POT + NUM_MOUSE_ANALOGS) {
-    return calibratedAnalogs[i - MIXSRC_Rud];
-  }
+    case SOURCE_KIND_ANALOG:
+      return calibratedAnalogs[i - MIXSRC_Rud];
 
 #if defined(GYRO)
-  else if (i == MIXSRC_GYRO1) {
-    return gyro.scaledX();
-  }
-  else if (i == MIXSRC_GYRO2) {
-    return gyro.scaledY();
-  }
+    case SOURCE_KIND_GYRO_X:
+      return gyro.scaledX();
+
+    case SOURCE_KIND_GYRO_Y:
+      return gyro.scaledY();
 #endif
 
-  else if (i == MIXSRC_MAX) {
-    return 1024;
-  }
+    case SOURCE_KIND_MAX:
+      return 1024;
 
-  else if (i <= MIXSRC_CYC3) {
 #if defined(HELI)
-    return cyc_anas[i - MIXSRC_CYC1];
-#else
-    return 0;
+    case SOURCE_KIND_HELI:
+      return cyc_anas[i - MIXSRC_CYC1];
 #endif
-  }
 
-  else if (i <= MIXSRC_LAST_TRIM) {
-    return calc1000toRESX((int16_t)8 * getTrimValue(mixerCurrentFlightMode, i-MIXSRC_FIRST_TRIM));
-  }
+    case SOURCE_KIND_TRIM:
+      return calc1000toRESX((int16_t)8 * getTrimValue(mixerCurrentFlightMode, i - MIXSRC_FIRST_TRIM));
 
-  // TODO : find a better define
+    // TODO : find a better define
 #if defined(PCBFRSKY) || defined(PCBFLYSKY)
-  else if (i >= MIXSRC_FIRST_SWITCH && i <= MIXSRC_LAST_SWITCH) {
-    mixsrc_t sw = i - MIXSRC_FIRST_SWITCH;
-    if (SWITCH_EXISTS(sw)) {
-      return (switchState(3*sw) ? -1024 : (IS_CONFIG_3POS(sw) && switchState(3*sw+1) ? 0 : 1024));
-    }
-    else {
-      return 0;
+    case SOURCE_KIND_SWITCH:
+    {
+      mixsrc_t sw = i - MIXSRC_FIRST_SWITCH;
+      if (SWITCH_EXISTS(sw)) {
+        return (switchState(3*sw) ? -1024 : (IS_CONFIG_3POS(sw) && switchState(3*sw+1) ? 0 : 1024));
+      }
+      else {
+        return 0;
+      }
     }
-  }
 #else
-  else if (i == MIXSRC_3POS) {
-    return (getSwitch(SW_ID0+1) ? -1024 : (getSwitch(SW_ID1+1) ? 0 : 1024));
-  }
-  // don't use switchState directly to give getSwitch possibility to hack values if needed for switch warning
-  else if (i < MIXSRC_SW1) {
-    return getSwitch(SWSRC_THR+i-MIXSRC_THR) ? 1024 : -1024;
-  }
+    case SOURCE_KIND_3POS:
+      return (getSwitch(SW_ID0+1) ? -1024 : (getSwitch(SW_ID1+1) ? 0 : 1024));
+
+    // don't use switchState directly to give getSwitch possibility to hack values if needed for switch warning
+    case SOURCE_KIND_SWITCH:
+      return getSwitch(SWSRC_THR+i-MIXSRC_THR) ? 1024 : -1024;
 #endif
 
-  else if (i <= MIXSRC_LAST_LOGICAL_SWITCH) {
-    return getSwitch(SWSRC_FIRST_LOGICAL_SWITCH + i - MIXSRC_FIRST_LOGICAL_SWITCH) ? 1024 : -1024;
-  }
-  else if (i <= MIXSRC_LAST_TRAINER) {
-    int16_t x = ppmInput[i - MIXSRC_FIRST_TRAINER];
-    if (i < MIXSRC_FIRST_TRAINER + NUM_CAL_PPM) {
-      x -= g_eeGeneral.trainer.calib[i - MIXSRC_FIRST_TRAINER];
+    case SOURCE_KIND_LOGICAL_SWITCH:
+      return getSwitch(SWSRC_FIRST_LOGICAL_SWITCH + i - MIXSRC_FIRST_LOGICAL_SWITCH) ? 1024 : -1024;
+
+    case SOURCE_KIND_TRAINER:
+    {
+      int16_t x = ppmInput[i - MIXSRC_FIRST_TRAINER];
+      if (i < MIXSRC_FIRST_TRAINER + NUM_CAL_PPM) {
+        x -= g_eeGeneral.trainer.calib[i - MIXSRC_FIRST_TRAINER];
+      }
+      return x * 2;
     }
-    return x * 2;
-  }
-  else if (i <= MIXSRC_LAST_CH) {
-    return ex_chans[i - MIXSRC_CH1];
-  }
 
-  else if (i <= MIXSRC_LAST_GVAR) {
+    case SOURCE_KIND_CHANNEL:
+      return ex_chans[i - MIXSRC_CH1];
+
 #if defined(GVARS)
-    return GVAR_VALUE(i - MIXSRC_GVAR1, getGVarFlightMode(mixerCurrentFlightMode, i - MIXSRC_GVAR1));
-#else
-    return 0;
+    case SOURCE_KIND_GVAR:
+      return GVAR_VALUE(i - MIXSRC_GVAR1, getGVarFlightMode(mixerCurrentFlightMode, i - MIXSRC_GVAR1));
 #endif
-  }
 
-  else if (i == MIXSRC_TX_VOLTAGE) {
-    return g_vbat100mV;
-  }
-  else if (i < MIXSRC_FIRST_TIMER) {
-    // TX_TIME + SPARES
+    case SOURCE_KIND_TX_VOLTAGE:
+      return g_vbat100mV;
+
 #if defined(RTCLOCK)
-    return (g_rtcTime % SECS_PER_DAY) / 60; // number of minutes from midnight
-#else
-    return 0;
+    case SOURCE_KIND_TX_TIME:
+      // TX_TIME + SPARES
+      return (g_rtcTime % SECS_PER_DAY) / 60; // number of minutes from midnight
 #endif
-  }
-  else if (i <= MIXSRC_LAST_TIMER) {
-    return timersStates[i - MIXSRC_FIRST_TIMER].val;
-  }
 
-  else if (i <= MIXSRC_LAST_TELEM) {
-    if (IS_FAI_FORBIDDEN(i)) {
-      return 0;
-    }
-    i -= MIXSRC_FIRST_TELEM;
-    div_t qr = div(i, 3);
-    TelemetryItem & telemetryItem = telemetryItems[qr.quot];
-    switch (qr.rem) {
-      case 1:
-        return telemetryItem.valueMin;
-      case 2:
-        return telemetryItem.valueMax;
-      default:
-        return telemetryItem.value;
+    case SOURCE_KIND_TIMER:
+      return timersStates[i - MIXSRC_FIRST_TIMER].val;
+
+    case SOURCE_KIND_TELEMETRY:
+    {
+      if (IS_FAI_FORBIDDEN(i)) {
+        return 0;
+      }
+      div_t qr = div(i - MIXSRC_FIRST_TELEM, 3);
+      TelemetryItem & telemetryItem = telemetryItems[qr.quot];
+      switch (qr.rem) {
+        case 1:
+          return telemetryItem.valueMin;
+        case 2:
+          return telemetryItem.valueMax;
+        default:
+          return telemetryItem.value;
+      }
     }
+
+    default:
+      return 0;
   }
-  else return 0;
 }
 
 void evalInputs(uint8_t mode)
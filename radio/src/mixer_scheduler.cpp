@@ -21,37 +21,173 @@
 #include "opentx.h"
 #include "mixer_scheduler.h"
 
-#if !defined(SIMU)
+bool mixerSchedulerDecimate(int32_t & elapsed, uint16_t period, uint16_t mixerPeriod)
+{
+  elapsed += mixerPeriod;
+  if (elapsed + mixerPeriod / 2 < period) {
+    return false;
+  }
+
+  // elapsed is now the time since the ideal frame time, within +/- mixerPeriod / 2
+  elapsed -= period;
+  if (elapsed >= period) {
+    // the period changed
+    elapsed = 0;
+  }
+  return true;
+}
 
-// Global trigger flag
+#if !defined(SIMU)
 
 // Mixer schedule
 struct MixerSchedule {
 
   // period in us
   volatile uint16_t period;
+
+  // us of mixer runs since the last frame is due (synchronous modules),
+  // negative when the last frame was sent a bit early
+  int32_t elapsed;
+
+  MixerScheduleStats stats;
 };
 
 static MixerSchedule mixerSchedules[NUM_MODULES];
 
-uint16_t getMixerSchedulerPeriod()
+static volatile uint16_t mixerOutputsTime;      // getTmr2MHz() at the mixer end
+static volatile int16_t mixerPhaseCorrection;   // us added to the next period
+static uint16_t mixerHeadroom = MIXER_SCHEDULER_HEADROOM_US;
+static uint32_t mixerRuns;
+
+// the module with the shortest period, which sets the scheduling period, -1 if none
+static int8_t getMixerSchedulerReference()
 {
-#if defined(HARDWARE_INTERNAL_MODULE)
-  if (mixerSchedules[INTERNAL_MODULE].period) {
-    return mixerSchedules[INTERNAL_MODULE].period;
+#if defined(INTMODULE_HEARTBEAT_GPIO)
+  // the internal module heartbeat triggers the mixer, it stays the timing master
+  if (heartbeatCapture.valid && mixerSchedules[INTERNAL_MODULE].period) {
+    return INTERNAL_MODULE;
   }
 #endif
-#if defined(HARDWARE_EXTERNAL_MODULE)
-  if (mixerSchedules[EXTERNAL_MODULE].period) {
-    return mixerSchedules[EXTERNAL_MODULE].period;
+
+  int8_t result = -1;
+  for (uint8_t i = 0; i < NUM_MODULES; i++) {
+    uint16_t period = mixerSchedules[i].period;
+    if (period && (result < 0 || period < mixerSchedules[result].period)) {
+      result = i;
+    }
+  }
+  return result;
+}
+
+uint16_t getMixerSchedulerPeriod()
+{
+  int8_t moduleIdx = getMixerSchedulerReference();
+  if (moduleIdx >= 0) {
+    return mixerSchedules[moduleIdx].period;
   }
-#endif
   return MIXER_SCHEDULER_DEFAULT_PERIOD_US;
 }
 
+uint16_t mixerSchedulerNextPeriod()
+{
+  uint16_t period = getMixerSchedulerPeriod() + mixerPhaseCorrection;
+  mixerPhaseCorrection = 0;
+  return period;
+}
+
+uint8_t mixerSchedulerOutputsReady()
+{
+  mixerOutputsTime = getTmr2MHz();
+  ++mixerRuns;
+
+  uint16_t mixerPeriod = getMixerSchedulerPeriod();
+  uint8_t result = 0;
+
+  for (uint8_t i = 0; i < NUM_MODULES; i++) {
+    MixerSchedule & schedule = mixerSchedules[i];
+    uint16_t period = schedule.period;
+    if (period <= mixerPeriod) {
+      // no period, or the module which sets the mixer rate
+      schedule.elapsed = 0;
+      result |= 1 << i;
+      continue;
+    }
+
+    if (mixerSchedulerDecimate(schedule.elapsed, period, mixerPeriod)) {
+      result |= 1 << i;
+    }
+  }
+
+  return result;
+}
+
+void mixerSchedulerFrameBuild(uint8_t moduleIdx)
+{
+  MixerScheduleStats & stats = mixerSchedules[moduleIdx].stats;
+  uint16_t age = (uint16_t)(getTmr2MHz() - mixerOutputsTime) / 2;
+  stats.lastAge = age;
+  if (age > stats.maxAge) {
+    stats.maxAge = age;
+  }
+  ++stats.frames;
+}
+
+void mixerSchedulerISRFrameBuild(uint8_t moduleIdx)
+{
+  mixerSchedulerFrameBuild(moduleIdx);
+
+  // when both modules run at different rates, only the one which sets
+  // the period can be locked, the other one just gets the latest outputs
+  uint16_t slack = mixerSchedules[moduleIdx].stats.lastAge;
+  uint16_t period = mixerSchedules[moduleIdx].period;
+  if (getMixerSchedulerReference() != moduleIdx || period > MIXER_SCHEDULER_MAX_LOCK_PERIOD_US) {
+    return;
+  }
+
+  // the mixer did not run during the last period (pulses paused, ...)
+  if (slack >= period) {
+    return;
+  }
+
+  // proportional loop: both timers run at the same period, there is no
+  // frequency error to integrate. A positive error delays the next trigger.
+  int16_t error = slack - min<uint16_t>(mixerHeadroom, period / 2);
+  mixerPhaseCorrection = limit<int16_t>(-period / 8, error / 4, period / 8);
+}
+
+void mixerSchedulerSetHeadroom(uint16_t headroomUs)
+{
+  mixerHeadroom = headroomUs;
+}
+
+uint16_t getMixerSchedulerHeadroom()
+{
+  return mixerHeadroom;
+}
+
+const MixerScheduleStats & getMixerSchedulerStats(uint8_t moduleIdx)
+{
+  return mixerSchedules[moduleIdx].stats;
+}
+
+uint32_t getMixerSchedulerRuns()
+{
+  return mixerRuns;
+}
+
+void resetMixerSchedulerStats()
+{
+  for (auto & schedule: mixerSchedules) {
+    memclear(&schedule.stats, sizeof(schedule.stats));
+  }
+  mixerRuns = 0;
+}
+
 void mixerSchedulerInit()
 {
   memset(mixerSchedules, 0, sizeof(mixerSchedules));
+  mixerPhaseCorrection = 0;
+  mixerRuns = 0;
 }
 
 void mixerSchedulerSetPeriod(uint8_t moduleIdx, uint16_t periodUs)
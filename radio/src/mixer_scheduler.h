@@ -26,6 +26,22 @@
 #define MIN_REFRESH_RATE      1750 /* us */
 #define MAX_REFRESH_RATE     50000 /* us */
 
+// margin kept between the mixer end and the frame build of an asynchronous
+// module (PPM), for the mixer duration variations
+#if !defined(MIXER_SCHEDULER_HEADROOM_US)
+  #define MIXER_SCHEDULER_HEADROOM_US     500u
+#endif
+
+// the phase is measured with the 16 bits 2MHz timer
+#define MIXER_SCHEDULER_MAX_LOCK_PERIOD_US  30000u
+
+// Decimation of the mixer runs for a synchronous module slower than the
+// mixer: called after each mixer run, returns true when the module is due
+// for a frame. Each frame takes the mixer run closest to its ideal time,
+// so it is sent at most half a mixer period early or late, and the mean
+// rate is exactly the module one. elapsed is the module accumulator, in us.
+bool mixerSchedulerDecimate(int32_t & elapsed, uint16_t period, uint16_t mixerPeriod);
+
 #if !defined(SIMU)
 
 // Call once to initialize the mixer scheduler
@@ -55,12 +71,45 @@ void mixerSchedulerEnableTrigger();
 // Disable the timer trigger
 void mixerSchedulerDisableTrigger();
 
-// Fetch the current scheduling period
+// Fetch the current scheduling period: the shortest one of the modules
 uint16_t getMixerSchedulerPeriod();
 
 // Trigger mixer from an ISR
 void mixerSchedulerISRTrigger();
 
+// Fetch the period of the next trigger, including the phase correction
+uint16_t mixerSchedulerNextPeriod();
+
+// Record the end of the mixer calculations, and return the mask of the
+// synchronous modules due for a frame: the slower ones are only fed at
+// their own period (see mixerSchedulerDecimate), with the outputs of the
+// last mixer run
+uint8_t mixerSchedulerOutputsReady();
+
+// Called when a synchronous module builds its frame
+void mixerSchedulerFrameBuild(uint8_t moduleIdx);
+
+// Called from the ISR where an asynchronous module builds its frame from
+// the last mixer outputs: when this module sets the scheduling period, the
+// trigger is shifted to bring the mixer end just before the frame build
+void mixerSchedulerISRFrameBuild(uint8_t moduleIdx);
+
+// Set / fetch the margin kept before the asynchronous frames build
+void mixerSchedulerSetHeadroom(uint16_t headroomUs);
+uint16_t getMixerSchedulerHeadroom();
+
+struct MixerScheduleStats {
+  uint32_t frames;
+  uint16_t lastAge;     // us between the mixer end and the frame build
+  uint16_t maxAge;
+};
+
+// Fetch the staleness of the outputs sent to a module, since the last reset
+// (the reset is explicit, reading the stats does not clear them)
+const MixerScheduleStats & getMixerSchedulerStats(uint8_t moduleIdx);
+uint32_t getMixerSchedulerRuns();
+void resetMixerSchedulerStats();
+
 #else
 
 #define mixerSchedulerInit()
@@ -81,6 +130,12 @@ static inline bool mixerSchedulerWaitForTrigger(uint8_t timeout)
 
 #define getMixerSchedulerPeriod() (MIXER_SCHEDULER_DEFAULT_PERIOD_US)
 #define mixerSchedulerISRTrigger()
+#define mixerSchedulerNextPeriod() (MIXER_SCHEDULER_DEFAULT_PERIOD_US)
+#define mixerSchedulerOutputsReady() ((1 << INTERNAL_MODULE) | (1 << EXTERNAL_MODULE))
+#define mixerSchedulerFrameBuild(m)
+#define mixerSchedulerISRFrameBuild(m)
+#define mixerSchedulerSetHeadroom(h)
+#define getMixerSchedulerHeadroom() (MIXER_SCHEDULER_HEADROOM_US)
 
 #endif
 
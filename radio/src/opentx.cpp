@@ -1162,6 +1162,9 @@ void flightReset(uint8_t check)
   // we don't reset the whole audio here (the hello.wav would be cut, if a prompt is queued before FlightReset, it should be played)
   // TODO check if the vario / background music are stopped correctly if switching to a model which doesn't have these functions enabled
 
+  // the callouts of the previous flight (or model) are not played, even for the manual reset timers
+  timerEvents.clear();
+
   if (!IS_MANUAL_RESET_TIMER(0)) {
     timerReset(0);
   }
@@ -1240,6 +1243,7 @@ void doMixerCalculations()
   DEBUG_TIMER_START(debugTimerGetAdc);
   getADC();
   DEBUG_TIMER_STOP(debugTimerGetAdc);
+  LATENCY_STAMP(LATENCY_ADC);
 
   DEBUG_TIMER_START(debugTimerGetSwitches);
   getSwitchesPosition(!s_mixer_first_run_done);
@@ -1252,9 +1256,11 @@ void doMixerCalculations()
 #endif
 
 
+  LATENCY_STAMP(LATENCY_MIXER_START);
   DEBUG_TIMER_START(debugTimerEvalMixes);
   evalMixes(tick10ms);
   DEBUG_TIMER_STOP(debugTimerEvalMixes);
+  LATENCY_STAMP(LATENCY_MIXER_END);
 }
 
 void doMixerPeriodicUpdates()
@@ -1503,6 +1509,9 @@ void opentxResume()
   TRACE("opentxResume");
 
   sdMount();
+#if defined(LUA)
+  luaSdRemounted();
+#endif
 #if defined(COLORLCD)
   // reload widgets
   luaInitThemesAndWidgets();
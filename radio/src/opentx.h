@@ -249,6 +249,10 @@
   #include "disk_cache.h"
 #endif
 
+#if defined(USB_MSC_CACHE)
+  #include "usb_msc_cache.h"
+#endif
+
 #include "debug.h"
 
 #if defined(PCBFRSKY)
@@ -331,12 +335,21 @@ struct CustomFunctionsContext {
   MASK_FUNC_TYPE activeFunctions;
   MASK_CFN_TYPE  activeSwitches;
   tmr10ms_t lastFunctionTime[MAX_SPECIAL_FUNCTIONS];
+  // compacted list of the entries evalFunctions() has to look at, rebuilt after each edit
+  bool entriesValid;
+  uint8_t entriesCount;
+  uint8_t entries[MAX_SPECIAL_FUNCTIONS];
 
   inline bool isFunctionActive(uint8_t func)
   {
     return activeFunctions & ((MASK_FUNC_TYPE)1 << func);
   }
 
+  inline void invalidateEntries()
+  {
+    entriesValid = false;
+  }
+
   void reset()
   {
     memclear(this, sizeof(*this));
@@ -863,6 +876,13 @@ inline void customFunctionsReset()
   modelFunctionsContext.reset();
 }
 
+// the radio or model data was replaced without going through storageDirty()
+inline void customFunctionsInvalidate()
+{
+  globalFunctionsContext.invalidateEntries();
+  modelFunctionsContext.invalidateEntries();
+}
+
 #include "telemetry/telemetry.h"
 #include "crc.h"
 
@@ -562,7 +562,9 @@ bool setupPulsesInternalModule()
     return false;
   }
   else {
-    return setupPulsesInternalModule(protocol);
+    bool result = setupPulsesInternalModule(protocol);
+    LATENCY_STAMP(LATENCY_PULSES);
+    return result;
   }
 }
 #endif
@@ -590,7 +592,9 @@ bool setupPulsesExternalModule()
     return false;
   }
   else {
-    return setupPulsesExternalModule(protocol);
+    bool result = setupPulsesExternalModule(protocol);
+    LATENCY_STAMP(LATENCY_PULSES);
+    return result;
   }
 }
 #endif
@@ -47,7 +47,7 @@ class Pxx1CrcMixin {
 
     void addToCrc(uint8_t byte)
     {
-      crc = (crc << 8) ^ (crc16tab_1189[((crc >> 8) ^ byte) & 0xFF]);
+      crc = Crc16PXX::update(crc, byte);
     }
 
     uint16_t crc;
@@ -456,22 +456,26 @@ bool Pxx2Pulses::setupFrame(uint8_t module)
   return true;
 }
 
+// the step is changed by the telemetry frames, the file is read ahead while they are awaited
 bool Pxx2OtaUpdate::waitStep(uint8_t step, uint8_t timeout)
 {
   OtaUpdateInformation * destination = moduleState[module].otaUpdateInformation;
-  uint8_t elapsed = 0;
+  uint32_t start = RTOS_GET_MS();
 
   watchdogSuspend(100 /*1s*/);
 
-  while (step != destination->step) {
-    if (elapsed++ > timeout) {
+  while (true) {
+    telemetryWakeup();
+    if (step == destination->step) {
+      return true;
+    }
+    if (RTOS_GET_MS() - start > timeout) {
       return false;
     }
-    RTOS_WAIT_MS(1);
-    telemetryWakeup();
+    if (!fileBuffer || !fileBuffer->prefetch()) {
+      RTOS_WAIT_MS(1);
+    }
   }
-
-  return true;
 }
 
 const char * Pxx2OtaUpdate::nextStep(uint8_t step, const char * rxName, uint32_t address, const uint8_t * buffer)
@@ -500,7 +504,7 @@ const char * Pxx2OtaUpdate::nextStep(uint8_t step, const char * rxName, uint32_t
 const char * Pxx2OtaUpdate::doFlashFirmware(const char * filename, ProgressHandler progressHandler)
 {
   FIL file;
-  uint8_t buffer[32];
+  FrSkyFirmwareInformation information;
   UINT count;
   const char * result;
 
@@ -516,36 +520,41 @@ const char * Pxx2OtaUpdate::doFlashFirmware(const char * filename, ProgressHandl
   uint32_t size;
   const char * ext = getFileExtension(filename);
   if (ext && !strcasecmp(ext, FRSKY_FIRMWARE_EXT)) {
-    FrSkyFirmwareInformation * information = (FrSkyFirmwareInformation *) buffer;
-    if (f_read(&file, buffer, sizeof(FrSkyFirmwareInformation), &count) != FR_OK || count != sizeof(FrSkyFirmwareInformation)) {
+    if (f_read(&file, &information, sizeof(FrSkyFirmwareInformation), &count) != FR_OK || count != sizeof(FrSkyFirmwareInformation)) {
       f_close(&file);
       return "Format error";
     }
-    size = information->size;
+    size = information.size;
   }
   else {
     size = f_size(&file);
   }
 
+  FirmwareFileBuffer<256> buffer(&file, size);
+  fileBuffer = &buffer;
+
   uint32_t done = 0;
   while (1) {
     progressHandler(getBasename(filename), STR_OTA_UPDATE, done, size);
-    if (f_read(&file, buffer, sizeof(buffer), &count) != FR_OK) {
-      f_close(&file);
-      return "Read file failed";
-    }
-
-    result = nextStep(OTA_UPDATE_TRANSFER, nullptr, done, buffer);
-    if (result) {
-      return result;
+    const uint8_t * data = buffer.get(done, 32);
+    if (!data) {
+      result = "Read file failed";
+      break;
     }
 
-    if (count < sizeof(buffer)) {
-      f_close(&file);
+    result = nextStep(OTA_UPDATE_TRANSFER, nullptr, done, data);
+    if (result || done + 32 > size) {
       break;
     }
 
-    done += count;
+    done += 32;
+  }
+
+  fileBuffer = nullptr;
+  f_close(&file);
+
+  if (result) {
+    return result;
   }
 
   return nextStep(OTA_UPDATE_EOF, nullptr, done, nullptr);
@@ -450,6 +450,9 @@ class Pxx2Pulses: public Pxx2Transport {
     }
 };
 
+template <unsigned CHUNK_SIZE>
+class FirmwareFileBuffer;
+
 class Pxx2OtaUpdate {
   public:
     Pxx2OtaUpdate(uint8_t module, const char * rxName):
@@ -463,6 +466,7 @@ class Pxx2OtaUpdate {
   protected:
     uint8_t module;
     const char * rxName;
+    FirmwareFileBuffer<256> * fileBuffer = nullptr;
 
     const char * doFlashFirmware(const char * filename, ProgressHandler progressHandler);
     bool waitStep(uint8_t step, uint8_t timeout);
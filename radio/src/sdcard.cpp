@@ -482,6 +482,149 @@ const char * sdCopyFile(const char * srcFilename, const char * srcDir, const cha
 
   return sdCopyFile(srcPath, destPath);
 }
+
+// Appended to the temp file once its content is written: recoverTempFile()
+// only uses a temp file which carries it. It is removed from the final file
+// once renamed, or by recoverTempFile() if the power was lost before.
+struct TempFileTrailer {
+  uint32_t fourcc;
+  uint32_t size;    // size of the content before the trailer
+};
+
+#define TMP_FILE_FOURCC  0x444E4545 // "EEND"
+
+static void getTempFilePath(char * tmpPath, const char * path)
+{
+  strAppend(strAppend(tmpPath, path), TMP_FILE_EXT);
+}
+
+static bool readTempFileTrailer(FIL * file, TempFileTrailer * trailer)
+{
+  UINT read;
+  uint32_t size = f_size(file);
+  return size >= sizeof(TempFileTrailer) &&
+         f_lseek(file, size - sizeof(TempFileTrailer)) == FR_OK &&
+         f_read(file, trailer, sizeof(TempFileTrailer), &read) == FR_OK && read == sizeof(TempFileTrailer) &&
+         trailer->fourcc == TMP_FILE_FOURCC && trailer->size == size - sizeof(TempFileTrailer);
+}
+
+static FRESULT truncateFile(const char * path, uint32_t size)
+{
+  FIL file;
+  FRESULT result = f_open(&file, path, FA_OPEN_EXISTING | FA_WRITE);
+  if (result != FR_OK) {
+    return result;
+  }
+
+  result = f_lseek(&file, size);
+  if (result == FR_OK) {
+    result = f_truncate(&file);
+  }
+  FRESULT closeResult = f_close(&file);
+  return result != FR_OK ? result : closeResult;
+}
+
+const char * openTempFile(const char * fullpath, FIL * file)
+{
+  char tmpPath[256];
+  getTempFilePath(tmpPath, fullpath);
+
+  FRESULT result = f_open(file, tmpPath, FA_CREATE_ALWAYS | FA_WRITE);
+  if (result != FR_OK) {
+    return SDCARD_ERROR(result);
+  }
+
+  return nullptr;
+}
+
+void discardTempFile(const char * fullpath, FIL * file)
+{
+  char tmpPath[256];
+  getTempFilePath(tmpPath, fullpath);
+
+  f_close(file);
+  f_unlink(tmpPath);
+}
+
+const char * commitTempFile(const char * fullpath, FIL * file)
+{
+  char tmpPath[256];
+  getTempFilePath(tmpPath, fullpath);
+
+  TempFileTrailer trailer = { TMP_FILE_FOURCC, (uint32_t)f_size(file) };
+  UINT written;
+  FRESULT result = f_write(file, &trailer, sizeof(trailer), &written);
+  if (result == FR_OK && written != sizeof(trailer)) {
+    result = FR_DENIED;
+  }
+  if (result != FR_OK) {
+    discardTempFile(fullpath, file);
+    return SDCARD_ERROR(result);
+  }
+
+  result = f_close(file);
+  if (result != FR_OK) {
+    f_unlink(tmpPath);
+    return SDCARD_ERROR(result);
+  }
+
+  // FatFs can't rename over an existing file: if the power is lost
+  // between these 2 calls, recoverTempFile() will finish the job
+  result = f_unlink(fullpath);
+  if (result != FR_OK && result != FR_NO_FILE) {
+    return SDCARD_ERROR(result);
+  }
+
+  result = f_rename(tmpPath, fullpath);
+  if (result != FR_OK) {
+    return SDCARD_ERROR(result);
+  }
+
+  // the trailer was only needed while the file had its temp name
+  result = truncateFile(fullpath, trailer.size);
+  if (result != FR_OK) {
+    return SDCARD_ERROR(result);
+  }
+
+  return nullptr;
+}
+
+void recoverTempFile(const char * fullpath)
+{
+  char tmpPath[256];
+  getTempFilePath(tmpPath, fullpath);
+
+  FIL file;
+  TempFileTrailer trailer;
+
+  if (f_open(&file, tmpPath, FA_OPEN_EXISTING | FA_READ) == FR_OK) {
+    bool complete = readTempFileTrailer(&file, &trailer);
+    f_close(&file);
+
+    if (complete) {
+      // the temp file was closed, the old file removal or the rename is missing
+      TRACE("recoverTempFile(%s): restore temp file", fullpath);
+      f_unlink(fullpath);
+      f_rename(tmpPath, fullpath);
+    }
+    else {
+      // the power was lost while writing the temp file, the old file is kept
+      TRACE("recoverTempFile(%s): discard temp file", fullpath);
+      f_unlink(tmpPath);
+    }
+  }
+
+  if (f_open(&file, fullpath, FA_OPEN_EXISTING | FA_READ) == FR_OK) {
+    bool trailing = readTempFileTrailer(&file, &trailer);
+    f_close(&file);
+
+    if (trailing) {
+      // the power was lost after the rename, the trailer is still there
+      TRACE("recoverTempFile(%s): remove trailer", fullpath);
+      truncateFile(fullpath, trailer.size);
+    }
+  }
+}
 #endif // defined(SDCARD)
 
 
@@ -173,6 +173,15 @@ unsigned int findNextFileIndex(char * filename, uint8_t size, const char * direc
 const char * sdCopyFile(const char * src, const char * dest);
 const char * sdCopyFile(const char * srcFilename, const char * srcDir, const char * destFilename, const char * destDir);
 
+#define TMP_FILE_EXT        ".tmp"
+
+// crash-safe file replacement: the new content is written to "<path>.tmp", which then replaces "<path>"
+const char * openTempFile(const char * fullpath, FIL * file);
+const char * commitTempFile(const char * fullpath, FIL * file);
+void discardTempFile(const char * fullpath, FIL * file);
+// to be called before reading a file which may have been replaced while the power was lost
+void recoverTempFile(const char * fullpath);
+
 #define LIST_NONE_SD_FILE   1
 #define LIST_SD_FILE_EXT    2
 bool sdListFiles(const char * path, const char * extension, const uint8_t maxlen, const char * selection, uint8_t flags=0);
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _SOURCES_H_
+#define _SOURCES_H_
+
+#include "opentx.h"
+#include "dispatch.h"
+
+// Accessors used by getValue(), sources of disabled features are mapped to SOURCE_KIND_ZERO
+enum SourceKind {
+  SOURCE_KIND_ZERO,
+  SOURCE_KIND_INPUT,
+  SOURCE_KIND_LUA,
+  SOURCE_KIND_ANALOG,
+  SOURCE_KIND_GYRO_X,
+  SOURCE_KIND_GYRO_Y,
+  SOURCE_KIND_MAX,
+  SOURCE_KIND_HELI,
+  SOURCE_KIND_TRIM,
+  SOURCE_KIND_SWITCH,
+  SOURCE_KIND_3POS,
+  SOURCE_KIND_LOGICAL_SWITCH,
+  SOURCE_KIND_TRAINER,
+  SOURCE_KIND_CHANNEL,
+  SOURCE_KIND_GVAR,
+  SOURCE_KIND_TX_VOLTAGE,
+  SOURCE_KIND_TX_TIME,
+  SOURCE_KIND_TIMER,
+  SOURCE_KIND_TELEMETRY,
+};
+
+struct SourceKinds {
+  static constexpr unsigned COUNT = MIXSRC_LAST_TELEM + 1;
+  static constexpr uint8_t OUT_OF_RANGE = SOURCE_KIND_ZERO;
+
+  static constexpr uint8_t kind(unsigned i)
+  {
+    return i == MIXSRC_NONE ? SOURCE_KIND_ZERO :
+           i <= MIXSRC_LAST_INPUT ? SOURCE_KIND_INPUT :
+#if defined(LUA_INPUTS)
+#if defined(LUA_MODEL_SCRIPTS)
+           i <= MIXSRC_LAST_LUA ? SOURCE_KIND_LUA :
+#else
+           i <= MIXSRC_LAST_LUA ? SOURCE_KIND_ZERO :
+#endif
+#endif
+           i <= MIXSRC_LAST_POT + NUM_MOUSE_ANALOGS ? SOURCE_KIND_ANALOG :
+#if defined(GYRO)
+           i == MIXSRC_GYRO1 ? SOURCE_KIND_GYRO_X :
+           i == MIXSRC_GYRO2 ? SOURCE_KIND_GYRO_Y :
+#endif
+           i < MIXSRC_MAX ? SOURCE_KIND_ZERO :
+           i == MIXSRC_MAX ? SOURCE_KIND_MAX :
+#if defined(HELI)
+           i <= MIXSRC_LAST_HELI ? SOURCE_KIND_HELI :
+#else
+           i <= MIXSRC_LAST_HELI ? SOURCE_KIND_ZERO :
+#endif
+           i <= MIXSRC_LAST_TRIM ? SOURCE_KIND_TRIM :
+#if defined(PCBFRSKY) || defined(PCBFLYSKY)
+           i <= MIXSRC_LAST_SWITCH ? SOURCE_KIND_SWITCH :
+#else
+           i == MIXSRC_3POS ? SOURCE_KIND_3POS :
+           i < MIXSRC_SW1 ? SOURCE_KIND_SWITCH :
+#endif
+           i <= MIXSRC_LAST_LOGICAL_SWITCH ? SOURCE_KIND_LOGICAL_SWITCH :
+           i <= MIXSRC_LAST_TRAINER ? SOURCE_KIND_TRAINER :
+           i <= MIXSRC_LAST_CH ? SOURCE_KIND_CHANNEL :
+#if defined(GVARS)
+           i <= MIXSRC_LAST_GVAR ? SOURCE_KIND_GVAR :
+#else
+           i <= MIXSRC_LAST_GVAR ? SOURCE_KIND_ZERO :
+#endif
+           i == MIXSRC_TX_VOLTAGE ? SOURCE_KIND_TX_VOLTAGE :
+#if defined(RTCLOCK)
+           i < MIXSRC_FIRST_TIMER ? SOURCE_KIND_TX_TIME :
+#else
+           i < MIXSRC_FIRST_TIMER ? SOURCE_KIND_ZERO :
+#endif
+           i <= MIXSRC_LAST_TIMER ? SOURCE_KIND_TIMER :
+           SOURCE_KIND_TELEMETRY;
+  }
+};
+
+typedef DispatchTable<SourceKinds> SourceDispatch;
+
+// Accessors used by getSwitch(), on the switch index without its sign
+enum SwitchKind {
+  SWITCH_KIND_FALSE,
+  SWITCH_KIND_ONE,
+  SWITCH_KIND_ON,
+  SWITCH_KIND_LATENCY_TOGGLE,
+  SWITCH_KIND_SWITCH,
+  SWITCH_KIND_MULTIPOS,
+  SWITCH_KIND_TRIM,
+  SWITCH_KIND_LOGICAL_SWITCH,
+  SWITCH_KIND_FLIGHT_MODE,
+  SWITCH_KIND_TELEMETRY_STREAMING,
+  SWITCH_KIND_SENSOR,
+  SWITCH_KIND_RADIO_ACTIVITY,
+};
+
+struct SwitchKinds {
+  static constexpr unsigned COUNT = SWSRC_COUNT;
+  static constexpr uint8_t OUT_OF_RANGE = SWITCH_KIND_FALSE;
+
+  static constexpr uint8_t kind(unsigned i)
+  {
+    return i == SWSRC_NONE ? SWITCH_KIND_FALSE :
+           i == SWSRC_ONE ? SWITCH_KIND_ONE :
+           i == SWSRC_ON ? SWITCH_KIND_ON :
+#if defined(DEBUG_LATENCY)
+           i == SWSRC_LATENCY_TOGGLE ? SWITCH_KIND_LATENCY_TOGGLE :
+#endif
+           i <= SWSRC_LAST_SWITCH ? SWITCH_KIND_SWITCH :
+#if NUM_XPOTS > 0
+           i <= SWSRC_LAST_MULTIPOS_SWITCH ? SWITCH_KIND_MULTIPOS :
+#endif
+           i <= SWSRC_LAST_TRIM ? SWITCH_KIND_TRIM :
+           i == SWSRC_RADIO_ACTIVITY ? SWITCH_KIND_RADIO_ACTIVITY :
+           i >= SWSRC_FIRST_SENSOR ? SWITCH_KIND_SENSOR :
+           i == SWSRC_TELEMETRY_STREAMING ? SWITCH_KIND_TELEMETRY_STREAMING :
+#if defined(FLIGHT_MODES)
+           i >= SWSRC_FIRST_FLIGHT_MODE ? SWITCH_KIND_FLIGHT_MODE :
+#else
+           i >= SWSRC_FIRST_FLIGHT_MODE ? SWITCH_KIND_FALSE :
+#endif
+           SWITCH_KIND_LOGICAL_SWITCH;
+  }
+};
+
+typedef DispatchTable<SwitchKinds> SwitchDispatch;
+
+#endif // _SOURCES_H_
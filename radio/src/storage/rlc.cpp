@@ -19,113 +19,357 @@
  */
 
 #include <inttypes.h>
-#include <assert.h>
+#include <string.h>
 #include "debug.h"
 
 #include "rlc.h"
 
-#define CHECK_DST_SIZE() \
-  if (cur-dst >= (int)dstsize) { \
-    TRACE("RLC encoding size too big"); \
-    return 0; \
+/*
+  LZ77 compression, with a LZ4-like sequence format:
+    token: literals count (4 bits) | match length - LZ_MIN_MATCH (4 bits)
+    [extra literals count bytes, when the 4 bits are 15]
+    literals
+    match offset (1 byte below 128, else 2 bytes big endian with the high bit set)
+    [extra match length bytes, when the 4 bits are 15]
+  The extra bytes are added while they equal 255. The last sequence only has literals.
+  A match with a 0 offset is a run of zeroes, which are the bulk of the model data.
+*/
+
+#define LZ_MIN_MATCH   4
+#define LZ_HASH_BITS   9
+#define LZ_MAX_OFFSET  0x7FFF
+
+static inline uint32_t lzHash(const uint8_t * p)
+{
+  uint32_t value = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+  return (value * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static uint8_t * lzWriteLength(uint8_t * cur, const uint8_t * end, unsigned int len)
+{
+  if (len >= 15) {
+    len -= 15;
+    while (true) {
+      if (cur >= end)
+        return nullptr;
+      uint8_t byte = len < 255 ? len : 255;
+      *cur++ = byte;
+      len -= byte;
+      if (byte < 255)
+        break;
+    }
   }
+  return cur;
+}
+
+static uint8_t * lzWriteSequence(uint8_t * cur, const uint8_t * end, const uint8_t * literals, unsigned int count, unsigned int offset, unsigned int length)
+{
+  if (cur >= end)
+    return nullptr;
+
+  unsigned int code = length ? length - LZ_MIN_MATCH : 0;
+  *cur++ = ((count < 15 ? count : 15) << 4) | (code < 15 ? code : 15);
+
+  cur = lzWriteLength(cur, end, count);
+  if (!cur || cur + count > end)
+    return nullptr;
+  memcpy(cur, literals, count);
+  cur += count;
+
+  if (length) {
+    if (cur + (offset < 0x80 ? 1 : 2) > end)
+      return nullptr;
+    if (offset < 0x80) {
+      *cur++ = offset;
+    }
+    else {
+      *cur++ = 0x80 | (offset >> 8);
+      *cur++ = offset;
+    }
+    cur = lzWriteLength(cur, end, code);
+  }
+
+  return cur;
+}
 
 unsigned int compress(uint8_t * dst, unsigned int dstsize, const uint8_t * src, unsigned int srcsize)
 {
   uint8_t * cur = dst;
-  bool    run0   = (src[0] == 0);
-  uint8_t cnt    = 1;
-  uint8_t cnt0   = 0;
-
-  for (unsigned int i=1; 1; i++) {
-    bool cur0 = (i < srcsize) ? (src[i] == 0) : false;
-    if (i==srcsize || cur0!=run0 || cnt==0x3f || (cnt0 && cnt==0xf)) {
-      if (run0) {
-        assert(cnt0==0);
-        if (cnt<8 && i!=srcsize) {
-          cnt0 = cnt;
-        }
-        else {
-          CHECK_DST_SIZE();
-          *cur++ = (cnt | 0x40);
-        }
+  const uint8_t * end = dst + dstsize;
+  unsigned int anchor = 0;  // first pending literal
+  unsigned int i = 0;
+
+  if (srcsize > LZ_MAX_OFFSET) {
+    TRACE("LZ encoding size too big");
+    return 0;
+  }
+
+  uint16_t lzHashTable[1 << LZ_HASH_BITS];  // last position + 1 of each 4 bytes hash
+  memset(lzHashTable, 0, sizeof(lzHashTable));
+
+  while (i + LZ_MIN_MATCH <= srcsize) {
+    unsigned int len = 0;
+    unsigned int offset = 0;
+    if (!(src[i] | src[i + 1] | src[i + 2] | src[i + 3])) {
+      len = LZ_MIN_MATCH;
+      while (i + len < srcsize && src[i + len] == 0) {
+        len++;
       }
-      else {
-        if (cnt0) {
-          CHECK_DST_SIZE();
-          *cur++ = (0x80 | (cnt0<<4) | cnt);
-          cnt0 = 0;
-        }
-        else {
-          CHECK_DST_SIZE();
-          *cur++ = cnt;
-        }
-        for (int j=0; j<cnt; j++) {
-          CHECK_DST_SIZE();
-          *cur++ = src[i - cnt + j];
+    }
+    else {
+      uint32_t hash = lzHash(&src[i]);
+      unsigned int ref = lzHashTable[hash];
+      lzHashTable[hash] = i + 1;
+      if (ref && !memcmp(&src[--ref], &src[i], LZ_MIN_MATCH)) {
+        len = LZ_MIN_MATCH;
+        while (i + len < srcsize && src[ref + len] == src[i + len]) {
+          len++;
         }
+        offset = i - ref;
+      }
+    }
+    if (len) {
+      cur = lzWriteSequence(cur, end, &src[anchor], i - anchor, offset, len);
+      if (!cur) {
+        TRACE("LZ encoding size too big");
+        return 0;
+      }
+      for (unsigned int j = i + 1; j < i + len && j + LZ_MIN_MATCH <= srcsize; j++) {
+        lzHashTable[lzHash(&src[j])] = j + 1;
       }
-      cnt = 0;
-      if (i==srcsize) break;
-      run0 = cur0;
+      i += len;
+      anchor = i;
     }
-    cnt++;
+    else {
+      i++;
+    }
+  }
+
+  cur = lzWriteSequence(cur, end, &src[anchor], srcsize - anchor, 0, 0);
+  if (!cur) {
+    TRACE("LZ encoding size too big");
+    return 0;
   }
 
-  return cur-dst;
+  return cur - dst;
 }
 
-#undef CHECK_DST_SIZE
-#define CHECK_DST_SIZE() \
-  if (cur-dst >= (int)dstsize) { \
-    TRACE("RLC decoding size too big"); \
-    return 0; \
+static bool lzReadLength(const uint8_t * & src, const uint8_t * end, unsigned int & len)
+{
+  if (len == 15) {
+    uint8_t byte;
+    do {
+      if (src >= end)
+        return false;
+      byte = *src++;
+      len += byte;
+    } while (byte == 255);
   }
+  return true;
+}
 
-unsigned int uncompress(uint8_t * dst, unsigned int dstsize, const uint8_t * src, unsigned int srcsize)
+// Decodes the sequences of src into out, which provides literals(), zeroes(), match() and size()
+template <class Output>
+static bool lzDecode(Output & out, const uint8_t * src, unsigned int srcsize)
 {
-  uint8_t * cur = dst;
-  uint8_t zeroes = 0;
-  uint8_t bRlc = 0;
-
-  for( ; 1; ) {
-    if (zeroes > 0) {
-      for (int i = 0; i < zeroes; i++) {
-        CHECK_DST_SIZE();
-        *cur++ = 0;
+  const uint8_t * end = src + srcsize;
+
+  while (src < end) {
+    uint8_t token = *src++;
+
+    unsigned int count = token >> 4;
+    if (!lzReadLength(src, end, count) || count > (unsigned int)(end - src) || !out.literals(src, count)) {
+      TRACE("LZ decoding error");
+      return false;
+    }
+    src += count;
+
+    // the last sequence has no match
+    if (src == end)
+      break;
+
+    unsigned int offset = *src++;
+    if (offset & 0x80) {
+      if (src == end) {
+        TRACE("LZ decoding error");
+        return false;
       }
-      zeroes = 0;
+      offset = ((offset & 0x7F) << 8) | *src++;
+    }
+    unsigned int length = token & 0x0F;
+    if (!lzReadLength(src, end, length)) {
+      TRACE("LZ decoding error");
+      return false;
     }
+    length += LZ_MIN_MATCH;
+    if (offset > out.size() || !(offset == 0 ? out.zeroes(length) : out.match(offset, length))) {
+      TRACE("LZ decoding error");
+      return false;
+    }
+  }
 
-    if (srcsize == 0) {
-      return cur - dst;
+  return true;
+}
+
+class LzBufferOutput
+{
+  public:
+    LzBufferOutput(uint8_t * dst, unsigned int dstsize):
+      dst(dst),
+      dstsize(dstsize),
+      pos(0)
+    {
     }
 
-    for (int i=0; i<bRlc; i++) {
-      CHECK_DST_SIZE();
-      *cur++ = *src++;
-      if (--srcsize == 0) {
-        return cur - dst;
+    unsigned int size() const
+    {
+      return pos;
+    }
+
+    bool literals(const uint8_t * src, unsigned int count)
+    {
+      if (count > dstsize - pos)
+        return false;
+      memcpy(&dst[pos], src, count);
+      pos += count;
+      return true;
+    }
+
+    bool zeroes(unsigned int length)
+    {
+      if (length > dstsize - pos)
+        return false;
+      memset(&dst[pos], 0, length);
+      pos += length;
+      return true;
+    }
+
+    bool match(unsigned int offset, unsigned int length)
+    {
+      if (length > dstsize - pos)
+        return false;
+      // byte per byte, the match may overlap the output
+      while (length--) {
+        dst[pos] = dst[pos - offset];
+        pos++;
       }
+      return true;
     }
 
-    bRlc = *src++;
-    --srcsize;
+  protected:
+    uint8_t * dst;
+    unsigned int dstsize;
+    unsigned int pos;
+};
+
+unsigned int uncompress(uint8_t * dst, unsigned int dstsize, const uint8_t * src, unsigned int srcsize)
+{
+  LzBufferOutput out(dst, dstsize);
+  if (!lzDecode(out, src, srcsize))
+    return 0;
+  return out.size();
+}
 
-    if (!(bRlc & 0x7f)) {
-      TRACE("RLC decoding error");
-      return 0;
+/*
+  Compares the decoded bytes with data, without a buffer for them: the matches read their
+  source from data, or from diffs where data differs. Only the differences are stored.
+*/
+class LzDiffOutput
+{
+  public:
+    LzDiffOutput(const uint8_t * data, unsigned int datasize, LzDiff * diffs, unsigned int maxDiffs):
+      data(data),
+      datasize(datasize),
+      diffs(diffs),
+      maxDiffs(maxDiffs),
+      count(0),
+      pos(0)
+    {
     }
 
-    if (bRlc & 0x80) { // if contains high byte
-      zeroes  = (bRlc>>4) & 0x07;
-      bRlc    = bRlc & 0x0f;
+    unsigned int size() const
+    {
+      return pos;
     }
-    else if (bRlc & 0x40) {
-      zeroes = bRlc & 0x3f;
-      bRlc   = 0;
+
+    unsigned int diffsCount() const
+    {
+      return count;
+    }
+
+    bool literals(const uint8_t * src, unsigned int length)
+    {
+      if (length > datasize - pos)
+        return false;
+      while (length--) {
+        if (!put(*src++))
+          return false;
+      }
+      return true;
+    }
+
+    bool zeroes(unsigned int length)
+    {
+      if (length > datasize - pos)
+        return false;
+      while (length--) {
+        if (!put(0))
+          return false;
+      }
+      return true;
+    }
+
+    bool match(unsigned int offset, unsigned int length)
+    {
+      if (length > datasize - pos)
+        return false;
+      while (length--) {
+        if (!put(get(pos - offset)))
+          return false;
+      }
+      return true;
+    }
+
+  protected:
+    const uint8_t * data;
+    unsigned int datasize;
+    LzDiff * diffs;
+    unsigned int maxDiffs;
+    unsigned int count;
+    unsigned int pos;
+
+    // decoded byte at an earlier position
+    uint8_t get(unsigned int index) const
+    {
+      unsigned int lo = 0, hi = count;
+      while (lo < hi) {
+        unsigned int mid = (lo + hi) / 2;
+        if (diffs[mid].pos < index)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      return (lo < count && diffs[lo].pos == index) ? diffs[lo].value : data[index];
     }
-  }
-}
 
-#undef CHECK_DST_SIZE
+    bool put(uint8_t value)
+    {
+      if (value != data[pos]) {
+        if (count == maxDiffs)
+          return false;
+        diffs[count].pos = pos;
+        diffs[count].value = value;
+        count++;
+      }
+      pos++;
+      return true;
+    }
+};
+
+int uncompressDiff(const uint8_t * data, unsigned int datasize, const uint8_t * src, unsigned int srcsize, LzDiff * diffs, unsigned int maxDiffs)
+{
+  LzDiffOutput out(data, datasize, diffs, maxDiffs);
+  if (!lzDecode(out, src, srcsize) || out.size() != datasize)
+    return -1;
+  return out.diffsCount();
+}
@@ -24,4 +24,12 @@
 unsigned int compress(uint8_t * dst, unsigned int dstsize, const uint8_t * src, unsigned int len);
 unsigned int uncompress(uint8_t * dst, unsigned int dstsize, const uint8_t * src, unsigned int len);
 
+struct LzDiff {
+  uint16_t pos;
+  uint8_t value;  // decoded value, data[pos] differs
+};
+
+// returns the count of bytes differing between the decoded src and data, or -1 on error or above maxDiffs
+int uncompressDiff(const uint8_t * data, unsigned int datasize, const uint8_t * src, unsigned int srcsize, LzDiff * diffs, unsigned int maxDiffs);
+
 #endif
@@ -20,6 +20,7 @@
 
 #include "opentx.h"
 #include "rtc_backup.h"
+#include "rlc.h"
 
 namespace Backup {
 #define BACKUP
@@ -42,22 +43,101 @@ RamBackup * ramBackup = &_ramBackup;
 RamBackup * ramBackup = (RamBackup *)BKPSRAM_BASE;
 #endif
 
+/*
+  The backup RAM holds a compressed snapshot, followed by the changes made since then.
+  Most writes (trims, timers...) only change a few bytes, so only these are written as
+  delta records: offset (2 bytes), length (1 byte), data. A new snapshot is written
+  when the delta gets too big.
+*/
+#define RAMBACKUP_DELTA_GAP    4    // unchanged bytes kept inside a record rather than starting a new one
+#define RAMBACKUP_DELTA_MAX    256
+
+static_assert(sizeof(Backup::RamBackupUncompressed) <= 0xFFFF, "Delta records offsets are 16 bits");
+
+/*
+  The snapshot is decoded from the backup RAM and compared with the current data, a byte which
+  changed costs at least one byte of delta, so the differences are bounded by RAMBACKUP_DELTA_MAX.
+  Returns the delta size, or -1 if it doesn't fit.
+*/
+static int rambackupDelta(uint8_t * dst, unsigned int dstsize, const uint8_t * data, unsigned int size)
+{
+  LzDiff diffs[RAMBACKUP_DELTA_MAX];
+  int count = uncompressDiff(data, size, ramBackup->data, ramBackup->size, diffs, min<unsigned int>(dstsize, RAMBACKUP_DELTA_MAX));
+  if (count < 0)
+    return -1;
+
+  unsigned int result = 0;
+  int i = 0;
+
+  while (i < count) {
+    unsigned int start = diffs[i].pos, last = start;
+    while (++i < count && diffs[i].pos - last <= RAMBACKUP_DELTA_GAP + 1 && diffs[i].pos - start < 255) {
+      last = diffs[i].pos;
+    }
+    unsigned int len = last - start + 1;
+    if (result + 3 + len > dstsize)
+      return -1;
+    dst[result++] = start;
+    dst[result++] = start >> 8;
+    dst[result++] = len;
+    memcpy(&dst[result], &data[start], len);
+    result += len;
+  }
+
+  return result;
+}
+
+static bool rambackupApplyDelta(uint8_t * data, unsigned int size, const uint8_t * delta, unsigned int deltaSize)
+{
+  while (deltaSize > 0) {
+    if (deltaSize < 3)
+      return false;
+    unsigned int offset = delta[0] + (delta[1] << 8);
+    unsigned int len = delta[2];
+    if (deltaSize < 3 + len || offset + len > size)
+      return false;
+    memcpy(&data[offset], &delta[3], len);
+    delta += 3 + len;
+    deltaSize -= 3 + len;
+  }
+  return true;
+}
+
 void rambackupWrite()
 {
   copyRadioData(&ramBackupUncompressed.radio, &g_eeGeneral);
   copyModelData(&ramBackupUncompressed.model, &g_model);
-  ramBackup->size = compress(ramBackup->data, sizeof(ramBackup->data), (const uint8_t *)&ramBackupUncompressed, sizeof(ramBackupUncompressed));
-  TRACE("RamBackupWrite sdsize=%d backupsize=%d rlcsize=%d", sizeof(ModelData)+sizeof(RadioData), sizeof(Backup::RamBackupUncompressed), ramBackup->size);
+
+  if (ramBackup->size && ramBackup->size <= sizeof(ramBackup->data)) {
+    // an interrupted write will restore the snapshot alone
+    ramBackup->deltaSize = 0;
+    int size = rambackupDelta(&ramBackup->data[ramBackup->size], min<unsigned int>(sizeof(ramBackup->data) - ramBackup->size, RAMBACKUP_DELTA_MAX),
+                              (const uint8_t *)&ramBackupUncompressed, sizeof(ramBackupUncompressed));
+    if (size >= 0) {
+      ramBackup->deltaSize = size;
+      TRACE("RamBackupWrite deltasize=%d", size);
+      return;
+    }
+  }
+
+  ramBackup->deltaSize = 0;
+  ramBackup->size = 0;
+  unsigned int size = compress(ramBackup->data, sizeof(ramBackup->data), (const uint8_t *)&ramBackupUncompressed, sizeof(ramBackupUncompressed));
+  ramBackup->size = size;
+  TRACE("RamBackupWrite sdsize=%d backupsize=%d compressedsize=%d", sizeof(ModelData)+sizeof(RadioData), sizeof(Backup::RamBackupUncompressed), ramBackup->size);
 }
 
 bool rambackupRestore()
 {
-  if (ramBackup->size == 0)
+  if (ramBackup->size == 0 || ramBackup->size + ramBackup->deltaSize > sizeof(ramBackup->data))
     return false;
 
   if (uncompress((uint8_t *)&ramBackupUncompressed, sizeof(ramBackupUncompressed), ramBackup->data, ramBackup->size) != sizeof(ramBackupUncompressed))
     return false;
 
+  if (!rambackupApplyDelta((uint8_t *)&ramBackupUncompressed, sizeof(ramBackupUncompressed), &ramBackup->data[ramBackup->size], ramBackup->deltaSize))
+    return false;
+
   memset(&g_eeGeneral, 0, sizeof(g_eeGeneral));
   memset(&g_model, 0, sizeof(g_model));
   copyRadioData(&g_eeGeneral, &ramBackupUncompressed.radio);
@@ -24,8 +24,9 @@
 #include "definitions.h"
 
 PACK(struct RamBackup {
-  uint16_t size;
-  uint8_t data[4094];
+  uint16_t size;       // compressed snapshot
+  uint16_t deltaSize;  // changes since the snapshot, stored after it
+  uint8_t data[4092];
 });
 
 extern RamBackup * ramBackup;
@@ -30,9 +30,9 @@ const char * writeFile(const char * filename, const uint8_t * data, uint16_t siz
   unsigned char buf[8];
   UINT written;
 
-  FRESULT result = f_open(&file, filename, FA_CREATE_ALWAYS | FA_WRITE);
-  if (result != FR_OK) {
-    return SDCARD_ERROR(result);
+  const char * error = openTempFile(filename, &file);
+  if (error) {
+    return error;
   }
 
   *(uint32_t*)&buf[0] = OTX_FOURCC;
@@ -40,29 +40,19 @@ const char * writeFile(const char * filename, const uint8_t * data, uint16_t siz
   buf[5] = 'M';
   *(uint16_t*)&buf[6] = size;
 
-  result = f_write(&file, buf, 8, &written);
+  FRESULT result = f_write(&file, buf, 8, &written);
   if (result != FR_OK || written != 8) {
-    f_close(&file);
+    discardTempFile(filename, &file);
     return SDCARD_ERROR(result);
   }
 
   result = f_write(&file, data, size, &written);
   if (result != FR_OK || written != size) {
-    f_close(&file);
+    discardTempFile(filename, &file);
     return SDCARD_ERROR(result);
   }
 
-  f_close(&file);
-  return NULL;
-}
-
-const char * writeModel()
-{
-  char path[256];
-  getModelPath(path, g_eeGeneral.currModelFilename);
-
-  sdCheckAndCreateDirectory(MODELS_PATH);
-  return writeFile(path, (uint8_t *)&g_model, sizeof(g_model));
+  return commitTempFile(filename, &file);
 }
 
 const char * openFile(const char * fullpath, FIL * file, uint16_t * size, uint8_t * version)
@@ -98,7 +88,195 @@ const char * openFile(const char * fullpath, FIL * file, uint16_t * size, uint8_
   return nullptr;
 }
 
-const char * loadFile(const char * fullpath, uint8_t * data, uint16_t maxsize, uint8_t * version)
+/*
+  A model file holds the model content, followed by a journal of the changes made since the content
+  was written. Small edits (trims, timers, GVars...) only append the changed sections as records,
+  the file is rewritten through a temp file once the journal gets too big.
+  Record: offset (2 bytes), length (2 bytes), CRC32 of offset, length and data (4 bytes), data.
+  A record partly written when the power was lost fails its CRC, it ends the journal.
+*/
+PACK(struct FileJournalRecord {
+  uint16_t offset;
+  uint16_t length;
+  uint32_t crc;
+});
+
+#define MODEL_SECTION_SIZE     64
+#define MODEL_SECTIONS         ((sizeof(ModelData) + MODEL_SECTION_SIZE - 1) / MODEL_SECTION_SIZE)
+#define MODEL_JOURNAL_MAX      2048  // journal size after which the model file is rewritten
+
+static_assert(sizeof(ModelData) <= 0xFFFF, "Journal records offsets are 16 bits");
+
+// The current model as it is in its file: a section with a different CRC is dirty
+static struct {
+  char filename[LEN_MODEL_FILENAME + 1];  // empty when unknown
+  uint32_t fileSize;                      // where the next journal record goes
+  uint32_t listedCrc;                     // header and modules, read straight from the file by the models list
+  uint32_t sectionsCrc[MODEL_SECTIONS];
+} savedModel;
+
+static uint32_t getModelSectionCrc(unsigned int section)
+{
+  unsigned int offset = section * MODEL_SECTION_SIZE;
+  return Crc32::update(0xFFFFFFFF, (const uint8_t *)&g_model + offset, min<unsigned int>(MODEL_SECTION_SIZE, sizeof(g_model) - offset));
+}
+
+static uint32_t getModelListedCrc()
+{
+  uint32_t crc = Crc32::update(0xFFFFFFFF, (const uint8_t *)&g_model.header, sizeof(g_model.header));
+  return Crc32::update(crc, (const uint8_t *)g_model.moduleData, sizeof(g_model.moduleData));
+}
+
+static void setSavedModel(const char * filename, uint32_t fileSize)
+{
+  if (filename != savedModel.filename) {
+    strncpy(savedModel.filename, filename, LEN_MODEL_FILENAME);
+    savedModel.filename[LEN_MODEL_FILENAME] = '\0';
+  }
+  savedModel.fileSize = fileSize;
+  savedModel.listedCrc = getModelListedCrc();
+  for (unsigned int i = 0; i < MODEL_SECTIONS; i++) {
+    savedModel.sectionsCrc[i] = getModelSectionCrc(i);
+  }
+}
+
+static void resetSavedModel()
+{
+  savedModel.filename[0] = '\0';
+}
+
+static uint32_t getJournalRecordCrc(const FileJournalRecord & record)
+{
+  return Crc32::update(0xFFFFFFFF, (const uint8_t *)&record, offsetof(FileJournalRecord, crc));
+}
+
+// Appends the dirty sections to the model file, returns false if the file has to be rewritten
+static bool appendModelJournal(const char * path, const uint8_t * dirty, unsigned int journalSize)
+{
+  if (savedModel.fileSize + journalSize > 8 + sizeof(g_model) + MODEL_JOURNAL_MAX ||
+      getModelListedCrc() != savedModel.listedCrc) {
+    return false;
+  }
+
+  FIL file;
+  if (f_open(&file, path, FA_OPEN_EXISTING | FA_WRITE) != FR_OK) {
+    return false;
+  }
+
+  // written since it was read (or a record was not completed)
+  if (f_size(&file) != savedModel.fileSize || f_lseek(&file, savedModel.fileSize) != FR_OK) {
+    f_close(&file);
+    return false;
+  }
+
+  unsigned int section = 0;
+  while (section < MODEL_SECTIONS) {
+    if (!(dirty[section / 8] & (1 << (section % 8)))) {
+      section++;
+      continue;
+    }
+    unsigned int first = section;
+    while (section < MODEL_SECTIONS && (dirty[section / 8] & (1 << (section % 8)))) {
+      section++;
+    }
+
+    FileJournalRecord record;
+    record.offset = first * MODEL_SECTION_SIZE;
+    record.length = min<unsigned int>(section * MODEL_SECTION_SIZE, sizeof(g_model)) - record.offset;
+    record.crc = Crc32::update(getJournalRecordCrc(record), (const uint8_t *)&g_model + record.offset, record.length);
+
+    UINT written;
+    if (f_write(&file, &record, sizeof(record), &written) != FR_OK || written != sizeof(record) ||
+        f_write(&file, (const uint8_t *)&g_model + record.offset, record.length, &written) != FR_OK || written != record.length) {
+      f_close(&file);
+      resetSavedModel();
+      return false;
+    }
+  }
+
+  uint32_t fileSize = f_size(&file);
+  if (f_close(&file) != FR_OK) {
+    resetSavedModel();
+    return false;
+  }
+
+  setSavedModel(savedModel.filename, fileSize);
+  return true;
+}
+
+const char * writeModel()
+{
+  char path[256];
+  getModelPath(path, g_eeGeneral.currModelFilename);
+
+  if (savedModel.filename[0] && !strncmp(savedModel.filename, g_eeGeneral.currModelFilename, LEN_MODEL_FILENAME)) {
+    uint8_t dirty[(MODEL_SECTIONS + 7) / 8];
+    unsigned int journalSize = 0;  // at most one record per dirty section
+    memclear(dirty, sizeof(dirty));
+    for (unsigned int i = 0; i < MODEL_SECTIONS; i++) {
+      if (getModelSectionCrc(i) != savedModel.sectionsCrc[i]) {
+        dirty[i / 8] |= 1 << (i % 8);
+        journalSize += sizeof(FileJournalRecord) + MODEL_SECTION_SIZE;
+      }
+    }
+
+    if (journalSize == 0) {
+      TRACE("writeModel(%s): unchanged", g_eeGeneral.currModelFilename);
+      return nullptr;
+    }
+
+    if (appendModelJournal(path, dirty, journalSize)) {
+      TRACE("writeModel(%s): journal %d bytes", g_eeGeneral.currModelFilename, int(savedModel.fileSize - 8 - sizeof(g_model)));
+      return nullptr;
+    }
+  }
+
+  sdCheckAndCreateDirectory(MODELS_PATH);
+  const char * error = writeFile(path, (uint8_t *)&g_model, sizeof(g_model));
+  if (error) {
+    resetSavedModel();
+  }
+  else {
+    setSavedModel(g_eeGeneral.currModelFilename, 8 + sizeof(g_model));
+  }
+  return error;
+}
+
+// Applies the journal records which follow the content, returns the end of the valid ones
+static uint32_t readJournal(FIL * file, uint16_t size, uint8_t * data, uint16_t maxsize)
+{
+  uint32_t end = 8 + size;
+  FileJournalRecord record;
+  uint8_t buf[64];
+  UINT read;
+
+  while (f_lseek(file, end) == FR_OK && f_read(file, &record, sizeof(record), &read) == FR_OK && read == sizeof(record) &&
+         record.offset + record.length <= size) {
+    // the record is only applied once its CRC is checked
+    uint32_t crc = getJournalRecordCrc(record);
+    uint16_t done = 0;
+    while (done < record.length) {
+      UINT count = min<uint16_t>(sizeof(buf), record.length - done);
+      if (f_read(file, buf, count, &read) != FR_OK || read != count)
+        return end;
+      crc = Crc32::update(crc, buf, count);
+      done += count;
+    }
+    if (crc != record.crc)
+      break;
+
+    if (record.offset < maxsize) {
+      UINT count = min<uint16_t>(record.length, maxsize - record.offset);
+      if (f_lseek(file, end + sizeof(record)) != FR_OK || f_read(file, data + record.offset, count, &read) != FR_OK || read != count)
+        break;
+    }
+    end += sizeof(record) + record.length;
+  }
+
+  return end;
+}
+
+const char * loadFile(const char * fullpath, uint8_t * data, uint16_t maxsize, uint8_t * version, uint16_t * fileSize = nullptr, uint32_t * journalEnd = nullptr)
 {
   FIL      file;
   UINT     read;
@@ -106,17 +284,25 @@ const char * loadFile(const char * fullpath, uint8_t * data, uint16_t maxsize, u
 
   TRACE("loadFile(%s)", fullpath);
 
+  recoverTempFile(fullpath);
+
   const char * err = openFile(fullpath, &file, &size, version);
   if (err)
     return err;
 
-  size = min<uint16_t>(maxsize, size);
-  FRESULT result = f_read(&file, data, size, &read);
-  if (result != FR_OK || read != size) {
+  if (fileSize)
+    *fileSize = size;
+  uint16_t count = min<uint16_t>(maxsize, size);
+  FRESULT result = f_read(&file, data, count, &read);
+  if (result != FR_OK || read != count) {
     f_close(&file);
     return SDCARD_ERROR(result);
   }
 
+  uint32_t end = readJournal(&file, size, data, maxsize);
+  if (journalEnd)
+    *journalEnd = end;
+
   f_close(&file);
   return nullptr;
 }
@@ -125,10 +311,20 @@ const char * readModel(const char * filename, uint8_t * buffer, uint32_t size, u
 {
   char path[256];
   getModelPath(path, filename);
-  return loadFile(path, buffer, size, version);
+  uint16_t fileSize = 0;
+  uint32_t journalEnd = 0;
+  const char * error = loadFile(path, buffer, size, version, &fileSize, &journalEnd);
+
+  // the content of the file, unless it has to be converted
+  if (buffer == (uint8_t *)&g_model) {
+    if (error == nullptr && fileSize == sizeof(g_model) && *version == EEPROM_VER)
+      setSavedModel(filename, journalEnd);
+    else
+      resetSavedModel();
+  }
+  return error;
 }
 
-
 const char * loadRadioSettings(const char * path)
 {
   uint8_t version;
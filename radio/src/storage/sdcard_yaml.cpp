@@ -33,6 +33,8 @@ const char * readYamlFile(const char* fullpath, const YamlParserCalls* calls, vo
     FIL  file;
     UINT bytes_read;
 
+    recoverTempFile(fullpath);
+
     FRESULT result = f_open(&file, fullpath, FA_OPEN_EXISTING | FA_READ);
     if (result != FR_OK) {
         return SDCARD_ERROR(result);
@@ -108,9 +110,9 @@ const char * writeGeneralSettings()
 
     FIL file;
 
-    FRESULT result = f_open(&file, RADIO_SETTINGS_YAML_PATH, FA_CREATE_ALWAYS | FA_WRITE);
-    if (result != FR_OK) {
-        return SDCARD_ERROR(result);
+    const char * error = openTempFile(RADIO_SETTINGS_YAML_PATH, &file);
+    if (error) {
+        return error;
     }
       
     YamlTreeWalker tree;
@@ -122,13 +124,12 @@ const char * writeGeneralSettings()
     
     if (!tree.generate(yaml_writer, &ctx)) {
         if (ctx.result != FR_OK) {
-            f_close(&file);
+            discardTempFile(RADIO_SETTINGS_YAML_PATH, &file);
             return SDCARD_ERROR(ctx.result);
         }
     }
 
-    f_close(&file);
-    return NULL;
+    return commitTempFile(RADIO_SETTINGS_YAML_PATH, &file);
 }
 
 
@@ -170,9 +171,9 @@ const char * writeModel()
 
     FIL file;
 
-    FRESULT result = f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE);
-    if (result != FR_OK) {
-        return SDCARD_ERROR(result);
+    const char * error = openTempFile(path, &file);
+    if (error) {
+        return error;
     }
       
     YamlTreeWalker tree;
@@ -184,11 +185,10 @@ const char * writeModel()
     
     if (!tree.generate(yaml_writer, &ctx)) {
         if (ctx.result != FR_OK) {
-            f_close(&file);
+            discardTempFile(path, &file);
             return SDCARD_ERROR(ctx.result);
         }
     }
 
-    f_close(&file);
-    return NULL;
+    return commitTempFile(path, &file);
 }
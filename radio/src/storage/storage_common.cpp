@@ -34,6 +34,12 @@ void storageDirty(uint8_t msk)
   storageDirtyMsk |= msk;
   storageDirtyTime10ms = get_tmr10ms();
 
+  // special functions may have been edited
+  if (msk & EE_GENERAL)
+    globalFunctionsContext.invalidateEntries();
+  if (msk & EE_MODEL)
+    modelFunctionsContext.invalidateEntries();
+
 #if defined(RTC_BACKUP_RAM)
   rambackupDirtyMsk = storageDirtyMsk;
   rambackupDirtyTime10ms = storageDirtyTime10ms;
@@ -75,6 +81,8 @@ void postRadioSettingsLoad()
     setDefaultOwnerId();
   }
 #endif
+
+  customFunctionsInvalidate();
 }
 
 #if defined(EXTERNAL_ANTENNA) && defined(INTERNAL_MODULE_PXX1)
@@ -164,6 +172,7 @@ void postModelLoad(bool alarms)
   AUDIO_FLUSH();
   flightReset(false);
 
+  // also invalidates the entries lists of both contexts
   customFunctionsReset();
 
   restoreTimers();
@@ -19,6 +19,7 @@
  */
 
 #include "opentx.h"
+#include "sources.h"
 
 #define CS_LAST_VALUE_INIT -32768
 
@@ -223,7 +224,7 @@ void getSwitchesPosition(bool startup)
 getvalue_t getValueForLogicalSwitch(mixsrc_t i)
 {
   getvalue_t result = getValue(i);
-  if (i>=MIXSRC_FIRST_INPUT && i<=MIXSRC_LAST_INPUT) {
+  if (SourceDispatch::get(i) == SOURCE_KIND_INPUT) {
     int8_t trimIdx = virtualInputsTrims[i-MIXSRC_FIRST_INPUT];
     if (trimIdx >= 0) {
       int16_t trim = trims[trimIdx];
@@ -432,61 +433,77 @@ bool getSwitch(swsrc_t swtch, uint8_t flags)
 
   uint8_t cs_idx = abs(swtch);
 
-  if (cs_idx == SWSRC_ONE) {
-    result = !s_mixer_first_run_done;
-  }
-  else if (cs_idx == SWSRC_ON) {
-    result = true;
-  }
+  switch (SwitchDispatch::get(cs_idx)) {
+    case SWITCH_KIND_ONE:
+      result = !s_mixer_first_run_done;
+      break;
+
+    case SWITCH_KIND_ON:
+      result = true;
+      break;
+
 #if defined(DEBUG_LATENCY)
-  else if (cs_idx == SWSRC_LATENCY_TOGGLE) {
-    result = latencyToggleSwitch;
-  }
+    case SWITCH_KIND_LATENCY_TOGGLE:
+      result = latencyToggleSwitch;
+      break;
 #endif
-  else if (cs_idx <= SWSRC_LAST_SWITCH) {
+
+    case SWITCH_KIND_SWITCH:
 #if defined(PCBFRSKY)
-    if (flags & GETSWITCH_MIDPOS_DELAY)
-      result = SWITCH_POSITION(cs_idx-SWSRC_FIRST_SWITCH);
-    else
-      result = switchState(cs_idx-SWSRC_FIRST_SWITCH);
+      if (flags & GETSWITCH_MIDPOS_DELAY)
+        result = SWITCH_POSITION(cs_idx-SWSRC_FIRST_SWITCH);
+      else
+        result = switchState(cs_idx-SWSRC_FIRST_SWITCH);
 #else
-    result = switchState(cs_idx-SWSRC_FIRST_SWITCH);
+      result = switchState(cs_idx-SWSRC_FIRST_SWITCH);
 #endif
+      break;
 
-  }
 #if NUM_XPOTS > 0
-  else if (cs_idx <= SWSRC_LAST_MULTIPOS_SWITCH) {
-    result = POT_POSITION(cs_idx-SWSRC_FIRST_MULTIPOS_SWITCH);
-  }
+    case SWITCH_KIND_MULTIPOS:
+      result = POT_POSITION(cs_idx-SWSRC_FIRST_MULTIPOS_SWITCH);
+      break;
 #endif
-  else if (cs_idx <= SWSRC_LAST_TRIM) {
-    uint8_t idx = cs_idx - SWSRC_FIRST_TRIM;
-    idx = (CONVERT_MODE_TRIMS(idx/2) << 1) + (idx & 1);
-    result = trimDown(idx);
-  }
-  else if (cs_idx == SWSRC_RADIO_ACTIVITY) {
-    result = (inactivity.counter < 2);
-  }
-  else if (cs_idx >= SWSRC_FIRST_SENSOR) {
-    result = !telemetryItems[cs_idx-SWSRC_FIRST_SENSOR].isOld();
-  }
-  else if (cs_idx == SWSRC_TELEMETRY_STREAMING) {
-    result = TELEMETRY_STREAMING();
-  }
-  else if (cs_idx >= SWSRC_FIRST_FLIGHT_MODE) {
+
+    case SWITCH_KIND_TRIM:
+    {
+      uint8_t idx = cs_idx - SWSRC_FIRST_TRIM;
+      idx = (CONVERT_MODE_TRIMS(idx/2) << 1) + (idx & 1);
+      result = trimDown(idx);
+      break;
+    }
+
+    case SWITCH_KIND_RADIO_ACTIVITY:
+      result = (inactivity.counter < 2);
+      break;
+
+    case SWITCH_KIND_SENSOR:
+      result = !telemetryItems[cs_idx-SWSRC_FIRST_SENSOR].isOld();
+      break;
+
+    case SWITCH_KIND_TELEMETRY_STREAMING:
+      result = TELEMETRY_STREAMING();
+      break;
+
 #if defined(FLIGHT_MODES)
-    uint8_t idx = cs_idx - SWSRC_FIRST_FLIGHT_MODE;
-    if (flags & GETSWITCH_MIDPOS_DELAY)
-      result = (idx == flightModeTransitionLast);
-    else
-      result = (idx == mixerCurrentFlightMode);
-#else
-    result = false;
+    case SWITCH_KIND_FLIGHT_MODE:
+    {
+      uint8_t idx = cs_idx - SWSRC_FIRST_FLIGHT_MODE;
+      if (flags & GETSWITCH_MIDPOS_DELAY)
+        result = (idx == flightModeTransitionLast);
+      else
+        result = (idx == mixerCurrentFlightMode);
+      break;
+    }
 #endif
-   }
-  else {
-    cs_idx -= SWSRC_FIRST_LOGICAL_SWITCH;
-    result = lswFm[mixerCurrentFlightMode].lsw[cs_idx].state;
+
+    case SWITCH_KIND_LOGICAL_SWITCH:
+      result = lswFm[mixerCurrentFlightMode].lsw[cs_idx-SWSRC_FIRST_LOGICAL_SWITCH].state;
+      break;
+
+    default:
+      result = false;
+      break;
   }
 
   return swtch > 0 ? result : !result;
@@ -189,6 +189,7 @@ extern "C" void AUDIO_TIM_IRQHandler()
 
 extern "C" void AUDIO_DMA_Stream_IRQHandler()
 {
+  DEBUG_INTERRUPT(INT_AUDIO_DMA);
   AUDIO_DMA_Stream->CR &= ~DMA_SxCR_TCIE ;            // Stop interrupt
   AUDIO_DMA->HIFCR = DMA_HIFCR_CTCIF5 | DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTEIF5 | DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CFEIF5 ; // Write ones to clear flags
   AUDIO_DMA_Stream->CR &= ~DMA_SxCR_EN ;                              // Disable DMA channel
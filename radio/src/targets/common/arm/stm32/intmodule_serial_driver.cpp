@@ -100,6 +100,7 @@ void intmoduleSerialStart(uint32_t baudrate, uint8_t rxEnable, uint16_t parity,
 #define USART_FLAG_ERRORS (USART_FLAG_ORE | USART_FLAG_NE | USART_FLAG_FE | USART_FLAG_PE)
 extern "C" void INTMODULE_USART_IRQHandler(void)
 {
+  DEBUG_INTERRUPT(INT_INTMODULE);
 #if !defined(INTMODULE_DMA_STREAM)
   // Send
   if (USART_GetITStatus(INTMODULE_USART, USART_IT_TXE) != RESET) {
@@ -169,6 +170,8 @@ void intmoduleSendBuffer(const uint8_t * data, uint8_t size)
 
 void intmoduleSendNextFrame()
 {
+  LATENCY_STAMP(LATENCY_TRANSMIT);
+
   switch (moduleState[INTERNAL_MODULE].protocol) {
 #if defined(PXX2)
     case PROTOCOL_CHANNELS_PXX2_HIGHSPEED:
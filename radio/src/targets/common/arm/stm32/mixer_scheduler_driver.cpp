@@ -74,8 +74,8 @@ extern "C" void MIXER_SCHEDULER_TIMER_IRQHandler(void)
   MIXER_SCHEDULER_TIMER->SR &= ~TIM_SR_UIF; // clear flag
   mixerSchedulerDisableTrigger();
 
-  // set next period
-  MIXER_SCHEDULER_TIMER->ARR = 2 * getMixerSchedulerPeriod() - 1;
+  // set next period, shifted when locked to an asynchronous module
+  MIXER_SCHEDULER_TIMER->ARR = 2 * mixerSchedulerNextPeriod() - 1;
 
   // trigger mixer start
   mixerSchedulerISRTrigger();
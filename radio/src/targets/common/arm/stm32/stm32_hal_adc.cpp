@@ -25,6 +25,17 @@
 static bool adc_disable_dma(DMA_Stream_TypeDef * dma_stream);
 static void adc_dma_clear_flags(DMA_Stream_TypeDef * dma_stream);
 
+#if defined(ADC_FREE_RUNNING)
+// The ADCs convert continuously, each one into a circular DMA buffer holding its
+// last ADC_OVERSAMPLING scans. Reading is only averaging these buffers: the mixer
+// never waits for a conversion. The long sample time improves accuracy and paces
+// the ADCs: a conversion takes 480 + 12 ADC clock cycles (PCLK2 / 2, 30MHz on F2,
+// 42MHz on F4), i.e. 12-16us per channel. A scan of 10 channels takes 120-165us,
+// and the 8 averaged scans are the last ~0.9-1.3ms of samples.
+#define ADC_OVERSAMPLING             8
+#define ADC_FREE_RUNNING_SAMPTIME    7   // sample time = 480 cycles
+#endif
+
 static void adc_init_pins()
 {
   GPIO_InitTypeDef GPIO_InitStructure;
@@ -60,7 +71,11 @@ static void adc_setup_scan_mode(ADC_TypeDef* ADCx, uint8_t nconv)
   ADC_StructInit(&ADC_InitStructure);
 
   ADC_InitStructure.ADC_ScanConvMode = ENABLE; // Sets ADC_CR1_SCAN
+#if defined(ADC_FREE_RUNNING)
+  ADC_InitStructure.ADC_ContinuousConvMode = ENABLE; // Sets ADC_CR2_CONT
+#else
   ADC_InitStructure.ADC_ContinuousConvMode = DISABLE; // Clears ADC_CR2_CONT
+#endif
   ADC_InitStructure.ADC_ExternalTrigConvEdge = ADC_ExternalTrigConvEdge_None; // Software trigger
   ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Right;
   ADC_InitStructure.ADC_NbrOfConversion = nconv; // Channel count
@@ -216,11 +231,24 @@ static void adc_init_channels(ADC_TypeDef* adc, const stm32_hal_adc_channel* cha
 
   uint8_t rank = 1;
   while (nconv > 0) {
+#if defined(ADC_FREE_RUNNING)
+    ADC_RegularChannelConfig(adc, chan->adc_channel, rank, ADC_FREE_RUNNING_SAMPTIME);
+#else
     ADC_RegularChannelConfig(adc, chan->adc_channel, rank, chan->sample_time);
+#endif
     nconv--; rank++; chan++;
   }
 }
 
+#if defined(ADC_FREE_RUNNING)
+static uint16_t adcSamples[DIM(ADC_hal_def) - 1][ADC_OVERSAMPLING * NUM_ANALOGS] __DMA;
+
+static uint16_t * adc_get_samples_buffer(const stm32_hal_adc * adc_def)
+{
+  return adcSamples[adc_def - ADC_hal_def];
+}
+#endif
+
 static bool adc_init_dma_stream(ADC_TypeDef* adc, DMA_Stream_TypeDef * dma_stream,
                                 uint32_t dma_channel, uint16_t* dest, uint8_t nconv)
 {
@@ -234,15 +262,24 @@ static bool adc_init_dma_stream(ADC_TypeDef* adc, DMA_Stream_TypeDef * dma_strea
   // setup DMA request
   dma_stream->PAR = CONVERT_PTR_UINT(&adc->DR);
   dma_stream->M0AR = CONVERT_PTR_UINT(dest);
+#if defined(ADC_FREE_RUNNING)
+  dma_stream->NDTR = nconv * ADC_OVERSAMPLING;
+  // Very high priority, 2 bytes transfers, increment memory, circular
+  dma_stream->CR = DMA_SxCR_PL | dma_channel | DMA_SxCR_MSIZE_0 |
+                   DMA_SxCR_PSIZE_0 | DMA_SxCR_MINC | DMA_SxCR_CIRC;
+#else
   dma_stream->NDTR = nconv;
   // Very high priority, 1 byte transfers, increment memory
   dma_stream->CR = DMA_SxCR_PL | dma_channel | DMA_SxCR_MSIZE_0 |
                    DMA_SxCR_PSIZE_0 | DMA_SxCR_MINC;
+#endif
   // disable direct mode, half full FIFO
   dma_stream->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH_0;
   return true;
 }
 
+static bool stm32_hal_adc_start_read();
+
 static bool stm32_hal_adc_init()
 {
   adc_init_pins();
@@ -269,7 +306,11 @@ static bool stm32_hal_adc_init()
         }
 
         if (adc_def->dma_stream && adc_def->get_dma_buffer) {
+#if defined(ADC_FREE_RUNNING)
+          uint16_t* dma_buffer = adc_get_samples_buffer(adc_def);
+#else
           uint16_t* dma_buffer = adc_def->get_dma_buffer();
+#endif
           if (!adc_init_dma_stream(adc_def->adc, adc_def->dma_stream,
                                    adc_def->dma_channel, dma_buffer, nconv))
               return false;
@@ -290,7 +331,12 @@ static bool stm32_hal_adc_init()
     sticksPwmInit();
   }
 #endif
+
+#if defined(ADC_FREE_RUNNING)
+  return stm32_hal_adc_start_read();
+#else
   return true;
+#endif
 }
 
 #define DMA_Stream0_IT_MASK     (uint32_t)(DMA_LISR_FEIF0 | DMA_LISR_DMEIF0 | \
@@ -378,6 +424,7 @@ static bool stm32_hal_adc_start_read()
   return true;
 }
 
+#if !defined(ADC_FREE_RUNNING)
 static void stm32_hal_adc_wait_completion()
 {
   //TODO:
@@ -413,9 +460,58 @@ static void stm32_hal_adc_wait_completion()
 #endif
 #endif
 }
+#endif
+
+#if defined(ADC_FREE_RUNNING)
+static bool stm32_hal_adc_read_latest()
+{
+  const stm32_hal_adc* adc_def = ADC_hal_def;
+  while (adc_def->adc) {
+    uint8_t nconv = adc_def->get_nconv ? adc_def->get_nconv() : 0;
+    if (nconv > 0 && adc_def->dma_stream && adc_def->get_dma_buffer) {
+      if (adc_def->adc->SR & ADC_SR_OVR) {
+        // the DMA missed a conversion and the ADC stopped: restart both from the
+        // first channel, the buffer still holds the previous samples meanwhile
+        adc_disable_dma(adc_def->dma_stream);
+        adc_def->dma_stream->NDTR = nconv * ADC_OVERSAMPLING;
+        adc_start_dma_conversion(adc_def->adc, adc_def->dma_stream);
+      }
+
+      const uint16_t * samples = adc_get_samples_buffer(adc_def);
+      uint16_t * dest = adc_def->get_dma_buffer();
+      for (uint8_t i = 0; i < nconv; i++) {
+        uint32_t sum = 0;
+        for (uint8_t n = 0; n < ADC_OVERSAMPLING; n++) {
+          sum += samples[n * nconv + i];
+        }
+        dest[i] = sum / ADC_OVERSAMPLING;
+      }
+    }
+    // move to next ADC definition
+    adc_def++;
+  }
+
+#if defined(ADC_EXT) && !defined(ADC_EXT_DMA_Stream)
+  // continuous single channel conversion: DR holds the last one
+  if (isVBatBridgeEnabled()) {
+    rtcBatteryVoltage = ADC_EXT->DR;
+  }
+#endif
+
+  return true;
+}
 
+const etx_hal_adc_driver_t stm32_hal_adc_driver = {
+  stm32_hal_adc_init,
+  nullptr,
+  nullptr,
+  stm32_hal_adc_read_latest
+};
+#else
 const etx_hal_adc_driver_t stm32_hal_adc_driver = {
   stm32_hal_adc_init,
   stm32_hal_adc_start_read,
-  stm32_hal_adc_wait_completion
+  stm32_hal_adc_wait_completion,
+  nullptr
 };
+#endif
@@ -86,7 +86,7 @@ void interrupt1ms()
 
 extern "C" void INTERRUPT_xMS_IRQHandler()
 {
+  DEBUG_INTERRUPT(INT_1MS);
   INTERRUPT_xMS_TIMER->SR &= ~TIM_SR_UIF;
   interrupt1ms();
-  DEBUG_INTERRUPT(INT_1MS);
 }
@@ -93,6 +93,8 @@ int8_t STORAGE_Write (uint8_t lun,
 
 int8_t STORAGE_GetMaxLun (void);
 
+int8_t STORAGE_Flush (uint8_t lun);
+
 const USBD_STORAGE_cb_TypeDef USBD_MICRO_SDIO_fops =    // modified my OpenTX
 {
   STORAGE_Init,
@@ -169,6 +171,9 @@ uint8_t lunReady[STORAGE_LUN_NBR];
 
 void usbPluggedIn()
 {
+#if defined(USB_MSC_CACHE)
+  usbMscCache.start(sdGetNoSectors());
+#endif
   lunReady[STORAGE_SDCARD_LUN] = 1;
   lunReady[STORAGE_EEPROM_LUN] = 1;
 }
@@ -219,8 +224,12 @@ int8_t STORAGE_Read (uint8_t lun,
     return (fat12Read(buf, blk_addr, blk_len) == 0) ? 0 : -1;
   }
 
+#if defined(USB_MSC_CACHE)
+  return (usbMscCache.read(buf, blk_addr, blk_len) == RES_OK) ? 0 : -1;
+#else
   // read without cache
   return (__disk_read(0, buf, blk_addr, blk_len) == RES_OK) ? 0 : -1;
+#endif
 }
 /**
   * @brief  Write data to the medium
@@ -242,8 +251,28 @@ int8_t STORAGE_Write (uint8_t lun,
     return (fat12Write(buf, blk_addr, blk_len) == 0) ? 0 : -1;
   }
 
+#if defined(USB_MSC_CACHE)
+  return (usbMscCache.write(buf, blk_addr, blk_len) == RES_OK) ? 0 : -1;
+#else
   // write without cache
   return (__disk_write(0, buf, blk_addr, blk_len) == RES_OK) ? 0 : -1;
+#endif
+}
+
+/**
+  * @brief  Complete the pending writes, called when the host polls the unit or allows its removal
+  * @param  lun : logical unit number
+  * @retval Status
+  */
+
+int8_t STORAGE_Flush (uint8_t lun)
+{
+#if defined(USB_MSC_CACHE)
+  if (lun == STORAGE_SDCARD_LUN) {
+    return (usbMscCache.flush() == RES_OK) ? 0 : -1;
+  }
+#endif
+  return 0;
 }
 
 /**
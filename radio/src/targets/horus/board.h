@@ -56,6 +56,7 @@ extern HardwareOptions hardwareOptions;
 #define MB                             *1024*1024
 #define LUA_MEM_EXTRA_MAX              (2 MB)    // max allowed memory usage for Lua bitmaps (in bytes)
 #define LUA_MEM_MAX                    (6 MB)    // max allowed memory usage for complete Lua  (in bytes), 0 means unlimited
+#define LUA_CHUNK_CACHE_SIZE           (256 * 1024)  // RAM kept for compiled Lua chunks across model switches (in bytes), 0 means disabled
 
 // HSI is at 168Mhz (over-drive is not enabled!)
 #define PERI1_FREQUENCY                42000000
@@ -19,6 +19,7 @@
  */
 
 #include "opentx.h"
+#include "mixer_scheduler.h"
 
 void extmoduleStop()
 {
@@ -267,6 +268,7 @@ void extmoduleSendBuffer(const uint8_t * data, uint8_t size)
 #define USART_FLAG_ERRORS (USART_FLAG_ORE | USART_FLAG_NE | USART_FLAG_FE | USART_FLAG_PE)
 extern "C" void EXTMODULE_USART_IRQHandler(void)
 {
+  DEBUG_INTERRUPT(INT_EXTMODULE);
   uint32_t status = EXTMODULE_USART->SR;
 
   while (status & (USART_FLAG_RXNE | USART_FLAG_ERRORS)) {
@@ -284,6 +286,8 @@ extern "C" void EXTMODULE_USART_IRQHandler(void)
 
 void extmoduleSendNextFrame()
 {
+  LATENCY_STAMP(LATENCY_TRANSMIT);
+
   switch (moduleState[EXTERNAL_MODULE].protocol) {
     case PROTOCOL_CHANNELS_PPM:
 #if defined(PCBX10) || PCBREV >= 13
@@ -462,6 +466,7 @@ void extmoduleSendInvertedByte(uint8_t byte)
 
 extern "C" void EXTMODULE_TIMER_DMA_IRQHandler()
 {
+  DEBUG_INTERRUPT(INT_EXTMODULE);
   if (!DMA_GetITStatus(EXTMODULE_TIMER_DMA_STREAM, EXTMODULE_TIMER_DMA_FLAG_TC))
     return;
 
@@ -477,9 +482,11 @@ extern "C" void EXTMODULE_TIMER_DMA_IRQHandler()
 
 extern "C" void EXTMODULE_TIMER_IRQHandler()
 {
+  DEBUG_INTERRUPT(INT_EXTMODULE);
   EXTMODULE_TIMER->DIER &= ~TIM_DIER_CC2IE; // Stop this interrupt
   EXTMODULE_TIMER->SR &= ~TIM_SR_CC2IF;
 
+  mixerSchedulerISRFrameBuild(EXTERNAL_MODULE);
   if (setupPulsesExternalModule())
     extmoduleSendNextFrame();
 }
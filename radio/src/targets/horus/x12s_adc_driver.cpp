@@ -277,4 +277,5 @@ const etx_hal_adc_driver_t x12s_adc_driver = {
   x12s_adc_init,
   nullptr,//x12s_adc_start_read,
   nullptr,//x12s_adc_wait_completion
+  nullptr
 };
@@ -89,8 +89,28 @@ Adc Adc0;
 
 FATFS g_FATFS_Obj;
 
+// when enabled, time only moves forward with simuAdvanceVirtualClock() or inside simuSleep() (headless batch runs)
+static bool simuVirtualClockEnabled = false;
+static uint64_t simuVirtualClockMicros = 0;
+static void (*simuVirtualSleepHandler)(uint32_t ms) = nullptr;
+
+void simuSetVirtualClock(bool enable, void (*sleepHandler)(uint32_t ms))
+{
+  simuVirtualClockMicros = 0;
+  simuVirtualSleepHandler = sleepHandler;
+  simuVirtualClockEnabled = enable;
+}
+
+void simuAdvanceVirtualClock(uint32_t micros)
+{
+  simuVirtualClockMicros += micros;
+}
+
 uint64_t simuTimerMicros(void)
 {
+  if (simuVirtualClockEnabled)
+    return simuVirtualClockMicros;
+
 #if SIMPGMSPC_USE_QT
   static QElapsedTimer ticker;
   if (!ticker.isValid())
@@ -260,6 +280,15 @@ bool simuIsRunning()
 
 uint8_t simuSleep(uint32_t ms)
 {
+  if (simuVirtualClockEnabled) {
+    // the handler runs what the other tasks would have done meanwhile
+    if (simuVirtualSleepHandler)
+      simuVirtualSleepHandler(ms);
+    else
+      simuAdvanceVirtualClock(ms * 1000);
+    return simu_shutdown;
+  }
+
   for (uint32_t i = 0; i < ms; ++i){
     if (simu_shutdown || !simu_running)
       return 1;
@@ -456,11 +485,12 @@ void telemetryPortInit(uint32_t baudrate, uint8_t mode)
 
 bool telemetryGetByte(uint8_t * byte)
 {
-  return false;
+  return simuDeviceGetByte(byte);
 }
 
 void telemetryClearFifo()
 {
+  simuDeviceClearFifo();
 }
 
 void telemetryPortInvertedInit(uint32_t baudrate)
@@ -473,6 +503,7 @@ void sportSendByte(uint8_t byte)
 
 void sportSendBuffer(const uint8_t * buffer, uint32_t count)
 {
+  simuDeviceSend(buffer, count);
 }
 
 void check_telemetry_exti()
@@ -252,11 +252,39 @@ void simuSetTrim(uint8_t trim, bool state);
 void simuSetSwitch(uint8_t swtch, int8_t state);
 
 #if defined(__cplusplus)
+void simuSetVirtualClock(bool enable, void (*sleepHandler)(uint32_t ms) = nullptr);
+void simuAdvanceVirtualClock(uint32_t micros);
+
+// S.Port device bootloader emulator answering the firmware update frames (see simudevice.cpp)
+struct SimuDeviceOptions {
+  uint32_t byteTime = 174;     // us per byte on the wire (57600 bauds)
+  uint32_t latency = 500;      // us between the end of a request and the start of its answer
+  uint32_t stallAfter = 0;     // number of data words after which the device stops answering (0 = never)
+  bool rejectImage = false;    // answer the end of transfer with a CRC error
+  bool absent = false;         // no device on the port
+};
+
+struct SimuDeviceStats {
+  uint32_t requests;
+  uint32_t badFrames;
+  uint32_t words;
+  uint64_t downloadStart;      // simu time of the download command (us)
+  uint64_t downloadEnd;        // simu time of the end of transfer (us)
+};
+
+void simuDeviceReset(const SimuDeviceOptions & options = SimuDeviceOptions());
+const SimuDeviceStats & simuDeviceGetStats();
+const uint8_t * simuDeviceGetImage(uint32_t & size);
+void simuDeviceSend(const uint8_t * buffer, uint32_t count);
+bool simuDeviceGetByte(uint8_t * byte);
+void simuDeviceClearFifo();
+
 void simuInit();
 void simuStart(bool tests = true, const char * sdPath = nullptr, const char * settingsPath = nullptr);
 void simuStop();
 bool simuIsRunning();
 void startEepromThread(const char * filename = "eeprom.bin");
+void startEepromSynchronous(const char * filename);
 void stopEepromThread();
 
 #if defined(SIMU_AUDIO)
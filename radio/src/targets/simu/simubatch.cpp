@@ -0,0 +1,511 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * Headless simulator: runs the firmware on a virtual clock, single threaded, as fast as the
+ * host allows. The tasks are replaced by a fixed 1ms step loop which calls the same functions
+ * as the mixer, menus and audio tasks, so that two runs of the same script always give the
+ * same results.
+ *
+ * Script format, one event per line ('#' starts a comment):
+ *   <time ms> ana <index> <value -1024..1024, multi-position pots 0..2048>
+ *   <time ms> switch <index> <-1|0|1>
+ *   <time ms> key <index> <0|1>
+ *   <time ms> trim <index> <0|1>
+ *   <time ms> end
+ *
+ * Outputs, in the directory given with --output:
+ *   outputs.csv          time, channel outputs and logical switches (hex mask, LS1 = LSB)
+ *   frame-<time>.pgm     LCD frames, written only when the screen content changes (--frames)
+ */
+
+#include "opentx.h"
+#include "mixer_scheduler.h"
+#include "simulcd.h"
+#include "tasks.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#if defined(COLORLCD)
+  #include "fonts.h"
+  constexpr char FRAME_FORMAT = 'p'; // PPM
+#else
+  constexpr char FRAME_FORMAT = 'g'; // PGM
+#endif
+
+constexpr uint32_t SIMU_BATCH_MENUS_PERIOD = 50 /*ms*/;
+constexpr gtime_t SIMU_BATCH_RTC_START = 946684800; // 2000-01-01 00:00:00
+
+uint16_t anaInValues[NUM_ANALOGS] = { 0 };
+
+uint16_t anaIn(uint8_t chan)
+{
+  if (chan < NUM_ANALOGS)
+    return anaInValues[chan];
+  else
+    return 0;
+}
+
+uint16_t getAnalogValue(uint8_t index)
+{
+  return anaIn(index);
+}
+
+enum SimuBatchEventType {
+  SIMU_BATCH_ANA,
+  SIMU_BATCH_SWITCH,
+  SIMU_BATCH_KEY,
+  SIMU_BATCH_TRIM,
+  SIMU_BATCH_END
+};
+
+struct SimuBatchEvent {
+  uint32_t time;
+  SimuBatchEventType type;
+  uint32_t index;
+  int32_t value;
+};
+
+static bool parseScript(const char * filename, std::vector<SimuBatchEvent> & events)
+{
+  FILE * f = fopen(filename, "r");
+  if (!f) {
+    perror(filename);
+    return false;
+  }
+
+  char line[256];
+  unsigned lineNumber = 0;
+  while (fgets(line, sizeof(line), f)) {
+    lineNumber++;
+    char * comment = strchr(line, '#');
+    if (comment)
+      *comment = '\0';
+
+    SimuBatchEvent event;
+    char command[16];
+    int value = 0;
+    int count = sscanf(line, "%u %15s %u %d", &event.time, command, &event.index, &value);
+    if (count <= 0)
+      continue;
+
+    uint32_t max = 0;
+    if (count == 4 && !strcmp(command, "ana")) {
+      event.type = SIMU_BATCH_ANA;
+      max = NUM_ANALOGS;
+    }
+    else if (count == 4 && !strcmp(command, "switch")) {
+      event.type = SIMU_BATCH_SWITCH;
+      max = NUM_SWITCHES;
+    }
+    else if (count == 4 && !strcmp(command, "key")) {
+      event.type = SIMU_BATCH_KEY;
+      max = NUM_KEYS;
+    }
+    else if (count == 4 && !strcmp(command, "trim")) {
+      event.type = SIMU_BATCH_TRIM;
+      max = NUM_TRIMS_KEYS;
+    }
+    else if (count == 2 && !strcmp(command, "end")) {
+      event.type = SIMU_BATCH_END;
+      event.index = 0;
+      max = 1;
+    }
+    else {
+      fprintf(stderr, "%s:%u: syntax error\n", filename, lineNumber);
+      fclose(f);
+      return false;
+    }
+
+    if (event.index >= max) {
+      fprintf(stderr, "%s:%u: index %u out of range (max %u)\n", filename, lineNumber, event.index, max - 1);
+      fclose(f);
+      return false;
+    }
+
+    if (!events.empty() && event.time < events.back().time) {
+      fprintf(stderr, "%s:%u: events must be sorted by time\n", filename, lineNumber);
+      fclose(f);
+      return false;
+    }
+
+    event.value = value;
+    events.push_back(event);
+  }
+
+  fclose(f);
+  return true;
+}
+
+static void applyEvent(const SimuBatchEvent & event)
+{
+  switch (event.type) {
+    case SIMU_BATCH_ANA:
+      anaInValues[event.index] = limit<int32_t>(-RESX, event.value, 2 * RESX);
+      break;
+    case SIMU_BATCH_SWITCH:
+      simuSetSwitch(event.index, limit<int32_t>(-1, event.value, 1));
+      break;
+    case SIMU_BATCH_KEY:
+      simuSetKey(event.index, event.value != 0);
+      break;
+    case SIMU_BATCH_TRIM:
+      simuSetTrim(event.index, event.value != 0);
+      break;
+    default:
+      break;
+  }
+}
+
+static void writeOutputsHeader(FILE * f)
+{
+  fprintf(f, "time");
+  for (uint8_t i = 0; i < MAX_OUTPUT_CHANNELS; i++) {
+    fprintf(f, ",CH%d", i + 1);
+  }
+  fprintf(f, ",LS\n");
+}
+
+static void writeOutputs(FILE * f, uint32_t now)
+{
+  fprintf(f, "%u", now);
+  for (uint8_t i = 0; i < MAX_OUTPUT_CHANNELS; i++) {
+    fprintf(f, ",%d", channelOutputs[i]);
+  }
+
+  uint64_t logicalSwitches = 0;
+  for (uint8_t i = 0; i < MAX_LOGICAL_SWITCHES; i++) {
+    if (getSwitch(SWSRC_FIRST_LOGICAL_SWITCH + i))
+      logicalSwitches |= (uint64_t)1 << i;
+  }
+  fprintf(f, ",%016llx\n", (unsigned long long)logicalSwitches);
+}
+
+static bool writeFrame(const std::string & directory, uint32_t now)
+{
+  char filename[32];
+  snprintf(filename, sizeof(filename), "/frame-%08u.p%cm", now, FRAME_FORMAT);
+
+  FILE * f = fopen((directory + filename).c_str(), "wb");
+  if (!f) {
+    perror(filename + 1);
+    return false;
+  }
+
+#if defined(COLORLCD)
+  fprintf(f, "P6\n%d %d\n255\n", LCD_W, LCD_H);
+  for (int i = 0; i < LCD_W * LCD_H; i++) {
+    pixel_t pixel = simuLcdBuf[i];
+    uint8_t rgb[3] = { uint8_t((pixel >> 11) << 3), uint8_t(((pixel >> 5) & 0x3F) << 2), uint8_t((pixel & 0x1F) << 3) };
+    fwrite(rgb, sizeof(rgb), 1, f);
+  }
+#else
+  fprintf(f, "P5\n%d %d\n255\n", LCD_W, LCD_H);
+  for (int y = 0; y < LCD_H; y++) {
+    for (int x = 0; x < LCD_W; x++) {
+#if LCD_DEPTH == 4
+      pixel_t z = simuLcdBuf[(y / 2) * LCD_W + x];
+      uint8_t grey = 255 - ((y & 1) ? (z >> 4) : (z & 0x0F)) * 17;
+#else
+      uint8_t grey = (simuLcdBuf[(y / 8) * LCD_W + x] & (1 << (y % 8))) ? 0 : 255;
+#endif
+      fputc(grey, f);
+    }
+  }
+#endif
+
+  fclose(f);
+  return true;
+}
+
+struct SimuBatchRun {
+  std::vector<SimuBatchEvent> events;
+  std::vector<SimuBatchEvent>::const_iterator nextEvent;
+  std::string outputPath;
+  FILE * outputs;
+  uint32_t duration;
+  uint32_t period;
+  bool frames;
+  uint32_t next10ms;
+  uint32_t nextAudio;
+  uint32_t nextMenus;
+  uint32_t nextOutputs;
+  uint32_t nextMixer;
+  uint32_t mixerCount;
+  int64_t maxMixerMicros;
+  uint32_t framesCount;
+  std::chrono::steady_clock::time_point start;
+  bool inStep;
+};
+
+static SimuBatchRun run;
+
+// the virtual clock is the only time source, the tasks sleeping during a step move it as well
+static uint32_t now()
+{
+  return simuTimerMicros() / 1000;
+}
+
+static void runMixer()
+{
+  auto start = std::chrono::steady_clock::now();
+
+  execMixerFrequentActions();
+
+  // a locked mutex means that the menus task is blocked while holding it: the mixer task would wait
+  if (!s_pulses_paused && pthread_mutex_trylock(&mixerMutex) == 0) {
+    doMixerCalculations();
+    sendSynchronousPulses((1 << INTERNAL_MODULE) | (1 << EXTERNAL_MODULE));
+    doMixerPeriodicUpdates();
+    RTOS_UNLOCK_MUTEX(mixerMutex);
+  }
+
+  // host time, the virtual clock does not move during a step
+  int64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  if (duration > run.maxMixerMicros)
+    run.maxMixerMicros = duration;
+  run.mixerCount++;
+}
+
+static void runAudio()
+{
+  // the buffer played during the last AUDIO_BUFFER_DURATION is given back to the queue
+  if (audioQueue.buffersFifo.getNextFilledBuffer())
+    audioQueue.buffersFifo.freeNextFilledBuffer();
+  audioQueue.wakeup();
+}
+
+static void runMenus()
+{
+  perMain();
+
+  if (run.frames && simuLcdRefresh) {
+    static pixel_t lastFrame[DISPLAY_BUFFER_SIZE];
+    simuLcdRefresh = false;
+    if (memcmp(lastFrame, simuLcdBuf, sizeof(lastFrame))) {
+      memcpy(lastFrame, simuLcdBuf, sizeof(lastFrame));
+      if (writeFrame(run.outputPath, now()))
+        run.framesCount++;
+    }
+  }
+}
+
+static int finish()
+{
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - run.start).count();
+  fclose(run.outputs);
+
+#if defined(EEPROM)
+  stopEepromThread();
+#endif
+
+  uint32_t simulated = now();
+  fprintf(stderr, "Simulated %u.%03us in %.3fs (x%.1f), %u mixer runs (max %dus), %u frames\n",
+          simulated / 1000, simulated % 1000, elapsed / 1e6, elapsed ? simulated * 1000.0 / elapsed : 0.0,
+          run.mixerCount, int(run.maxMixerMicros), run.framesCount);
+
+  return 0;
+}
+
+// one virtual millisecond: what the interrupts and the tasks (menus task excepted when it is blocked) do.
+// A sleep inside a step moves the clock further, the periodic actions which were due meanwhile are run late.
+static void step(bool menus)
+{
+  run.inStep = true;
+
+  for (; run.nextEvent != run.events.end() && run.nextEvent->time <= now(); ++run.nextEvent) {
+    applyEvent(*run.nextEvent);
+  }
+
+  for (; run.next10ms <= now(); run.next10ms += 10) {
+    per10ms();
+  }
+
+  if (run.nextMixer <= now()) {
+    runMixer();
+    run.nextMixer = now() + max<uint32_t>(1, getMixerSchedulerPeriod() / 1000);
+  }
+
+  for (; run.nextAudio <= now(); run.nextAudio += AUDIO_BUFFER_DURATION) {
+    runAudio();
+  }
+
+  if (menus && run.nextMenus <= now()) {
+    runMenus();
+    run.nextMenus = now() + SIMU_BATCH_MENUS_PERIOD;
+  }
+
+  if (run.nextOutputs <= now()) {
+    writeOutputs(run.outputs, now());
+    while (run.nextOutputs <= now())
+      run.nextOutputs += run.period;
+  }
+
+  simuAdvanceVirtualClock(1000);
+  run.inStep = false;
+}
+
+// called when a task waits (alerts, confirmations...)
+static void sleepHandler(uint32_t ms)
+{
+  if (run.inStep) {
+    simuAdvanceVirtualClock(ms * 1000);
+    return;
+  }
+
+  // the menus task is blocked, the other tasks go on
+  uint32_t end = now() + ms;
+  while (now() < end) {
+    if (now() >= run.duration) {
+      fprintf(stderr, "Run ended while the menus task was blocked\n");
+      exit(finish());
+    }
+    step(false);
+  }
+}
+
+static void usage(const char * name)
+{
+  fprintf(stderr, "Usage: %s [options] script\n", name);
+  fprintf(stderr, "  --eeprom <file>       EEPROM image (not modified, a freshly formatted one is used otherwise)\n");
+  fprintf(stderr, "  --sdcard <path>       SD card directory\n");
+  fprintf(stderr, "  --settings <path>     settings directory\n");
+  fprintf(stderr, "  --output <path>       output directory (default: current directory)\n");
+  fprintf(stderr, "  --duration <ms>       run duration (default: until the last script event)\n");
+  fprintf(stderr, "  --period <ms>         outputs recording period (default: 10)\n");
+  fprintf(stderr, "  --frames              write the LCD frames\n");
+}
+
+int main(int argc, char ** argv)
+{
+  const char * eepromFilename = nullptr;
+  const char * sdPath = nullptr;
+  const char * settingsPath = nullptr;
+  const char * scriptFilename = nullptr;
+
+  run.outputPath = ".";
+  run.period = 10;
+
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = (i + 1 < argc);
+    if (!strcmp(argv[i], "--eeprom") && hasValue)
+      eepromFilename = argv[++i];
+    else if (!strcmp(argv[i], "--sdcard") && hasValue)
+      sdPath = argv[++i];
+    else if (!strcmp(argv[i], "--settings") && hasValue)
+      settingsPath = argv[++i];
+    else if (!strcmp(argv[i], "--output") && hasValue)
+      run.outputPath = argv[++i];
+    else if (!strcmp(argv[i], "--duration") && hasValue)
+      run.duration = strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--period") && hasValue)
+      run.period = max<uint32_t>(1, strtoul(argv[++i], nullptr, 10));
+    else if (!strcmp(argv[i], "--frames"))
+      run.frames = true;
+    else if (argv[i][0] != '-' && !scriptFilename)
+      scriptFilename = argv[i];
+    else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (!scriptFilename) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  if (!parseScript(scriptFilename, run.events))
+    return 1;
+  run.nextEvent = run.events.begin();
+
+  if (!run.duration && !run.events.empty())
+    run.duration = run.events.back().time + 1;
+
+  run.outputs = fopen((run.outputPath + "/outputs.csv").c_str(), "w");
+  if (!run.outputs) {
+    perror("outputs.csv");
+    return 1;
+  }
+  writeOutputsHeader(run.outputs);
+
+#if defined(HAS_TX_RTC_VOLTAGE)
+  anaInValues[TX_RTC_VOLTAGE] = 800; // 2.34V
+#endif
+
+  run.start = std::chrono::steady_clock::now();
+  simuSetVirtualClock(true, sleepHandler);
+  simuInit();
+
+#if defined(EEPROM)
+  // the image is loaded in RAM, the runs never modify the file
+  eeprom = (uint8_t *)calloc(EEPROM_SIZE, 1);
+  if (eepromFilename) {
+    FILE * f = fopen(eepromFilename, "rb");
+    if (!f || fread(eeprom, 1, EEPROM_SIZE, f) == 0) {
+      perror(eepromFilename);
+      return 1;
+    }
+    fclose(f);
+  }
+  startEepromSynchronous(nullptr);
+#else
+  if (eepromFilename) {
+    fprintf(stderr, "--eeprom not supported on this radio\n");
+    return 1;
+  }
+#endif
+
+  simu_start_mode = OPENTX_START_NO_SPLASH | OPENTX_START_NO_CALIBRATION | OPENTX_START_NO_CHECKS;
+  simuFatfsSetPaths(sdPath, settingsPath);
+
+  g_tmr10ms = 1;
+#if defined(RTCLOCK)
+  g_rtcTime = SIMU_BATCH_RTC_START;
+#endif
+
+#if defined(LCD_CONTRAST_DEFAULT)
+  g_eeGeneral.contrast = LCD_CONTRAST_DEFAULT;
+#endif
+
+  boardInit();
+#if defined(COLORLCD)
+  loadFonts();
+#endif
+
+  RTOS_CREATE_MUTEX(audioMutex);
+  RTOS_CREATE_MUTEX(mixerMutex);
+
+#if defined(EEPROM)
+  if (!eepromFilename) {
+    storageEraseAll(false);
+  }
+#endif
+
+  opentxInit();
+
+  while (now() < run.duration) {
+    step(true);
+  }
+
+  return finish();
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * Emulation of a FrSky device bootloader on the S.Port, the other end of
+ * FrskyDeviceFirmwareUpdate::uploadFileNormal(). The answers are queued with
+ * the time they would reach the radio, given the wire speed and the device
+ * latency, so that flashing throughput and timeouts can be measured on the
+ * simu clock (real or virtual).
+ */
+
+#include "opentx.h"
+#include "io/frsky_firmware_update.h"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+struct SimuDeviceByte {
+  uint64_t time;
+  uint8_t value;
+};
+
+static std::mutex simuDeviceMutex;
+static SimuDeviceOptions simuDeviceOptions;
+static SimuDeviceStats simuDeviceStats;
+static std::deque<SimuDeviceByte> simuDeviceFifo;
+static std::vector<uint8_t> simuDeviceImage;
+static uint32_t simuDeviceAddress;
+static uint64_t simuDeviceWireFree;
+
+void simuDeviceReset(const SimuDeviceOptions & options)
+{
+  std::lock_guard<std::mutex> lock(simuDeviceMutex);
+  simuDeviceOptions = options;
+  memclear(&simuDeviceStats, sizeof(simuDeviceStats));
+  simuDeviceFifo.clear();
+  simuDeviceImage.clear();
+  simuDeviceAddress = 0;
+  simuDeviceWireFree = 0;
+}
+
+const SimuDeviceStats & simuDeviceGetStats()
+{
+  return simuDeviceStats;
+}
+
+const uint8_t * simuDeviceGetImage(uint32_t & size)
+{
+  size = simuDeviceImage.size();
+  return simuDeviceImage.data();
+}
+
+static void simuDevicePushByte(uint64_t & time, uint8_t byte)
+{
+  time += simuDeviceOptions.byteTime;
+  simuDeviceFifo.push_back({time, byte});
+}
+
+static void simuDeviceAnswer(uint64_t time, uint8_t prim, uint32_t data)
+{
+  uint8_t frame[8] = { 0x50, prim };
+  memcpy(&frame[2], &data, sizeof(data));
+  frame[7] = crc16(CRC_1021, frame, 7);
+
+  time = max<uint64_t>(time + simuDeviceOptions.latency, simuDeviceWireFree);
+  simuDevicePushByte(time, 0x7E);
+  simuDevicePushByte(time, 0x5E);
+  for (uint8_t byte: frame) {
+    if (byte == 0x7E || byte == 0x7D) {
+      simuDevicePushByte(time, 0x7D);
+      byte ^= 0x20;
+    }
+    simuDevicePushByte(time, byte);
+  }
+  simuDeviceWireFree = time;
+}
+
+// frames from the radio: 0x7E 0xFF then 8 byte stuffed bytes, see FrskyDeviceFirmwareUpdate::sendFrame()
+void simuDeviceSend(const uint8_t * buffer, uint32_t count)
+{
+  std::lock_guard<std::mutex> lock(simuDeviceMutex);
+
+  if (simuDeviceOptions.absent || count < 10 || buffer[0] != 0x7E || buffer[1] != 0xFF) {
+    return;
+  }
+
+  uint8_t frame[8];
+  uint8_t len = 0;
+  for (uint32_t i = 2; i < count && len < sizeof(frame); i++) {
+    if (buffer[i] == 0x7D && i + 1 < count) {
+      frame[len++] = buffer[++i] ^ 0x20;
+    }
+    else {
+      frame[len++] = buffer[i];
+    }
+  }
+
+  if (frame[0] != 0x50) {
+    return;
+  }
+
+  ++simuDeviceStats.requests;
+  if (len != sizeof(frame) || frame[7] != (uint8_t)crc16(CRC_1021, frame, 7)) {
+    ++simuDeviceStats.badFrames;
+    return;
+  }
+
+  // the answer cannot start before the request is fully received
+  uint64_t time = simuTimerMicros() + count * simuDeviceOptions.byteTime;
+
+  switch (frame[1]) {
+    case PRIM_REQ_POWERUP:
+      simuDeviceAnswer(time, PRIM_ACK_POWERUP, 0);
+      break;
+
+    case PRIM_REQ_VERSION:
+      simuDeviceAnswer(time, PRIM_ACK_VERSION, 0x00010203);
+      break;
+
+    case PRIM_CMD_DOWNLOAD:
+      simuDeviceImage.clear();
+      simuDeviceAddress = 0;
+      simuDeviceStats.downloadStart = time;
+      simuDeviceAnswer(time, PRIM_REQ_DATA_ADDR, simuDeviceAddress);
+      break;
+
+    case PRIM_DATA_WORD:
+      if (frame[6] != (simuDeviceAddress & 0xFF)) {
+        ++simuDeviceStats.badFrames;
+        break;
+      }
+      simuDeviceImage.insert(simuDeviceImage.end(), &frame[2], &frame[6]);
+      simuDeviceAddress += 4;
+      if (++simuDeviceStats.words != simuDeviceOptions.stallAfter) {
+        simuDeviceAnswer(time, PRIM_REQ_DATA_ADDR, simuDeviceAddress);
+      }
+      break;
+
+    case PRIM_DATA_EOF:
+      simuDeviceStats.downloadEnd = time;
+      simuDeviceAnswer(time, simuDeviceOptions.rejectImage ? PRIM_DATA_CRC_ERR : PRIM_END_DOWNLOAD, 0);
+      break;
+  }
+}
+
+bool simuDeviceGetByte(uint8_t * byte)
+{
+  std::lock_guard<std::mutex> lock(simuDeviceMutex);
+  if (simuDeviceFifo.empty() || simuDeviceFifo.front().time > simuTimerMicros()) {
+    return false;
+  }
+  *byte = simuDeviceFifo.front().value;
+  simuDeviceFifo.pop_front();
+  return true;
+}
+
+void simuDeviceClearFifo()
+{
+  std::lock_guard<std::mutex> lock(simuDeviceMutex);
+  simuDeviceFifo.clear();
+}
@@ -27,6 +27,7 @@ uint8_t * eeprom_buffer_data;
 volatile int32_t eeprom_buffer_size;
 bool eeprom_read_operation;
 bool eeprom_thread_running = false;
+bool eeprom_synchronous = false;
 uint8_t * eeprom = nullptr;
 sem_t * eeprom_write_sem;
 
@@ -63,6 +64,19 @@ void eepromSimuWriteBlock(uint8_t * buffer, size_t address, size_t size)
 }
 
 volatile uint8_t eepromTransferComplete = 1;
+
+static void eepromTransfer()
+{
+  assert(eeprom_buffer_size);
+  if (eeprom_read_operation) {
+    eepromReadBlock(eeprom_buffer_data, eeprom_pointer, eeprom_buffer_size);
+  }
+  else {
+    eepromSimuWriteBlock(eeprom_buffer_data, eeprom_pointer, eeprom_buffer_size);
+  }
+  eepromTransferComplete = 1;
+}
+
 void * eeprom_thread_function(void *)
 {
   eeprom_thread_running = true;
@@ -70,14 +84,7 @@ void * eeprom_thread_function(void *)
   while (!sem_wait(eeprom_write_sem)) {
     if (!eeprom_thread_running)
       return nullptr;
-    assert(eeprom_buffer_size);
-    if (eeprom_read_operation) {
-      eepromReadBlock(eeprom_buffer_data, eeprom_pointer, eeprom_buffer_size);
-    }
-    else {
-      eepromSimuWriteBlock(eeprom_buffer_data, eeprom_pointer, eeprom_buffer_size);
-    }
-    eepromTransferComplete = 1;
+    eepromTransfer();
   }
 
   return nullptr;
@@ -100,7 +107,10 @@ void eepromTransmitData(uint32_t address, uint8_t * buffer, uint32_t size, bool
   eeprom_buffer_size = size;
   eeprom_read_operation = read;
   eepromTransferComplete = 0;
-  sem_post(eeprom_write_sem);
+  if (eeprom_synchronous)
+    eepromTransfer();
+  else
+    sem_post(eeprom_write_sem);
 }
 
 #if defined(EEPROM_BLOCK_SIZE)
@@ -139,7 +149,7 @@ void eepromWriteBlock(uint8_t * buffer, size_t address, size_t size)
 
 pthread_t eeprom_thread_pid;
 
-void startEepromThread(const char * filename)
+static void openEepromFile(const char * filename)
 {
   eepromFile = filename;
   if (eepromFile) {
@@ -149,6 +159,18 @@ void startEepromThread(const char * filename)
     if (!fp)
       perror("error in fopen");
   }
+}
+
+// the transfers are done by the task which starts them, without any thread
+void startEepromSynchronous(const char * filename)
+{
+  openEepromFile(filename);
+  eeprom_synchronous = true;
+}
+
+void startEepromThread(const char * filename)
+{
+  openEepromFile(filename);
 
 #ifdef __APPLE__
   eeprom_write_sem = sem_open("eepromsem", O_CREAT, S_IRUSR | S_IWUSR, 0);
@@ -162,6 +184,13 @@ void startEepromThread(const char * filename)
 
 void stopEepromThread()
 {
+  if (eeprom_synchronous) {
+    eeprom_synchronous = false;
+    if (fp)
+      fclose(fp);
+    return;
+  }
+
   eeprom_thread_running = false;
   sem_post(eeprom_write_sem);
   pthread_join(eeprom_thread_pid, nullptr);
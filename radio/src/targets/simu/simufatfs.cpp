@@ -41,11 +41,13 @@
 
 #if MSVC_BUILD
   #include <direct.h>
+  #include <io.h>
   #include <stdlib.h>
   #include <sys/utime.h>
   #define mkdir(s, f) _mkdir(s)
 #else
   #include <sys/time.h>
+  #include <unistd.h>
   #include <utime.h>
 #endif
 
@@ -123,6 +125,12 @@ bool redirectToSettingsDirectory(const std::string & path)
       * model (*.bin) files in /MODELS directory
   */
   if (!simuSettingsDirectory.empty()) {
+#if defined(TMP_FILE_EXT)
+    // the temp file of a settings or model file goes to the same directory
+    if (endsWith(path, TMP_FILE_EXT)) {
+      return redirectToSettingsDirectory(path.substr(0, path.length() - (sizeof(TMP_FILE_EXT) - 1)));
+    }
+#endif
 #if defined(COLORLCD)
     if (path == RADIO_MODELSLIST_PATH || path == RADIO_SETTINGS_PATH
 #if defined(SDCARD_YAML)
@@ -387,6 +395,24 @@ FRESULT f_lseek (FIL* fil, DWORD offset)
   return FR_OK;
 }
 
+FRESULT f_truncate (FIL* fil)
+{
+  if (fil && fil->obj.fs) {
+    FILE * fp = (FILE*)fil->obj.fs;
+    fflush(fp);
+#if MSVC_BUILD
+    int result = _chsize(_fileno(fp), fil->fptr);
+#else
+    int result = ftruncate(fileno(fp), fil->fptr);
+#endif
+    TRACE_SIMPGMSPACE("f_truncate(%p) %u = %d", fil->obj.fs, fil->fptr, result);
+    if (result) {
+      return FR_DENIED;
+    }
+  }
+  return FR_OK;
+}
+
 UINT f_size(FIL* fil)
 {
   if (fil && fil->obj.fs) {
@@ -502,7 +528,7 @@ FRESULT f_unlink (const TCHAR * name)
   std::string path = convertToSimuPath(name);
   if (unlink(path.c_str())) {
     TRACE_SIMPGMSPACE("f_unlink(%s) = error %d (%s)", path.c_str(), errno, strerror(errno));
-    return FR_INVALID_NAME;
+    return (errno == ENOENT ? FR_NO_FILE : FR_INVALID_NAME);
   }
   else {
     TRACE_SIMPGMSPACE("f_unlink(%s) = OK", path.c_str());
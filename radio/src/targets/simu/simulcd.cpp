@@ -47,10 +47,18 @@ void lcdInit() {}
 
 void lcdRefresh()
 {
+  uint8_t pages = lcdGetChangedPages();
+  if (!pages)
+    return;
+
+  for (uint8_t page = 0; page < LCD_PAGES; page++) {
+    if (pages & (1 << page)) {
+      memcpy(&simuLcdBuf[page * LCD_PAGE_SIZE], &displayBuf[page * LCD_PAGE_SIZE], LCD_PAGE_SIZE * sizeof(pixel_t));
+    }
+  }
+
   // Mark screen dirty for async refresh
   simuLcdRefresh = true;
-
-  memcpy(simuLcdBuf, displayBuf, DISPLAY_BUFFER_SIZE * sizeof(pixel_t));
 }
 
 #else
@@ -43,6 +43,12 @@ void rotaryEncoderCheck();
 
 #define LUA_MEM_MAX                     (0)    // max allowed memory usage for complete Lua  (in bytes), 0 means unlimited
 
+#if defined(STM32F4)
+  #define LUA_CHUNK_CACHE_SIZE          (16 * 1024)  // RAM kept for compiled Lua chunks across model switches (in bytes), 0 means disabled
+#else
+  #define LUA_CHUNK_CACHE_SIZE          (0)
+#endif
+
 #if defined(STM32F4)
   #define PERI1_FREQUENCY               42000000
   #define PERI2_FREQUENCY               84000000
@@ -19,6 +19,7 @@
  */
 
 #include "opentx.h"
+#include "mixer_scheduler.h"
 #include "pulses/pulses.h"
 
 void intmoduleStop()
@@ -38,6 +39,8 @@ constexpr unsigned HEARBEAT_OFFSET = 6000;
 
 void intmoduleSendNextFrame()
 {
+  LATENCY_STAMP(LATENCY_TRANSMIT);
+
   switch (moduleState[INTERNAL_MODULE].protocol) {
 #if defined(PXX1)
     case PROTOCOL_CHANNELS_PXX1_PULSES:
@@ -153,6 +156,7 @@ void intmodulePpmStart()
 
 extern "C" void INTMODULE_DMA_STREAM_IRQHandler()
 {
+  DEBUG_INTERRUPT(INT_INTMODULE);
   if (!DMA_GetITStatus(INTMODULE_DMA_STREAM, INTMODULE_DMA_FLAG_TC))
     return;
 
@@ -168,8 +172,10 @@ extern "C" void INTMODULE_DMA_STREAM_IRQHandler()
 
 extern "C" void INTMODULE_TIMER_CC_IRQHandler()
 {
+  DEBUG_INTERRUPT(INT_INTMODULE);
   INTMODULE_TIMER->DIER &= ~TIM_DIER_CC2IE; // Stop this interrupt
   INTMODULE_TIMER->SR &= ~TIM_SR_CC2IF;
+  mixerSchedulerISRFrameBuild(INTERNAL_MODULE);
   if (setupPulsesInternalModule()) {
     intmoduleSendNextFrame();
   }
@@ -161,7 +161,12 @@ void lcdRefresh()
     lcdInitFinish();
   }
 
+  uint8_t pages = lcdGetChangedPages();
+
   for (uint8_t y=0; y<LCD_H; y++) {
+    if (!(pages & (1 << (y / 8))))
+      continue;
+
     uint8_t * p = &displayBuf[y/2 * LCD_W];
 
     lcdWriteAddress(0, y);
@@ -288,6 +293,7 @@ void lcdInitFinish()
   lcdStart();
   lcdWriteCommand(0xAF); // dc2=1, IC into exit SLEEP MODE, dc3=1 gray=ON, dc4=1 Green Enhanc mode disabled
   delay_ms(20); // Needed for internal DC-DC converter startup
+  lcdInvalidate(); // the controller RAM content is lost
 }
 
 void lcdSetRefVolt(uint8_t val)
@@ -196,9 +196,19 @@ void lcdRefresh(bool wait)
     lcdInitFinish();
   }
 
+  // Wait if previous DMA transfer still active
+  WAIT_FOR_DMA_END();
+
+  uint8_t pages = lcdGetChangedPages();
+  if (!pages)
+    return;
+
 #if LCD_W == 128
   uint8_t * p = displayBuf;
   for (uint8_t y=0; y < 8; y++, p+=LCD_W) {
+    if (!(pages & (1 << y)))
+      continue;
+
     lcdWriteCommand(0x10); // Column addr 0
     lcdWriteCommand(0xB0 | y); // Page addr y
 #if !defined(LCD_VERTICAL_INVERT)
@@ -221,22 +231,29 @@ void lcdRefresh(bool wait)
     LCD_A0_HIGH();
   }
 #else
-  // Wait if previous DMA transfer still active
-  WAIT_FOR_DMA_END();
   lcd_busy = true;
 
-  lcdWriteAddress(0, 0);
+  // Only one DMA transfer, from the first to the last changed page
+  uint8_t first = 0, last = LCD_PAGES - 1;
+  while (!(pages & (1 << first)))
+    first++;
+  while (!(pages & (1 << last)))
+    last--;
+
+  lcdWriteAddress(0, first * 4); // 4 RAM rows per page
 
   LCD_NCS_LOW();
   LCD_A0_HIGH();
 
   LCD_DMA_Stream->CR &= ~DMA_SxCR_EN; // Disable DMA
   LCD_DMA->HIFCR = LCD_DMA_FLAGS; // Write ones to clear bits
+  LCD_DMA_Stream->M0AR = (uint32_t)&displayBuf[first * LCD_PAGE_SIZE];
+  LCD_DMA_Stream->NDTR = (last - first + 1) * LCD_PAGE_SIZE;
 
 #if defined(LCD_DUAL_BUFFER)
-  // Switch LCD buffer
-  LCD_DMA_Stream->M0AR = (uint32_t)displayBuf;
+  // Switch LCD buffer, the pages of the other one need to be checked again
   displayBuf = (displayBuf == displayBuf1) ? displayBuf2 : displayBuf1;
+  lcdDirtyPages = 0xFF;
 #endif
 
   LCD_DMA_Stream->CR |= DMA_SxCR_EN | DMA_SxCR_TCIE; // Enable DMA & TC interrupts
@@ -349,6 +366,7 @@ void lcdInitFinish()
   lcdStart();
   lcdWriteCommand(0xAF); // dc2=1, IC into exit SLEEP MODE, dc3=1 gray=ON, dc4=1 Green Enhanc mode disabled
   delay_ms(20); // needed for internal DC-DC converter startup
+  lcdInvalidate(); // the controller RAM content is lost
 }
 
 void lcdSetRefVolt(uint8_t val)
@@ -97,6 +97,7 @@ void sendSynchronousPulses(uint8_t runMask)
 {
 #if defined(HARDWARE_INTERNAL_MODULE)
   if ((runMask & (1 << INTERNAL_MODULE)) && isModuleSynchronous(INTERNAL_MODULE)) {
+    mixerSchedulerFrameBuild(INTERNAL_MODULE);
     if (setupPulsesInternalModule())
       intmoduleSendNextFrame();
   }
@@ -104,6 +105,7 @@ void sendSynchronousPulses(uint8_t runMask)
 
 #if defined(HARDWARE_EXTERNAL_MODULE)
   if ((runMask & (1 << EXTERNAL_MODULE)) && isModuleSynchronous(EXTERNAL_MODULE)) {
+    mixerSchedulerFrameBuild(EXTERNAL_MODULE);
     if (setupPulsesExternalModule())
       extmoduleSendNextFrame();
   }
@@ -178,16 +180,18 @@ TASK_FUNCTION(mixerTask)
       uint16_t t0 = getTmr2MHz();
 
       DEBUG_TIMER_START(debugTimerMixer);
+      TRACE_TASK_EVENT(task_mixer_start, 0);
       RTOS_LOCK_MUTEX(mixerMutex);
 
       doMixerCalculations();
-      sendSynchronousPulses((1 << INTERNAL_MODULE) | (1 << EXTERNAL_MODULE));
+      sendSynchronousPulses(mixerSchedulerOutputsReady());
       doMixerPeriodicUpdates();
 
       DEBUG_TIMER_START(debugTimerMixerCalcToUsage);
       DEBUG_TIMER_SAMPLE(debugTimerMixerIterval);
       RTOS_UNLOCK_MUTEX(mixerMutex);
       DEBUG_TIMER_STOP(debugTimerMixer);
+      TRACE_TASK_EVENT(task_mixer_end, 0);
 
 #if defined(STM32) && !defined(SIMU)
       if (getSelectedUsbMode() == USB_JOYSTICK_MODE) {
@@ -240,6 +244,7 @@ TASK_FUNCTION(menusTask)
 #endif
     uint32_t start = (uint32_t)RTOS_GET_TIME();
     DEBUG_TIMER_START(debugTimerPerMain);
+    TRACE_TASK_EVENT(task_menus_start, 0);
 #if defined(COLORLCD) && defined(CLI)
     if (perMainEnabled) {
       perMain();
@@ -248,6 +253,7 @@ TASK_FUNCTION(menusTask)
     perMain();
 #endif
     DEBUG_TIMER_STOP(debugTimerPerMain);
+    TRACE_TASK_EVENT(task_menus_end, 0);
     // TODO remove completely massstorage from sky9x firmware
     uint32_t runtime = ((uint32_t)RTOS_GET_TIME() - start);
     // deduct the thread run-time from the wait, if run-time was more than
@@ -33,6 +33,13 @@
 #define AUDIO_STACK_SIZE       400
 #define CLI_STACK_SIZE         1000  // only consumed with CLI build option
 
+// tasks created by tasksStart(), with the idle task
+#if defined(CLI)
+  #define TASKS_COUNT          5
+#else
+  #define TASKS_COUNT          4
+#endif
+
 #if defined(FREE_RTOS)
 #define MIXER_TASK_PRIO        (tskIDLE_PRIORITY + 4)
 #define AUDIO_TASK_PRIO        (tskIDLE_PRIORITY + 2)
@@ -54,11 +61,15 @@ extern RTOS_DEFINE_STACK(mixerStack, MIXER_STACK_SIZE);
 extern RTOS_TASK_HANDLE audioTaskId;
 extern RTOS_DEFINE_STACK(audioStack, AUDIO_STACK_SIZE);
 
+extern RTOS_MUTEX_HANDLE audioMutex;
 extern RTOS_MUTEX_HANDLE mixerMutex;
 
 void stackPaint();
 void tasksStart();
 
+void execMixerFrequentActions();
+void sendSynchronousPulses(uint8_t runMask);
+
 extern volatile uint16_t timeForcePowerOffPressed;
 inline void resetForcePowerOffRequest()
 {
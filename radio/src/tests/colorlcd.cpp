@@ -18,6 +18,8 @@
  * GNU General Public License for more details.
  */
 
+#include <chrono>
+#include <functional>
 #include "gtests.h"
 
 #if defined(COLORLCD)
@@ -51,4 +53,56 @@ TEST(color, ARGB)
   EXPECT_EQ(ARGB(128, 30, 40, 150), (uint16_t)0x8129);
 }
 
+// per-glyph measure from the font specs, getTextWidth() used it before the packed widths table
+int getCharWidth(uint8_t c, const uint16_t * spec);
+
+TEST(color, getTextWidth)
+{
+  for (LcdFlags flags: {FONT(STD), FONT(XS), FONT(L)}) {
+    uint32_t fontindex = FONT_INDEX(flags);
+    const uint16_t * specs = fontspecsTable[fontindex];
+
+    char s[2] = { 0, 0 };
+    for (unsigned c = 0x20; c < 0xFE && c < fontCharactersTable[fontindex] + 0x20u; c++) {
+      s[0] = c;
+      EXPECT_EQ(getTextWidth(s, 0, flags), getCharWidth(c, specs)) << "char 0x" << std::hex << c;
+    }
+
+    int width = 0;
+    for (const char * c = "Hello World 123"; *c; c++) {
+      width += getCharWidth(*c, specs);
+    }
+    EXPECT_EQ(getTextWidth("Hello World 123", 0, flags), width);
+    EXPECT_EQ(getTextWidth("Hello World 123", 5, flags), getTextWidth("Hello", 0, flags));
+  }
+}
+
+// Host throughput only, the ratio between the widths table and the per-glyph measure is what matters
+TEST(color, getTextWidthThroughput)
+{
+  const char * label = "Model 01 - Telemetry RSSI 100dB";
+  const unsigned rounds = 100000;
+  const uint16_t * specs = fontspecsTable[FONT_INDEX(FONT(STD))];
+
+  auto megacharsPerSecond = [&](std::function<int(const char *)> measure) {
+    volatile int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned round = 0; round < rounds; round++) {
+      sink = sink + measure(label);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return double(rounds * strlen(label)) / (elapsed.count() + 1);
+  };
+
+  printf("getTextWidth: %.0fMchars/s, per glyph %.0fMchars/s\n",
+         megacharsPerSecond([](const char * s) { return int(getTextWidth(s, 0, FONT(STD))); }),
+         megacharsPerSecond([specs](const char * s) {
+           int width = 0;
+           for (; *s; s++) {
+             width += getCharWidth(*s, specs);
+           }
+           return width;
+         }));
+}
+
 #endif
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include <chrono>
+#include <functional>
+#include "gtests.h"
+
+// bit per bit reference implementations
+static uint16_t crc16Reference(uint16_t poly, const uint8_t * buf, uint32_t len, uint16_t crc)
+{
+  while (len--) {
+    crc ^= *buf++ << 8;
+    for (int i = 0; i < 8; i++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ poly : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+// the PXX CRC uses the reflected CCITT table with a MSB first update
+static uint16_t crc16PxxReference(const uint8_t * buf, uint32_t len, uint16_t crc)
+{
+  while (len--) {
+    uint16_t entry = (crc >> 8) ^ *buf++;
+    for (int i = 0; i < 8; i++) {
+      entry = (entry & 1) ? (entry >> 1) ^ 0x8408 : (entry >> 1);
+    }
+    crc = (crc << 8) ^ entry;
+  }
+  return crc;
+}
+
+static uint8_t crc8Reference(uint8_t poly, const uint8_t * buf, uint32_t len)
+{
+  uint8_t crc = 0;
+  while (len--) {
+    crc ^= *buf++;
+    for (int i = 0; i < 8; i++) {
+      crc = (crc & 0x80) ? (crc << 1) ^ poly : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+TEST(Crc, checkValues)
+{
+  const uint8_t * check = (const uint8_t *)"123456789";
+  EXPECT_EQ(crc16(CRC_1021, check, 9), 0x31C3);
+  EXPECT_EQ(crc16(CRC_1189, check, 9), 0x604A);
+  EXPECT_EQ(crc8(check, 9), 0xBC);
+  EXPECT_EQ(crc8_BA(check, 9), 0x20);
+}
+
+TEST(Crc, allLengthsAndAlignments)
+{
+  uint8_t buffer[300];
+  uint32_t seed = 0x12345678;
+  for (auto & byte: buffer) {
+    seed = seed * 1103515245 + 12345;
+    byte = seed >> 16;
+  }
+
+  for (uint32_t offset = 0; offset < 4; offset++) {
+    for (uint32_t len = 0; len + offset <= sizeof(buffer); len++) {
+      const uint8_t * buf = &buffer[offset];
+      uint16_t start = len * 0x0101;
+      ASSERT_EQ(crc16(CRC_1021, buf, len, start), crc16Reference(0x1021, buf, len, start)) << "len=" << len;
+      ASSERT_EQ(crc16(CRC_1189, buf, len, start), crc16PxxReference(buf, len, start)) << "len=" << len;
+      ASSERT_EQ(crc8(buf, len), crc8Reference(0xD5, buf, len)) << "len=" << len;
+      ASSERT_EQ(crc8_BA(buf, len), crc8Reference(0xBA, buf, len)) << "len=" << len;
+    }
+  }
+}
+
+TEST(Crc, byteUpdate)
+{
+  const uint8_t frame[] = { 0xC8, 0x18, 0x16, 0xE0, 0x03, 0x1F, 0x58, 0xC0 };
+  uint16_t crc = 0;
+  for (uint8_t byte: frame) {
+    crc = Crc16PXX::update(crc, byte);
+  }
+  EXPECT_EQ(crc, crc16(CRC_1189, frame, sizeof(frame)));
+}
+
+// Host throughput only, the ratio between the table and the bit per bit versions is what matters
+TEST(Crc, throughput)
+{
+  static uint8_t buffer[4096];
+  uint32_t seed = 0x12345678;
+  for (auto & byte: buffer) {
+    seed = seed * 1103515245 + 12345;
+    byte = seed >> 16;
+  }
+
+  const unsigned rounds = 200;
+  auto megabytesPerSecond = [&](std::function<uint32_t(const uint8_t *, uint32_t)> crc) {
+    volatile uint32_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned round = 0; round < rounds; round++) {
+      sink = sink + crc(buffer, sizeof(buffer));
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return double(rounds * sizeof(buffer)) / (elapsed.count() + 1);
+  };
+
+  printf("crc16: %.0fMB/s, bit per bit %.0fMB/s, %d table(s)\n",
+         megabytesPerSecond([](const uint8_t * buf, uint32_t len) { return uint32_t(crc16(CRC_1021, buf, len)); }),
+         megabytesPerSecond([](const uint8_t * buf, uint32_t len) { return uint32_t(crc16Reference(0x1021, buf, len, 0)); }),
+         CRC_SLICES);
+  printf("crc8: %.0fMB/s, bit per bit %.0fMB/s, %d table(s)\n",
+         megabytesPerSecond([](const uint8_t * buf, uint32_t len) { return uint32_t(crc8(buf, len)); }),
+         megabytesPerSecond([](const uint8_t * buf, uint32_t len) { return uint32_t(crc8Reference(0xD5, buf, len)); }),
+         CRC_SLICES);
+}
@@ -19,6 +19,7 @@
  */
 
 #include "gtests.h"
+#include "location.h"
 
 extern const char * eepromFile;
 
@@ -42,6 +43,260 @@ TEST(Storage, BackupAndRestore)
   if (memcmp(&ramBackupUncompressed, &ramBackupRestored, sizeof(ramBackupUncompressed)) != 0)
     TRACE("ERROR restore");
 }
+
+TEST(Storage, BackupDelta)
+{
+  MODEL_RESET();
+  rambackupWrite();
+  uint16_t snapshotSize = ramBackup->size;
+  EXPECT_GT(snapshotSize, 0);
+
+  // a trim change is only written as a delta
+  g_model.flightModeData[0].trim[0].value = 100;
+  g_model.timers[0].start = 60;
+  rambackupWrite();
+  uint16_t deltaSize = ramBackup->deltaSize;
+  EXPECT_EQ(snapshotSize, (uint16_t)ramBackup->size);
+  EXPECT_GT(deltaSize, 0);
+  EXPECT_LT(deltaSize, 16);
+
+  MODEL_RESET();
+  EXPECT_TRUE(rambackupRestore());
+  EXPECT_EQ((int)g_model.flightModeData[0].trim[0].value, 100);
+  EXPECT_EQ((int)g_model.timers[0].start, 60);
+}
+
+#if defined(SDCARD_RAW) && (defined(PCBX10) || defined(PCBX12S))
+// the snapshot and delta path on the models extracted from the bundled .otx files
+static void checkBackupOfBundledModel(const char * path)
+{
+  simuFatfsSetPaths(path, path);
+  EXPECT_EQ(loadRadioSettings("/RADIO/radio.bin"), nullptr);
+  EXPECT_EQ(loadModel("model1.bin", false), nullptr);
+  simuFatfsSetPaths("", "");
+
+  // a new snapshot
+  ramBackup->size = 0;
+  rambackupWrite();
+  uint16_t snapshotSize = ramBackup->size;
+  EXPECT_GT(snapshotSize, 0);
+  EXPECT_EQ((int)ramBackup->deltaSize, 0);
+  // about 400 bytes for 10KB of data
+  EXPECT_LT(snapshotSize * 16, sizeof(ramBackupUncompressed)) << path;
+
+  // trims and timers edits are written as delta records
+  g_model.flightModeData[0].trim[1].value = -25;
+  g_model.timers[0].value = 123;
+  rambackupWrite();
+  EXPECT_EQ(snapshotSize, (uint16_t)ramBackup->size);
+  EXPECT_GT((int)ramBackup->deltaSize, 0);
+  EXPECT_LT((int)ramBackup->deltaSize, 16);
+
+  Backup::RamBackupUncompressed ramBackupWritten;
+  memcpy(&ramBackupWritten, &ramBackupUncompressed, sizeof(ramBackupWritten));
+  memset(&ramBackupUncompressed, 0, sizeof(ramBackupUncompressed));
+  MODEL_RESET();
+  EXPECT_TRUE(rambackupRestore());
+  EXPECT_EQ(memcmp(&ramBackupWritten, &ramBackupUncompressed, sizeof(ramBackupWritten)), 0);
+  EXPECT_EQ((int)g_model.flightModeData[0].trim[1].value, -25);
+  EXPECT_EQ((int)g_model.timers[0].value, 123);
+}
+
+TEST(Storage, BackupBundledModels)
+{
+  checkBackupOfBundledModel(TESTS_BUILD_PATH "/model_22_x10/");
+  checkBackupOfBundledModel(TESTS_BUILD_PATH "/model_22_x12s/");
+  MODEL_RESET();
+}
+#endif
+#endif
+
+#if defined(SDCARD)
+#define TEST_TMP_FILE_PATH  "/tmptest.txt"
+
+static void writeTestFile(const char * path, const char * content)
+{
+  FIL file;
+  UINT written;
+  EXPECT_EQ(openTempFile(path, &file), nullptr);
+  EXPECT_EQ(f_write(&file, content, strlen(content), &written), FR_OK);
+  EXPECT_EQ(commitTempFile(path, &file), nullptr);
+}
+
+// a file as left by a power loss, with the completion trailer of commitTempFile() or without
+static void writeRawFile(const char * path, const char * content, bool complete)
+{
+  FIL file;
+  UINT written;
+  EXPECT_EQ(f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE), FR_OK);
+  EXPECT_EQ(f_write(&file, content, strlen(content), &written), FR_OK);
+  if (complete) {
+    uint32_t trailer[2] = { 0x444E4545 /* "EEND" */, (uint32_t)strlen(content) };
+    EXPECT_EQ(f_write(&file, trailer, sizeof(trailer), &written), FR_OK);
+  }
+  f_close(&file);
+}
+
+// the whole file, which must not carry anything else than the content
+static std::string readTestFile(const char * path)
+{
+  FIL file;
+  char buffer[32];
+  UINT read = 0;
+  if (f_open(&file, path, FA_OPEN_EXISTING | FA_READ) != FR_OK) {
+    return "";
+  }
+  f_read(&file, buffer, sizeof(buffer), &read);
+  f_close(&file);
+  return std::string(buffer, read);
+}
+
+TEST(Storage, TempFileRecovery)
+{
+  char tmpPath[256];
+  FILINFO info;
+
+  simuFatfsSetPaths(TESTS_BUILD_PATH, TESTS_BUILD_PATH);
+  strAppend(strAppend(tmpPath, TEST_TMP_FILE_PATH), TMP_FILE_EXT);
+  f_unlink(TEST_TMP_FILE_PATH);
+  f_unlink(tmpPath);
+
+  writeTestFile(TEST_TMP_FILE_PATH, "first");
+  EXPECT_EQ(readTestFile(TEST_TMP_FILE_PATH), "first");
+  EXPECT_NE(f_stat(tmpPath, &info), FR_OK);
+
+  // nothing to recover: the file is left as it is
+  recoverTempFile(TEST_TMP_FILE_PATH);
+  EXPECT_EQ(readTestFile(TEST_TMP_FILE_PATH), "first");
+
+  // power lost after the rename: the trailer is removed
+  writeRawFile(TEST_TMP_FILE_PATH, "second", true);
+  recoverTempFile(TEST_TMP_FILE_PATH);
+  EXPECT_EQ(readTestFile(TEST_TMP_FILE_PATH), "second");
+
+  // power lost between the deletion of the old file and the rename: the temp file is complete
+  f_unlink(TEST_TMP_FILE_PATH);
+  writeRawFile(tmpPath, "third", true);
+  recoverTempFile(TEST_TMP_FILE_PATH);
+  EXPECT_EQ(readTestFile(TEST_TMP_FILE_PATH), "third");
+  EXPECT_NE(f_stat(tmpPath, &info), FR_OK);
+
+  // power lost before the deletion of the old file: the complete temp file is newer
+  writeRawFile(tmpPath, "fourth", true);
+  recoverTempFile(TEST_TMP_FILE_PATH);
+  EXPECT_EQ(readTestFile(TEST_TMP_FILE_PATH), "fourth");
+  EXPECT_NE(f_stat(tmpPath, &info), FR_OK);
+
+  // power lost while writing the temp file: the old file is kept
+  writeRawFile(tmpPath, "partial", false);
+  recoverTempFile(TEST_TMP_FILE_PATH);
+  EXPECT_EQ(readTestFile(TEST_TMP_FILE_PATH), "fourth");
+  EXPECT_NE(f_stat(tmpPath, &info), FR_OK);
+
+  // power lost while writing the first version of a file: nothing is restored
+  f_unlink(TEST_TMP_FILE_PATH);
+  writeRawFile(tmpPath, "partial", false);
+  recoverTempFile(TEST_TMP_FILE_PATH);
+  EXPECT_NE(f_stat(TEST_TMP_FILE_PATH, &info), FR_OK);
+  EXPECT_NE(f_stat(tmpPath, &info), FR_OK);
+
+  // back to the default SD card paths
+  simuFatfsSetPaths("", "");
+}
+#endif
+
+#if defined(SDCARD_RAW)
+static FSIZE_t getTestFileSize(const char * path)
+{
+  FILINFO info;
+  return f_stat(path, &info) == FR_OK ? info.fsize : 0;
+}
+
+static void readTestModel()
+{
+  uint8_t version;
+  MODEL_RESET();
+  EXPECT_EQ(readModel(g_eeGeneral.currModelFilename, (uint8_t *)&g_model, sizeof(g_model), &version), nullptr);
+}
+
+TEST(Storage, ModelJournal)
+{
+  char path[256];
+  FILINFO info;
+
+  simuFatfsSetPaths(TESTS_BUILD_PATH, TESTS_BUILD_PATH);
+  sdCheckAndCreateDirectory(MODELS_PATH);
+  strcpy(g_eeGeneral.currModelFilename, "tmptest.bin");
+  getModelPath(path, g_eeGeneral.currModelFilename);
+  f_unlink(path);
+
+  // a new file is completely written
+  MODEL_RESET();
+  g_model.flightModeData[0].trim[0].value = 100;
+  EXPECT_EQ(writeModel(), nullptr);
+  EXPECT_EQ(getTestFileSize(path), 8 + sizeof(g_model));
+
+  // 2000-01-01 00:00:00
+  FILINFO old;
+  old.fdate = (20 << 9) | (1 << 5) | 1;
+  old.ftime = 0;
+  EXPECT_EQ(f_utime(path, &old), FR_OK);
+
+  // same content: the file is neither read nor written
+  EXPECT_EQ(writeModel(), nullptr);
+  EXPECT_EQ(f_stat(path, &info), FR_OK);
+  EXPECT_EQ(info.fdate, old.fdate);
+
+  // a trim change only appends its section
+  g_model.flightModeData[0].trim[0].value = 101;
+  EXPECT_EQ(writeModel(), nullptr);
+  FSIZE_t size = getTestFileSize(path);
+  EXPECT_GT(size, 8 + sizeof(g_model));
+  EXPECT_LE(size, 8 + sizeof(g_model) + 2 * (8 + 64));
+  readTestModel();
+  EXPECT_EQ((int)g_model.flightModeData[0].trim[0].value, 101);
+
+  // the file is rewritten once the journal is full
+  bool rewritten = false;
+  for (int i = 0; i < 100; i++) {
+    g_model.flightModeData[0].trim[0].value = i;
+    g_model.timers[0].value = 2 * i;
+    EXPECT_EQ(writeModel(), nullptr);
+    FSIZE_t newSize = getTestFileSize(path);
+    rewritten |= (newSize < size);
+    size = newSize;
+  }
+  EXPECT_TRUE(rewritten);
+  readTestModel();
+  EXPECT_EQ((int)g_model.flightModeData[0].trim[0].value, 99);
+  EXPECT_EQ((int)g_model.timers[0].value, 198);
+
+  // a record not completely written when the power was lost is ignored, the next save rewrites the file
+  FIL file;
+  UINT written;
+  const uint8_t partial[] = { 0x10, 0x00, 0x40, 0x00, 0x12 };
+  EXPECT_EQ(f_open(&file, path, FA_OPEN_EXISTING | FA_WRITE), FR_OK);
+  EXPECT_EQ(f_lseek(&file, f_size(&file)), FR_OK);
+  EXPECT_EQ(f_write(&file, partial, sizeof(partial), &written), FR_OK);
+  f_close(&file);
+  readTestModel();
+  EXPECT_EQ((int)g_model.flightModeData[0].trim[0].value, 99);
+  g_model.flightModeData[0].trim[0].value = 50;
+  EXPECT_EQ(writeModel(), nullptr);
+  EXPECT_EQ(getTestFileSize(path), 8 + sizeof(g_model));
+  readTestModel();
+  EXPECT_EQ((int)g_model.flightModeData[0].trim[0].value, 50);
+
+  // a shorter file (older firmware) is never taken as the model content
+  EXPECT_EQ(writeFile(path, (uint8_t *)&g_model, sizeof(g_model) - 1), nullptr);
+  readTestModel();
+  g_model.flightModeData[0].trim[0].value = 50;
+  EXPECT_EQ(writeModel(), nullptr);
+  EXPECT_EQ(getTestFileSize(path), 8 + sizeof(g_model));
+
+  f_unlink(path);
+  simuFatfsSetPaths("", "");
+}
 #endif
 
 #if defined(EEPROM_RLC)
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+#include "location.h"
+
+#if defined(PCBFRSKY) || defined(PCBNV14)
+
+#include "io/frsky_firmware_update.h"
+
+#define TEST_FIRMWARE_SIZE   (3 * 1024 + 12)
+
+static void testProgressHandler(const char *, const char *, int, int)
+{
+}
+
+class FirmwareUpdateTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+      for (unsigned i = 0; i < sizeof(firmware); i++) {
+        firmware[i] = i * 7 + (i >> 8);
+      }
+      FILE * f = fopen(TESTS_BUILD_PATH "/firmware.bin", "wb");
+      ASSERT_NE(nullptr, f);
+      ASSERT_EQ(1u, fwrite(firmware, sizeof(firmware), 1, f));
+      fclose(f);
+      simuSetVirtualClock(true);
+    }
+
+    void TearDown() override
+    {
+      simuSetVirtualClock(false);
+      simuDeviceReset();
+    }
+
+    const char * flash(const SimuDeviceOptions & options)
+    {
+      simuDeviceReset(options);
+      return FrskyDeviceFirmwareUpdate(SPORT_MODULE).flashFirmware(TESTS_BUILD_PATH "/firmware.bin", testProgressHandler);
+    }
+
+    uint8_t firmware[TEST_FIRMWARE_SIZE];
+};
+
+TEST_F(FirmwareUpdateTest, upload)
+{
+  EXPECT_EQ(nullptr, flash(SimuDeviceOptions()));
+
+  uint32_t size;
+  const uint8_t * image = simuDeviceGetImage(size);
+  ASSERT_EQ((uint32_t)TEST_FIRMWARE_SIZE, size);
+  EXPECT_EQ(0, memcmp(firmware, image, size));
+
+  const SimuDeviceStats & stats = simuDeviceGetStats();
+  EXPECT_EQ(0u, stats.badFrames);
+  EXPECT_EQ((uint32_t)TEST_FIRMWARE_SIZE / 4, stats.words);
+
+  // one word per request / answer exchange, no polling delay in between
+  SimuDeviceOptions options;
+  uint64_t exchange = 2 * 12 * options.byteTime + options.latency;
+  EXPECT_LT(stats.downloadEnd - stats.downloadStart, stats.words * (exchange + 500));
+}
+
+TEST_F(FirmwareUpdateTest, deviceStalls)
+{
+  SimuDeviceOptions options;
+  options.stallAfter = 100;
+  EXPECT_STREQ("Data refused", flash(options));
+  EXPECT_EQ(100u, simuDeviceGetStats().words);
+}
+
+TEST_F(FirmwareUpdateTest, imageRejected)
+{
+  SimuDeviceOptions options;
+  options.rejectImage = true;
+  EXPECT_STREQ("Firmware rejected", flash(options));
+}
+
+TEST_F(FirmwareUpdateTest, deviceAbsent)
+{
+  SimuDeviceOptions options;
+  options.absent = true;
+  EXPECT_NE(nullptr, flash(options));
+  EXPECT_EQ(0u, simuDeviceGetStats().requests);
+}
+
+#endif
@@ -38,6 +38,7 @@ TEST_F(SpecialFunctionsTest, FlightReset)
   g_model.customFn[0].func = FUNC_RESET;
   g_model.customFn[0].all.val = FUNC_RESET_FLIGHT;
   g_model.customFn[0].active = true;
+  storageDirty(EE_MODEL);
 
   mainRequestFlags = 0;
   simuSetSwitch(0, 0);
@@ -68,6 +69,7 @@ TEST_F(SpecialFunctionsTest, GvarsInc)
   g_model.customFn[0].all.param = 0; // GV1
   g_model.customFn[0].all.val = -1;   // inc/dec value
   g_model.customFn[0].active = true;
+  storageDirty(EE_MODEL);
 
   g_model.flightModeData[0].gvars[0] = 10;  // GV1 = 10;
   evalFunctions(g_model.customFn, modelFunctionsContext);
@@ -114,5 +116,112 @@ TEST_F(SpecialFunctionsTest, GvarsInc)
 }
 #endif // #if defined(GVARS)
 
+
+TEST_F(SpecialFunctionsTest, EntriesList)
+{
+  g_model.customFn[3].swtch = SWSRC_ON;
+  g_model.customFn[3].func = FUNC_BACKLIGHT;
+  g_model.customFn[3].active = true;
+  g_model.customFn[10].swtch = SWSRC_SA0;
+  g_model.customFn[10].func = FUNC_BACKLIGHT;
+  g_model.customFn[10].active = false;
+  storageDirty(EE_MODEL);
+
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(modelFunctionsContext.entriesCount, 1);
+  EXPECT_EQ(modelFunctionsContext.entries[0], 3);
+  EXPECT_TRUE(modelFunctionsContext.isFunctionActive(FUNCTION_BACKLIGHT));
+
+  // an entry disabled while active gets a last inactive pass
+  g_model.customFn[3].active = false;
+  storageDirty(EE_MODEL);
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(modelFunctionsContext.entriesCount, 1);
+  EXPECT_FALSE(modelFunctionsContext.isFunctionActive(FUNCTION_BACKLIGHT));
+  EXPECT_EQ(modelFunctionsContext.activeSwitches, 0u);
+
+  // then leaves the list at the next edit
+  g_model.customFn[10].active = true;
+  storageDirty(EE_MODEL);
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(modelFunctionsContext.entriesCount, 1);
+  EXPECT_EQ(modelFunctionsContext.entries[0], 10);
+
+  // a new model starts with a fresh list
+  memclear(g_model.customFn, sizeof(g_model.customFn));
+  customFunctionsReset();
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(modelFunctionsContext.entriesCount, 0);
+}
+
+#if defined(SDCARD)
+TEST_F(SpecialFunctionsTest, PlayOnEdgeAndRepeat)
+{
+  memclear(&modelFunctionsContext, sizeof(modelFunctionsContext));
+  g_tmr10ms = 1000;
+  g_model.customFn[0].swtch = SWSRC_SA0;
+  g_model.customFn[0].func = FUNC_PLAY_SOUND;
+  g_model.customFn[0].all.val = 0;
+  g_model.customFn[0].active = 2;  // repeat every 2s
+  storageDirty(EE_MODEL);
+
+  simuSetSwitch(0, 0);
+  getSwitchesPosition(true);
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(modelFunctionsContext.lastFunctionTime[0], 0u);
+
+  // played on the switch edge
+  simuSetSwitch(0, -1);
+  getSwitchesPosition(true);  // no mid position delay
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(modelFunctionsContext.lastFunctionTime[0], 1000u);
+  EXPECT_TRUE(modelFunctionsContext.activeSwitches & 1);
+
+  // then only at the repeat deadline
+  g_tmr10ms += 199;
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(modelFunctionsContext.lastFunctionTime[0], 1000u);
+  EXPECT_TRUE(modelFunctionsContext.activeSwitches & 1);
+  g_tmr10ms += 1;
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(modelFunctionsContext.lastFunctionTime[0], 1200u);
+
+  // the next edge plays it again
+  simuSetSwitch(0, 0);
+  getSwitchesPosition(true);
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(modelFunctionsContext.lastFunctionTime[0], 0u);
+  EXPECT_FALSE(modelFunctionsContext.activeSwitches & 1);
+  g_tmr10ms += 1;
+  simuSetSwitch(0, -1);
+  getSwitchesPosition(true);
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(modelFunctionsContext.lastFunctionTime[0], 1201u);
+}
+#endif
+
+TEST_F(SpecialFunctionsTest, EntriesListAfterLoad)
+{
+  evalFunctions(g_eeGeneral.customFn, globalFunctionsContext);
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(globalFunctionsContext.entriesCount, 0);
+  EXPECT_EQ(modelFunctionsContext.entriesCount, 0);
+
+  // loaded data does not go through storageDirty()
+  g_eeGeneral.customFn[5].swtch = SWSRC_ON;
+  g_eeGeneral.customFn[5].func = FUNC_BACKLIGHT;
+  g_eeGeneral.customFn[5].active = true;
+  g_model.customFn[7].swtch = SWSRC_ON;
+  g_model.customFn[7].func = FUNC_BACKLIGHT;
+  g_model.customFn[7].active = true;
+  postRadioSettingsLoad();
+
+  evalFunctions(g_eeGeneral.customFn, globalFunctionsContext);
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+  EXPECT_EQ(globalFunctionsContext.entriesCount, 1);
+  EXPECT_EQ(globalFunctionsContext.entries[0], 5);
+  EXPECT_EQ(modelFunctionsContext.entriesCount, 1);
+  EXPECT_EQ(modelFunctionsContext.entries[0], 7);
+}
 #endif // #if defined(PCBFRSKY)
 
@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <chrono>
+#include <functional>
+#include "gtests.h"
+
+#if defined(INTERNAL_GPS)
+static void gpsFeed(const uint8_t * data, uint32_t len)
+{
+  while (len--) {
+    gpsNewData(*data++);
+  }
+}
+
+static void gpsFeed(const char * frame)
+{
+  gpsFeed((const uint8_t *)frame, strlen(frame));
+}
+
+// UBX frame with the checksum computed over class, id, length and payload
+static uint32_t gpsBuildUBX(uint8_t * frame, uint8_t msgClass, uint8_t msgId, const uint8_t * payload, uint16_t length)
+{
+  uint32_t size = 0;
+  frame[size++] = 0xB5;
+  frame[size++] = 0x62;
+  frame[size++] = msgClass;
+  frame[size++] = msgId;
+  frame[size++] = length;
+  frame[size++] = length >> 8;
+  memcpy(&frame[size], payload, length);
+  size += length;
+  uint8_t checksumA = 0, checksumB = 0;
+  for (uint32_t i = 2; i < size; i++) {
+    checksumA += frame[i];
+    checksumB += checksumA;
+  }
+  frame[size++] = checksumA;
+  frame[size++] = checksumB;
+  return size;
+}
+
+// minimal NAV-PVT frame, 100 bytes
+static uint32_t gpsBuildNavPvt(uint8_t * frame, uint8_t fixType, int32_t lat, int32_t lon)
+{
+  uint8_t payload[92] = { 0 };
+  payload[20] = fixType;
+  payload[21] = (fixType >= 2 ? 1 : 0); // gnssFixOK
+  payload[23] = 6;  // numSV
+  memcpy(&payload[24], &lon, sizeof(lon));
+  memcpy(&payload[28], &lat, sizeof(lat));
+  return gpsBuildUBX(frame, 0x01, 0x07, payload, sizeof(payload));
+}
+
+// back to NMEA parsing after the UBX frames timeout
+static void gpsUbxTimeout()
+{
+  g_tmr10ms += 301;
+  gpsWakeup();
+}
+
+TEST(Gps, nmeaGGA)
+{
+  memset(&gpsData, 0, sizeof(gpsData));
+  gpsFeed("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n");
+  EXPECT_EQ(gpsData.packetCount, 1u);
+  EXPECT_EQ(gpsData.errorCount, 0u);
+  EXPECT_EQ(gpsData.fix, 1);
+  EXPECT_EQ(gpsData.numSat, 8);
+  EXPECT_EQ(gpsData.latitude, 48117300);
+  EXPECT_EQ(gpsData.longitude, 11516666);
+  EXPECT_EQ(gpsData.altitude, 545);
+  EXPECT_EQ(gpsData.hdop, 90);
+
+  // wrong checksum
+  gpsFeed("$GPGGA,123519,4907.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*48\r\n");
+  EXPECT_EQ(gpsData.errorCount, 1u);
+  EXPECT_EQ(gpsData.latitude, 48117300);
+}
+
+TEST(Gps, ubxNavPvt)
+{
+  uint8_t payload[92] = { 0 };
+  int32_t lon = 115166660, lat = -481173000, hMSL = 545400, gSpeed = 6430, headMot = 12345678;
+  uint16_t pDOP = 120, hDOP = 85;
+  payload[20] = 3;  // 3D fix
+  payload[21] = 1;  // gnssFixOK
+  payload[23] = 12; // numSV
+  memcpy(&payload[24], &lon, sizeof(lon));
+  memcpy(&payload[28], &lat, sizeof(lat));
+  memcpy(&payload[36], &hMSL, sizeof(hMSL));
+  memcpy(&payload[60], &gSpeed, sizeof(gSpeed));
+  memcpy(&payload[64], &headMot, sizeof(headMot));
+  memcpy(&payload[76], &pDOP, sizeof(pDOP));
+
+  uint8_t frame[100];
+  uint32_t size = gpsBuildUBX(frame, 0x01, 0x07, payload, sizeof(payload));
+
+  memset(&gpsData, 0, sizeof(gpsData));
+  gpsFeed("$GPGGA,1235"); // truncated NMEA sentence
+  gpsFeed(frame, size);
+  EXPECT_EQ(gpsData.packetCount, 1u);
+  EXPECT_EQ(gpsData.errorCount, 0u);
+  EXPECT_EQ(gpsData.fix, 1);
+  EXPECT_EQ(gpsData.numSat, 12);
+  EXPECT_EQ(gpsData.latitude, -48117300);
+  EXPECT_EQ(gpsData.longitude, 11516666);
+  EXPECT_EQ(gpsData.altitude, 545);
+  EXPECT_EQ(gpsData.speed, 643);
+  EXPECT_EQ(gpsData.groundCourse, 1234);
+  EXPECT_EQ(gpsData.hdop, 0);
+
+  // HDOP comes from NAV-DOP frames
+  uint8_t dopPayload[18] = { 0 };
+  memcpy(&dopPayload[6], &pDOP, sizeof(pDOP));
+  memcpy(&dopPayload[12], &hDOP, sizeof(hDOP));
+  uint8_t dopFrame[26];
+  gpsFeed(dopFrame, gpsBuildUBX(dopFrame, 0x01, 0x04, dopPayload, sizeof(dopPayload)));
+  EXPECT_EQ(gpsData.packetCount, 2u);
+  EXPECT_EQ(gpsData.hdop, 85);
+
+  // wrong checksum
+  frame[size - 1] ^= 0xFF;
+  gpsFeed(frame, size);
+  EXPECT_EQ(gpsData.errorCount, 1u);
+  EXPECT_EQ(gpsData.numSat, 12);
+
+  // NMEA data is ignored once NAV-PVT frames are received
+  gpsFeed("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n");
+  EXPECT_EQ(gpsData.latitude, -48117300);
+
+  // and parsed again when they stop
+  g_tmr10ms += 301;
+  gpsWakeup();
+  EXPECT_EQ(gpsData.fix, 0);
+  gpsFeed("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n");
+  EXPECT_EQ(gpsData.fix, 1);
+  EXPECT_EQ(gpsData.latitude, 48117300);
+  EXPECT_EQ(gpsData.hdop, 90);
+}
+
+TEST(Gps, nmeaCorpus)
+{
+  memset(&gpsData, 0, sizeof(gpsData));
+
+  // other talkers, western hemisphere
+  gpsFeed("$GNGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*68\r\n");
+  EXPECT_EQ(gpsData.fix, 1);
+  EXPECT_EQ(gpsData.numSat, 8);
+  EXPECT_EQ(gpsData.latitude, 53361336);
+  EXPECT_EQ(gpsData.longitude, -6505620);
+  EXPECT_EQ(gpsData.altitude, 61);
+  EXPECT_EQ(gpsData.hdop, 100);
+
+  // southern hemisphere, DGPS fix
+  gpsFeed("$GLGGA,235959,3351.000,S,15112.500,E,2,11,1.5,12.0,M,20.0,M,,*73\r\n");
+  EXPECT_EQ(gpsData.fix, 1);
+  EXPECT_EQ(gpsData.numSat, 11);
+  EXPECT_EQ(gpsData.latitude, -33850000);
+  EXPECT_EQ(gpsData.longitude, 151208333);
+  EXPECT_EQ(gpsData.altitude, 12);
+  EXPECT_EQ(gpsData.hdop, 150);
+
+  // fix lost: the last position is kept
+  gpsFeed("$GPGGA,,,,,,0,00,99.99,,,,,,*48\r\n");
+  EXPECT_EQ(gpsData.fix, 0);
+  EXPECT_EQ(gpsData.numSat, 0);
+  EXPECT_EQ(gpsData.latitude, -33850000);
+  EXPECT_EQ(gpsData.hdop, 9990);
+
+  // speed and course
+  gpsFeed("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n");
+  EXPECT_EQ(gpsData.speed, 1152);
+  EXPECT_EQ(gpsData.groundCourse, 844);
+
+  // other sentences are counted, not decoded
+  gpsFeed("$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74\r\n");
+  EXPECT_EQ(gpsData.packetCount, 5u);
+  EXPECT_EQ(gpsData.errorCount, 0u);
+
+  // line noise and an overlong field before a good sentence
+  gpsFeed("\x01\x7F garbage,,,**\r\n$GPGGA,123519,48070380000000000000000,N\r\n");
+  gpsFeed("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n");
+  EXPECT_EQ(gpsData.fix, 1);
+  EXPECT_EQ(gpsData.latitude, 48117300);
+  EXPECT_EQ(gpsData.longitude, 11516666);
+}
+
+TEST(Gps, ubxCorpus)
+{
+  uint8_t frame[100];
+  memset(&gpsData, 0, sizeof(gpsData));
+
+  // no fix: the position isn't updated
+  gpsFeed(frame, gpsBuildNavPvt(frame, 0, 10000000, 20000000));
+  EXPECT_EQ(gpsData.packetCount, 1u);
+  EXPECT_EQ(gpsData.fix, 0);
+  EXPECT_EQ(gpsData.numSat, 6);
+  EXPECT_EQ(gpsData.latitude, 0);
+
+  // 2D fix
+  gpsFeed(frame, gpsBuildNavPvt(frame, 2, 10000000, 20000000));
+  EXPECT_EQ(gpsData.fix, 1);
+  EXPECT_EQ(gpsData.latitude, 1000000);
+  EXPECT_EQ(gpsData.longitude, 2000000);
+
+  // a frame longer than the parser buffer is dropped right after its header
+  const uint8_t oversized[] = { 0xB5, 0x62, 0x01, 0x35, 0xFF, 0xFF };
+  gpsFeed(oversized, sizeof(oversized));
+  gpsFeed(frame, gpsBuildNavPvt(frame, 3, -10000000, -20000000));
+  EXPECT_EQ(gpsData.packetCount, 3u);
+  EXPECT_EQ(gpsData.latitude, -1000000);
+  EXPECT_EQ(gpsData.longitude, -2000000);
+
+  // NAV-DOP with a wrong length is counted but not decoded
+  uint8_t dopPayload[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 55, 0 };
+  uint8_t dopFrame[24];
+  gpsFeed(dopFrame, gpsBuildUBX(dopFrame, 0x01, 0x04, dopPayload, sizeof(dopPayload)));
+  EXPECT_EQ(gpsData.packetCount, 4u);
+  EXPECT_EQ(gpsData.hdop, 0);
+
+  // a frame cut in the middle makes the next one fail, then the parser resyncs
+  uint32_t size = gpsBuildNavPvt(frame, 3, 30000000, 40000000);
+  gpsFeed(frame, size / 2);
+  gpsFeed(frame, size);
+  EXPECT_EQ(gpsData.errorCount, 1u);
+  EXPECT_EQ(gpsData.latitude, -1000000);
+  gpsFeed(frame, size);
+  EXPECT_EQ(gpsData.errorCount, 1u);
+  EXPECT_EQ(gpsData.latitude, 3000000);
+
+  gpsUbxTimeout();
+}
+
+// Host throughput only, NMEA GGA + RMC sentences against NAV-PVT frames
+TEST(Gps, parseThroughput)
+{
+  static uint8_t nmea[4096], ubxFrames[4096];
+  const char * sentences =
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"
+    "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+  uint32_t nmeaSize = 0, ubxSize = 0;
+  while (nmeaSize + strlen(sentences) <= sizeof(nmea)) {
+    memcpy(&nmea[nmeaSize], sentences, strlen(sentences));
+    nmeaSize += strlen(sentences);
+  }
+  while (ubxSize + 100 <= sizeof(ubxFrames)) {
+    ubxSize += gpsBuildNavPvt(&ubxFrames[ubxSize], 3, 481173000, 115166660);
+  }
+
+  const unsigned rounds = 200;
+  auto megabytesPerSecond = [&](std::function<void()> parse, uint32_t size) {
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned round = 0; round < rounds; round++) {
+      parse();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return double(rounds * size) / (elapsed.count() + 1);
+  };
+
+  memset(&gpsData, 0, sizeof(gpsData));
+  double nmeaThroughput = megabytesPerSecond([&]() { gpsFeed(nmea, nmeaSize); }, nmeaSize);
+  double ubxThroughput = megabytesPerSecond([&]() { gpsFeed(ubxFrames, ubxSize); }, ubxSize);
+  EXPECT_EQ(gpsData.errorCount, 0u);
+  printf("gps: NMEA %.1fMB/s, UBX %.1fMB/s\n", nmeaThroughput, ubxThroughput);
+
+  gpsUbxTimeout();
+}
+#endif
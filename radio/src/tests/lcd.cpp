@@ -472,4 +472,26 @@ TEST(Lcd, lcdDrawLine)
   EXPECT_TRUE(checkScreenshot("lcdDrawLine"));
 }
 #endif
+
+TEST(Lcd, ChangedPages)
+{
+  lcdClear();
+  lcdDrawText(0, 0, "TEST");
+  lcdRefresh();
+
+  // same content drawn again
+  lcdClear();
+  lcdDrawText(0, 0, "TEST");
+  EXPECT_EQ(lcdGetChangedPages(), 0);
+
+  lcdDrawSolidFilledRect(10, 20, 10, 10);
+  EXPECT_EQ(lcdGetChangedPages(), (1 << 2) | (1 << 3));
+  EXPECT_EQ(lcdGetChangedPages(), 0);
+
+  lcdDrawPoint(100, 60);
+  EXPECT_EQ(lcdGetChangedPages(), 1 << 7);
+
+  lcdInvalidate();
+  EXPECT_EQ(lcdGetChangedPages(), 0xFF);
+}
 #endif
@@ -19,6 +19,7 @@
  */
 
 #include <math.h>
+#include <chrono>
 #include "gtests.h"
 
 #if defined(LUA)
@@ -103,6 +104,76 @@ TEST(Lua, testPanicProtection)
   EXPECT_EQ(passed, true);
 }
 
+TEST(Lua, testGetValues)
+{
+  MODEL_RESET();
+  ex_chans[0] = 512;
+  ex_chans[1] = -256;
+  luaExecStr("sources = getSourceHandle({'ch1', 'ch2', getFieldInfo('ch3').id, 'unknown'})");
+  luaExecStr("values = {}");
+  luaExecStr("mins = {}");
+  luaExecStr("if getValues(sources, values, mins) ~= values then error('getValues() result') end");
+  luaExecStr("for i = 1, 3 do if values[i] ~= getValue('ch'..i) then error('getValues() ch'..i) end end");
+  luaExecStr("if values[1] ~= 512 or values[2] ~= -256 or values[4] ~= 0 then error('getValues() values') end");
+  luaExecStr("if #mins ~= 0 then error('getValues() mins') end");
+
+  // the tables are filled in place
+  ex_chans[0] = -1024;
+  luaExecStr("getValues(sources, values)");
+  luaExecStr("if values[1] ~= -1024 then error('getValues() refresh') end");
+  ex_chans[0] = 0;
+  ex_chans[1] = 0;
+}
+
+TEST(Lua, testGetValuesTelemetry)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  telemetryStreaming = TELEMETRY_TIMEOUT10ms;
+  telemetryData.telemetryValid = 0x07;
+  allowNewSensors = true;
+
+  processHubPacket(VFAS_ID, 1234);  // 123.4V
+  processHubPacket(VFAS_ID, 1000);  // 100.0V
+  processHubPacket(VFAS_ID, 1100);  // 110.0V
+
+  luaExecStr("sources = getSourceHandle({'VFAS', 'ch1'})");
+  luaExecStr("values, mins, maxs, delays = {}, {}, {}, {}");
+  luaExecStr("getValues(sources, values, mins, maxs, delays)");
+  luaExecStr("if values[1] ~= getValue('VFAS') or mins[1] ~= getValue('VFAS-') or maxs[1] ~= getValue('VFAS+') then error('getValues() telemetry') end");
+  luaExecStr("if math.abs(values[1] - 110) > 0.001 or math.abs(mins[1] - 100) > 0.001 or math.abs(maxs[1] - 123.4) > 0.001 then error('getValues() min/max') end");
+  luaExecStr("if delays[1] ~= 0 then error('getValues() delay') end");
+  luaExecStr("if mins[2] ~= nil or maxs[2] ~= nil or delays[2] ~= nil then error('getValues() not telemetry') end");
+
+  // the handle length is stored on 16 bits
+  EXPECT_FALSE(__luaExecStr("getSourceHandle(setmetatable({}, {__len = function() return 65536 end}))"));
+
+  telemetryStreaming = 0;
+  allowNewSensors = false;
+}
+
+// Host throughput only, the ratio between the two ways of reading the sources is what matters
+TEST(Lua, getValuesThroughput)
+{
+  MODEL_RESET();
+  luaExecStr("names = {} for i = 1, 16 do names[i] = 'ch'..i end");
+  luaExecStr("sources = getSourceHandle(names) values = {}");
+
+  const unsigned cycles = 5000;
+  auto cyclesPerSecond = [&](const char * cycle) {
+    char script[256];
+    snprintf(script, sizeof(script), "for n = 1, %u do %s end", cycles, cycle);
+    auto start = std::chrono::steady_clock::now();
+    luaExecStr(script);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return double(cycles) * 1000000 / (elapsed.count() + 1);
+  };
+
+  printf("16 sources: getValues() %.0f cycles/s, getValue() %.0f cycles/s\n",
+         cyclesPerSecond("getValues(sources, values)"),
+         cyclesPerSecond("for i = 1, 16 do values[i] = getValue(names[i]) end"));
+}
+
 TEST(Lua, testModelInputs)
 {
   MODEL_RESET();
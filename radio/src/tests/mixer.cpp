@@ -18,7 +18,9 @@
  * GNU General Public License for more details.
  */
 
+#include <chrono>
 #include "gtests.h"
+#include "sources.h"
 
 class TrimsTest : public OpenTxTest {};
 class MixerTest : public OpenTxTest {};
@@ -969,3 +971,314 @@ TEST_F(TrimsTest, invertedThrottlePlusThrottleTrimWithCrossTrims)
   EXPECT_EQ(channelOutputs[2], +1024);
   EXPECT_EQ(channelOutputs[1], 0);
 }
+
+static_assert(SourceDispatch::table.kind[MIXSRC_NONE] == SOURCE_KIND_ZERO, "MIXSRC_NONE");
+static_assert(SourceDispatch::table.kind[MIXSRC_FIRST_INPUT] == SOURCE_KIND_INPUT, "MIXSRC_FIRST_INPUT");
+static_assert(SourceDispatch::table.kind[MIXSRC_MAX] == SOURCE_KIND_MAX, "MIXSRC_MAX");
+static_assert(SourceDispatch::table.kind[MIXSRC_LAST_CH] == SOURCE_KIND_CHANNEL, "MIXSRC_LAST_CH");
+static_assert(SourceDispatch::table.kind[MIXSRC_LAST_TELEM] == SOURCE_KIND_TELEMETRY, "MIXSRC_LAST_TELEM");
+static_assert(SwitchDispatch::table.kind[SWSRC_ON] == SWITCH_KIND_ON, "SWSRC_ON");
+static_assert(SwitchDispatch::table.kind[SWSRC_LAST_LOGICAL_SWITCH] == SWITCH_KIND_LOGICAL_SWITCH, "SWSRC_LAST_LOGICAL_SWITCH");
+static_assert(SwitchDispatch::table.kind[SWSRC_FIRST_SENSOR] == SWITCH_KIND_SENSOR, "SWSRC_FIRST_SENSOR");
+
+TEST(Sources, dispatchTables)
+{
+  for (unsigned i = 0; i < SourceKinds::COUNT + 10; i++) {
+    EXPECT_EQ(i < SourceKinds::COUNT ? SourceKinds::kind(i) : SourceKinds::OUT_OF_RANGE, SourceDispatch::get(i)) << "source " << i;
+  }
+  for (unsigned i = 0; i < SwitchKinds::COUNT + 10; i++) {
+    EXPECT_EQ(i < SwitchKinds::COUNT ? SwitchKinds::kind(i) : SwitchKinds::OUT_OF_RANGE, SwitchDispatch::get(i)) << "switch " << i;
+  }
+}
+
+TEST(Sources, getValue)
+{
+  SYSTEM_RESET();
+  MODEL_RESET();
+  MIXER_RESET();
+  setModelDefaults(0);
+
+  anas[1] = 100;
+  ex_chans[2] = -200;
+  ppmInput[NUM_CAL_PPM] = 300;
+  timersStates[1].val = 42;
+  telemetryItems[1].valueMax = 1234;
+
+  EXPECT_EQ(0, getValue(MIXSRC_NONE));
+  EXPECT_EQ(100, getValue(MIXSRC_FIRST_INPUT + 1));
+  EXPECT_EQ(1024, getValue(MIXSRC_MAX));
+  EXPECT_EQ(-200, getValue(MIXSRC_CH1 + 2));
+  EXPECT_EQ(600, getValue(MIXSRC_FIRST_TRAINER + NUM_CAL_PPM));
+  EXPECT_EQ(-1024, getValue(MIXSRC_FIRST_LOGICAL_SWITCH));
+  EXPECT_EQ(42, getValue(MIXSRC_TIMER2));
+  EXPECT_EQ(1234, getValue(MIXSRC_FIRST_TELEM + 3 + 2));
+  EXPECT_EQ(0, getValue(MIXSRC_LAST_TELEM + 1));
+
+  EXPECT_TRUE(getSwitch(SWSRC_NONE));
+  EXPECT_TRUE(getSwitch(SWSRC_ON));
+  EXPECT_FALSE(getSwitch(SWSRC_OFF));
+  EXPECT_FALSE(getSwitch(SWSRC_SW1));
+  EXPECT_TRUE(getSwitch(-SWSRC_SW1));
+  EXPECT_FALSE(getSwitch(SWSRC_COUNT));
+
+  telemetryItems[1].valueMax = 0;
+  SYSTEM_RESET();
+}
+
+// getValue() range ladder replaced by the sources dispatch table
+static getvalue_t ladderGetValue(mixsrc_t i)
+{
+  if (i == MIXSRC_NONE) {
+    return 0;
+  }
+  else if (i <= MIXSRC_LAST_INPUT) {
+    return anas[i-MIXSRC_FIRST_INPUT];
+  }
+#if defined(LUA_INPUTS)
+  else if (i <= MIXSRC_LAST_LUA) {
+#if defined(LUA_MODEL_SCRIPTS)
+    div_t qr = div(i-MIXSRC_FIRST_LUA, MAX_SCRIPT_OUTPUTS);
+    return scriptInputsOutputs[qr.quot].outputs[qr.rem].value;
+#else
+    return 0;
+#endif
+  }
+#endif
+  else if (i <= MIXSRC_LAST_POT + NUM_MOUSE_ANALOGS) {
+    return calibratedAnalogs[i - MIXSRC_Rud];
+  }
+#if defined(GYRO)
+  else if (i == MIXSRC_GYRO1) {
+    return gyro.scaledX();
+  }
+  else if (i == MIXSRC_GYRO2) {
+    return gyro.scaledY();
+  }
+#endif
+  else if (i == MIXSRC_MAX) {
+    return 1024;
+  }
+  else if (i <= MIXSRC_CYC3) {
+#if defined(HELI)
+    extern int16_t cyc_anas[3];
+    return cyc_anas[i - MIXSRC_CYC1];
+#else
+    return 0;
+#endif
+  }
+  else if (i <= MIXSRC_LAST_TRIM) {
+    return calc1000toRESX((int16_t)8 * getTrimValue(mixerCurrentFlightMode, i-MIXSRC_FIRST_TRIM));
+  }
+#if defined(PCBFRSKY) || defined(PCBFLYSKY)
+  else if (i >= MIXSRC_FIRST_SWITCH && i <= MIXSRC_LAST_SWITCH) {
+    mixsrc_t sw = i - MIXSRC_FIRST_SWITCH;
+    if (SWITCH_EXISTS(sw)) {
+      return (switchState(3*sw) ? -1024 : (IS_CONFIG_3POS(sw) && switchState(3*sw+1) ? 0 : 1024));
+    }
+    else {
+      return 0;
+    }
+  }
+#else
+  else if (i == MIXSRC_3POS) {
+    return (getSwitch(SW_ID0+1) ? -1024 : (getSwitch(SW_ID1+1) ? 0 : 1024));
+  }
+  else if (i < MIXSRC_SW1) {
+    return getSwitch(SWSRC_THR+i-MIXSRC_THR) ? 1024 : -1024;
+  }
+#endif
+  else if (i <= MIXSRC_LAST_LOGICAL_SWITCH) {
+    return getSwitch(SWSRC_FIRST_LOGICAL_SWITCH + i - MIXSRC_FIRST_LOGICAL_SWITCH) ? 1024 : -1024;
+  }
+  else if (i <= MIXSRC_LAST_TRAINER) {
+    int16_t x = ppmInput[i - MIXSRC_FIRST_TRAINER];
+    if (i < MIXSRC_FIRST_TRAINER + NUM_CAL_PPM) {
+      x -= g_eeGeneral.trainer.calib[i - MIXSRC_FIRST_TRAINER];
+    }
+    return x * 2;
+  }
+  else if (i <= MIXSRC_LAST_CH) {
+    return ex_chans[i - MIXSRC_CH1];
+  }
+  else if (i <= MIXSRC_LAST_GVAR) {
+#if defined(GVARS)
+    return GVAR_VALUE(i - MIXSRC_GVAR1, getGVarFlightMode(mixerCurrentFlightMode, i - MIXSRC_GVAR1));
+#else
+    return 0;
+#endif
+  }
+  else if (i == MIXSRC_TX_VOLTAGE) {
+    return g_vbat100mV;
+  }
+  else if (i < MIXSRC_FIRST_TIMER) {
+#if defined(RTCLOCK)
+    return (g_rtcTime % SECS_PER_DAY) / 60;
+#else
+    return 0;
+#endif
+  }
+  else if (i <= MIXSRC_LAST_TIMER) {
+    return timersStates[i - MIXSRC_FIRST_TIMER].val;
+  }
+  else if (i <= MIXSRC_LAST_TELEM) {
+    if (IS_FAI_FORBIDDEN(i)) {
+      return 0;
+    }
+    i -= MIXSRC_FIRST_TELEM;
+    div_t qr = div(i, 3);
+    TelemetryItem & telemetryItem = telemetryItems[qr.quot];
+    switch (qr.rem) {
+      case 1:
+        return telemetryItem.valueMin;
+      case 2:
+        return telemetryItem.valueMax;
+      default:
+        return telemetryItem.value;
+    }
+  }
+  else return 0;
+}
+
+// getSwitch() range ladder replaced by the switches dispatch table, all logical switches are expected off
+static bool ladderGetSwitch(uint8_t cs_idx)
+{
+  if (cs_idx == SWSRC_NONE) {
+    return true;
+  }
+  else if (cs_idx == SWSRC_ONE) {
+    return !s_mixer_first_run_done;
+  }
+  else if (cs_idx == SWSRC_ON) {
+    return true;
+  }
+#if defined(DEBUG_LATENCY)
+  else if (cs_idx == SWSRC_LATENCY_TOGGLE) {
+    return latencyToggleSwitch;
+  }
+#endif
+  else if (cs_idx <= SWSRC_LAST_SWITCH) {
+    return switchState(cs_idx-SWSRC_FIRST_SWITCH);
+  }
+#if NUM_XPOTS > 0
+  else if (cs_idx <= SWSRC_LAST_MULTIPOS_SWITCH) {
+    extern uint8_t potsPos[NUM_XPOTS];
+    uint8_t sw = cs_idx - SWSRC_FIRST_MULTIPOS_SWITCH;
+    return (potsPos[sw / XPOTS_MULTIPOS_COUNT] & 0x0f) == (sw % XPOTS_MULTIPOS_COUNT);
+  }
+#endif
+  else if (cs_idx <= SWSRC_LAST_TRIM) {
+    uint8_t idx = cs_idx - SWSRC_FIRST_TRIM;
+    idx = (CONVERT_MODE_TRIMS(idx/2) << 1) + (idx & 1);
+    return trimDown(idx);
+  }
+  else if (cs_idx == SWSRC_RADIO_ACTIVITY) {
+    return (inactivity.counter < 2);
+  }
+  else if (cs_idx >= SWSRC_FIRST_SENSOR) {
+    return cs_idx < SWSRC_COUNT && !telemetryItems[cs_idx-SWSRC_FIRST_SENSOR].isOld();
+  }
+  else if (cs_idx == SWSRC_TELEMETRY_STREAMING) {
+    return TELEMETRY_STREAMING();
+  }
+  else if (cs_idx >= SWSRC_FIRST_FLIGHT_MODE) {
+#if defined(FLIGHT_MODES)
+    return (cs_idx - SWSRC_FIRST_FLIGHT_MODE == mixerCurrentFlightMode);
+#else
+    return false;
+#endif
+  }
+  else {
+    return false;
+  }
+}
+
+TEST(Sources, sameAsRangeLadder)
+{
+  SYSTEM_RESET();
+  MODEL_RESET();
+  MIXER_RESET();
+  setModelDefaults(0);
+
+  // a distinct value behind each source
+  for (int i = 0; i < MAX_INPUTS; i++)
+    anas[i] = 1 + i;
+  for (int i = 0; i < NUM_CALIBRATED_ANALOGS; i++)
+    calibratedAnalogs[i] = 100 + i;
+  for (int i = 0; i < NUM_TRIMS; i++)
+    setTrimValue(0, i, 2 * i - 5);
+  for (int i = 0; i < MAX_TRAINER_CHANNELS; i++)
+    ppmInput[i] = 200 + i;
+  for (int i = 0; i < NUM_CAL_PPM; i++)
+    g_eeGeneral.trainer.calib[i] = i;
+  for (int i = 0; i < MAX_OUTPUT_CHANNELS; i++)
+    ex_chans[i] = 300 + i;
+#if defined(GVARS)
+  for (int i = 0; i < MAX_GVARS; i++)
+    g_model.flightModeData[0].gvars[i] = 400 + i;
+#endif
+  g_vbat100mV = 74;
+  for (int i = 0; i < MAX_TIMERS; i++)
+    timersStates[i].val = 500 + i;
+  for (int i = 0; i < MAX_TELEMETRY_SENSORS; i++) {
+    telemetryItems[i].value = 600 + i;
+    telemetryItems[i].valueMin = 700 + i;
+    telemetryItems[i].valueMax = 800 + i;
+    telemetryItems[i].timeout = (i & 1) ? TELEMETRY_SENSOR_TIMEOUT_OLD : 0;
+  }
+  simuSetSwitch(0, -1);
+  simuSetSwitch(1, 1);
+  s_mixer_first_run_done = false;
+
+  for (unsigned i = 0; i <= MIXSRC_LAST_TELEM + 2; i++) {
+    EXPECT_EQ(ladderGetValue(i), getValue(i)) << "source " << i;
+  }
+  for (int i = 0; i <= SWSRC_COUNT + 2; i++) {
+    EXPECT_EQ(ladderGetSwitch(i), getSwitch(i)) << "switch " << i;
+    if (i != SWSRC_NONE) {
+      EXPECT_EQ(!ladderGetSwitch(i), getSwitch(-i)) << "switch " << -i;
+    }
+  }
+
+  for (int i = 0; i < MAX_TELEMETRY_SENSORS; i++) {
+    telemetryItems[i].clear();
+  }
+  s_mixer_first_run_done = true;
+  SYSTEM_RESET();
+}
+
+// Host timings only, they show the trend, not the cycles on the radio
+template <class Lookup>
+static double lookupNanoseconds(unsigned count, Lookup lookup)
+{
+  const unsigned rounds = 2000;
+  volatile int32_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned round = 0; round < rounds; round++) {
+    for (unsigned i = 0; i < count; i++) {
+      sink = sink + lookup(i);
+    }
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  return double(elapsed.count()) / (rounds * count);
+}
+
+TEST(Sources, lookupBenchmark)
+{
+  SYSTEM_RESET();
+  MODEL_RESET();
+  MIXER_RESET();
+  setModelDefaults(0);
+
+  const unsigned sources = MIXSRC_LAST_TELEM + 1;
+  double ladderSources = lookupNanoseconds(sources, [](unsigned i) { return int32_t(ladderGetValue(i)); });
+  double tableSources = lookupNanoseconds(sources, [](unsigned i) { return int32_t(getValue(i)); });
+  printf("getValue(): ladder %.1fns, table %.1fns per lookup\n", ladderSources, tableSources);
+
+  const unsigned switches = SWSRC_COUNT;
+  double ladderSwitches = lookupNanoseconds(switches, [](unsigned i) { return int32_t(ladderGetSwitch(i)); });
+  double tableSwitches = lookupNanoseconds(switches, [](unsigned i) { return int32_t(getSwitch(i)); });
+  printf("getSwitch(): ladder %.1fns, table %.1fns per lookup\n", ladderSwitches, tableSwitches);
+
+  s_mixer_first_run_done = true;
+  SYSTEM_RESET();
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+#include "mixer_scheduler.h"
+
+// a module slower than the mixer gets its frames at its own mean rate,
+// each one at most half a mixer period away from its ideal time
+static void checkDecimation(uint16_t period, uint16_t mixerPeriod)
+{
+  const int runs = 10000;
+  int32_t elapsed = 0;
+  int frames = 0;
+
+  for (int run = 1; run <= runs; run++) {
+    if (mixerSchedulerDecimate(elapsed, period, mixerPeriod)) {
+      ++frames;
+      int32_t error = (int32_t)run * mixerPeriod - (int32_t)frames * period;
+      EXPECT_LE(abs(error), mixerPeriod / 2) << "period " << period << " mixer " << mixerPeriod << " run " << run;
+    }
+  }
+
+  EXPECT_LE(abs(frames - runs * mixerPeriod / period), 1) << "period " << period << " mixer " << mixerPeriod;
+}
+
+TEST(MixerScheduler, decimation)
+{
+  checkDecimation(7000, 4000);
+  checkDecimation(20000, 4000);
+  checkDecimation(22500, 4000);
+  checkDecimation(4001, 4000);
+  checkDecimation(7000, 1750);
+  checkDecimation(50000, 1750);
+}
+
+TEST(MixerScheduler, decimationPeriodChange)
+{
+  int32_t elapsed = 0;
+
+  // a few runs at a long period leave a large accumulator
+  for (int run = 0; run < 10; run++) {
+    mixerSchedulerDecimate(elapsed, 50000, 4000);
+  }
+  EXPECT_EQ(40000, elapsed);
+
+  // the new shorter period does not produce a burst of frames
+  EXPECT_TRUE(mixerSchedulerDecimate(elapsed, 8000, 4000));
+  EXPECT_EQ(0, elapsed);
+  EXPECT_FALSE(mixerSchedulerDecimate(elapsed, 8000, 4000));
+  EXPECT_TRUE(mixerSchedulerDecimate(elapsed, 8000, 4000));
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+
+static uint32_t virtualSleepTotal = 0;
+static void virtualSleepHandler(uint32_t ms)
+{
+  virtualSleepTotal += ms;
+  simuAdvanceVirtualClock(ms * 1000);
+}
+
+TEST(Simu, virtualClock)
+{
+  simuSetVirtualClock(true);
+  EXPECT_EQ(simuTimerMicros(), 0u);
+  simuAdvanceVirtualClock(2500);
+  EXPECT_EQ(RTOS_GET_MS(), 2u);
+  EXPECT_EQ(getTmr2MHz(), 5000u);
+  RTOS_WAIT_MS(10);
+  EXPECT_EQ(simuTimerMicros(), 12500u);
+
+  simuSetVirtualClock(true, virtualSleepHandler);
+  RTOS_WAIT_MS(50);
+  EXPECT_EQ(virtualSleepTotal, 50u);
+  EXPECT_EQ(RTOS_GET_MS(), 50u);
+
+  simuSetVirtualClock(false);
+}
+
+#if defined(DEBUG_LATENCY_MEASURE)
+TEST(Simu, latencyStats)
+{
+  simuSetVirtualClock(true);
+  resetLatencyStats();
+
+  // one sample through all the stages
+  latencyStamp(LATENCY_ADC);
+  simuAdvanceVirtualClock(500);
+  latencyStamp(LATENCY_MIXER_START);
+  simuAdvanceVirtualClock(1000);
+  latencyStamp(LATENCY_MIXER_END);
+  simuAdvanceVirtualClock(200);
+  latencyStamp(LATENCY_PULSES);
+  simuAdvanceVirtualClock(3000);
+  latencyStamp(LATENCY_TRANSMIT);
+  EXPECT_EQ(latencyStats.count, 1u);
+  EXPECT_EQ(latencyStats.stages[LATENCY_MIXER_START].min, 500u);
+  EXPECT_EQ(latencyStats.stages[LATENCY_MIXER_END].min, 1000u);
+  EXPECT_EQ(latencyStats.stages[LATENCY_PULSES].min, 200u);
+  EXPECT_EQ(latencyStats.stages[LATENCY_TRANSMIT].min, 3000u);
+  EXPECT_EQ(latencyStats.stages[LATENCY_ADC].max, 4700u);
+  EXPECT_EQ(latencyStats.histogram[4700 / LATENCY_HISTOGRAM_BIN_US], 1u);
+
+  // a frame sent without a tagged sample isn't counted
+  simuAdvanceVirtualClock(1000);
+  latencyStamp(LATENCY_TRANSMIT);
+  EXPECT_EQ(latencyStats.count, 1u);
+
+  // the mixer runs before the frame is built belong to the first tagged sample
+  latencyStamp(LATENCY_ADC);
+  latencyStamp(LATENCY_MIXER_START);
+  latencyStamp(LATENCY_MIXER_END);
+  simuAdvanceVirtualClock(1000);
+  latencyStamp(LATENCY_ADC);
+  latencyStamp(LATENCY_MIXER_START);
+  latencyStamp(LATENCY_MIXER_END);
+  latencyStamp(LATENCY_PULSES);
+  latencyStamp(LATENCY_TRANSMIT);
+  EXPECT_EQ(latencyStats.count, 2u);
+  EXPECT_EQ(latencyStats.stages[LATENCY_ADC].min, 1000u);
+  EXPECT_EQ(latencyStats.stages[LATENCY_ADC].max, 4700u);
+  EXPECT_EQ(latencyStats.stages[LATENCY_ADC].sum, 5700u);
+  EXPECT_EQ(latencyStats.stages[LATENCY_MIXER_START].min, 0u);
+  EXPECT_EQ(latencyStats.stages[LATENCY_PULSES].max, 1000u);
+
+  // a sample which never reaches a module is dropped
+  latencyStamp(LATENCY_ADC);
+  simuAdvanceVirtualClock(LATENCY_TIMEOUT_US);
+  latencyStamp(LATENCY_ADC);
+  EXPECT_EQ(latencyStats.dropped, 1u);
+  latencyStamp(LATENCY_MIXER_START);
+  latencyStamp(LATENCY_MIXER_END);
+  latencyStamp(LATENCY_PULSES);
+  simuAdvanceVirtualClock(30000);
+  latencyStamp(LATENCY_TRANSMIT);
+  EXPECT_EQ(latencyStats.count, 3u);
+  EXPECT_EQ(latencyStats.histogram[LATENCY_HISTOGRAM_BINS - 1], 1u);
+
+  resetLatencyStats();
+  simuSetVirtualClock(false);
+}
+#endif
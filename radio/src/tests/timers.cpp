@@ -18,6 +18,7 @@
  * GNU General Public License for more details.
  */
 
+#include <random>
 #include "gtests.h"
 
 #define THR_100    128      // approximately 10% full throttle
@@ -192,3 +193,287 @@ TEST(Timers, timerThrottleTriggered)
   EXPECT_TRUE(evalTimersForNSecondsAndTest(10,         0, 0, TMR_NEGATIVE,-11));
   EXPECT_TRUE(evalTimersForNSecondsAndTest(100,        0, 0, TMR_STOPPED,-111));
 }
+
+TEST(Timers, eventsAndSaves)
+{
+  initModelTimer(0, TMRMODE_ON, 62);
+  g_model.timers[0].countdownBeep = COUNTDOWN_BEEPS;
+  g_model.timers[0].minuteBeep = 1;
+  g_model.timers[0].persistent = 1;
+  for (uint8_t i = 1; i < TIMERS; i++) {
+    initModelTimer(i, TMRMODE_OFF);
+  }
+  timerReset(0);
+  timerEvents.clear();
+
+  // a single call covering 3 seconds
+  evalTimers(0, 250);
+  evalTimers(0, 50);
+
+  TimerEvent event;
+  const uint8_t expected[][2] = {
+    { TIMER_EVENT_COUNTDOWN, 61 },
+    { TIMER_EVENT_COUNTDOWN, 60 },
+    { TIMER_EVENT_MINUTE, 60 },
+    { TIMER_EVENT_COUNTDOWN, 59 },
+  };
+  for (auto & e: expected) {
+    ASSERT_TRUE(timerEvents.pop(event));
+    EXPECT_EQ(event.idx, 0);
+    EXPECT_EQ(event.type, e[0]);
+    EXPECT_EQ(event.value, e[1]);
+  }
+  EXPECT_TRUE(timerEvents.isEmpty());
+
+  storageDirtyMsk = 0;
+  saveTimers();
+  EXPECT_EQ(g_model.timers[0].value, 59);
+  EXPECT_EQ(storageDirtyMsk, EE_MODEL);
+  storageDirtyMsk = 0;
+  saveTimers();
+  EXPECT_EQ(storageDirtyMsk, 0);
+}
+
+TEST(Timers, eventsOverflow)
+{
+  initModelTimer(0, TMRMODE_ON, 30);
+  g_model.timers[0].countdownBeep = COUNTDOWN_BEEPS;
+  for (uint8_t i = 1; i < TIMERS; i++) {
+    initModelTimer(i, TMRMODE_OFF);
+  }
+  timerReset(0);
+  timerEvents.clear();
+
+  // the menus task doesn't play anything during 35s
+  for (int i = 0; i < 35; i++) {
+    evalTimers(0, 100);
+  }
+
+  TimerEvent event;
+  for (int value = 29; value > 29 - (16 - TIMERS); value--) {
+    ASSERT_TRUE(timerEvents.pop(event));
+    EXPECT_EQ(event.type, TIMER_EVENT_COUNTDOWN);
+    EXPECT_EQ(event.value, value);
+  }
+  ASSERT_TRUE(timerEvents.pop(event));
+  EXPECT_EQ(event.type, TIMER_EVENT_ELAPSED);
+  EXPECT_TRUE(timerEvents.isEmpty());
+}
+
+TEST(Timers, eventsClearedOnReset)
+{
+  initModelTimer(0, TMRMODE_ON, 5);
+  g_model.timers[0].countdownBeep = COUNTDOWN_BEEPS;
+  for (uint8_t i = 1; i < TIMERS; i++) {
+    initModelTimer(i, TMRMODE_OFF);
+  }
+  timerReset(0);
+  EXPECT_TRUE(timerEvents.isEmpty());
+
+  // countdown callouts not played yet
+  evalTimers(0, 200);
+  EXPECT_FALSE(timerEvents.isEmpty());
+
+  timerReset(0);
+  EXPECT_TRUE(timerEvents.isEmpty());
+  EXPECT_EQ(timersStates[0].val, 5);
+}
+
+/*
+  Straightforward model of a timer, evaluated in 10ms steps
+*/
+class ReferenceTimer
+{
+  public:
+    explicit ReferenceTimer(const TimerData & data):
+      data(data),
+      state(TMR_OFF),
+      val(data.start),
+      ticks(0),
+      integral(0)
+    {
+    }
+
+    // sw is the state of the timer switch
+    void step(uint8_t idx, int16_t throttle, bool sw)
+    {
+      tmrstart_t start = data.start;
+
+      if (!data.mode)
+        return;
+
+      if (state == TMR_OFF && data.mode != TMRMODE_THR_START && data.mode != TMRMODE_START) {
+        start_();
+      }
+
+      if (data.mode == TMRMODE_THR_REL && sw)
+        integral += throttle;
+
+      if (++ticks < 100)
+        return;
+      ticks = 0;
+
+      tmrval_t elapsed = start ? (tmrval_t)start - val : val;
+      switch (data.mode) {
+        case TMRMODE_ON:
+          if (sw)
+            elapsed++;
+          break;
+        case TMRMODE_START:
+          // the switch only starts it
+          if (sw && state == TMR_OFF)
+            start_();
+          if (state != TMR_OFF)
+            elapsed++;
+          break;
+        case TMRMODE_THR:
+          if (sw && throttle)
+            elapsed++;
+          break;
+        case TMRMODE_THR_REL:
+          if (sw && integral >= 128 * 100) {
+            integral -= 128 * 100;
+            elapsed++;
+          }
+          break;
+        case TMRMODE_THR_START:
+          if (sw && throttle > THR_10 && state == TMR_OFF)
+            start_();
+          if (sw && state != TMR_OFF)
+            elapsed++;
+          break;
+      }
+
+      if (state == TMR_RUNNING && start && elapsed >= (tmrval_t)start) {
+        events.push_back({idx, TIMER_EVENT_ELAPSED, 0});
+        state = TMR_NEGATIVE;
+      }
+      else if (state == TMR_NEGATIVE && elapsed >= (tmrval_t)start + MAX_ALERT_TIME) {
+        state = TMR_STOPPED;
+      }
+
+      tmrval_t newVal = start ? (tmrval_t)start - elapsed : elapsed;
+      if (newVal != val) {
+        val = newVal;
+        if (state == TMR_RUNNING) {
+          if (data.countdownBeep && start)
+            events.push_back({idx, TIMER_EVENT_COUNTDOWN, newVal});
+          if (data.minuteBeep && newVal % 60 == 0)
+            events.push_back({idx, TIMER_EVENT_MINUTE, newVal});
+        }
+      }
+    }
+
+    const TimerData & data;
+    uint8_t state;
+    tmrval_t val;
+    unsigned ticks;
+    uint32_t integral;
+    std::vector<TimerEvent> events;
+
+  protected:
+    void start_()
+    {
+      state = TMR_RUNNING;
+      integral = 0;
+    }
+};
+
+/*
+  30 minutes flights with a random mixer period (1 to 4ms, jitter and stalls), random
+  throttle and timer switches (none, first switch up or not up) toggled at random times,
+  checked against the reference model after each call
+*/
+TEST(Timers, randomizedFlights)
+{
+  const tmrmode_t modes[] = { TMRMODE_ON, TMRMODE_START, TMRMODE_THR, TMRMODE_THR_REL, TMRMODE_THR_START };
+  const swsrc_t switches[] = { SWSRC_NONE, SWSRC_FIRST_SWITCH, -SWSRC_FIRST_SWITCH };
+  std::mt19937 random(2021);
+
+  for (int flight = 0; flight < 20; flight++) {
+    std::vector<ReferenceTimer> references;
+    for (uint8_t i = 0; i < TIMERS; i++) {
+      initModelTimer(i, modes[random() % DIM(modes)], (random() % 2) ? 30 + random() % 900 : 0);
+      g_model.timers[i].countdownBeep = random() % 2 ? COUNTDOWN_BEEPS : COUNTDOWN_SILENT;
+      g_model.timers[i].minuteBeep = random() % 2;
+      g_model.timers[i].swtch = switches[random() % DIM(switches)];
+      timerReset(i);
+      references.emplace_back(g_model.timers[i]);
+    }
+    timerEvents.clear();
+
+    uint32_t period = 1000 + random() % 3001;
+    uint32_t now = 0, nextThrottleChange = 0;
+    tmr10ms_t lastTmr10ms = 0;
+    int16_t throttle = 0;
+    uint32_t nextSwitchChange = 0;
+    bool switchUp = true;
+    simuSetSwitch(0, -1);
+    std::vector<TimerEvent> events;
+
+    while (now < 30 * 60 * 1000000u) {
+      // mixer cycle
+      now += period - 500 + random() % 1001;
+      if (random() % 5000 == 0)
+        now += 50000 + random() % 250000;
+
+      if (now >= nextThrottleChange) {
+        switch (random() % 4) {
+          case 0:
+            throttle = 0;
+            break;
+          case 1:
+            throttle = THR_100;
+            break;
+          default:
+            throttle = random() % (THR_100 + 1);
+            break;
+        }
+        nextThrottleChange = now + 100000 + random() % 5000000;
+      }
+
+      if (now >= nextSwitchChange) {
+        // the first switch up 3/4 of the time
+        switchUp = (random() % 4 != 0);
+        simuSetSwitch(0, switchUp ? -1 : 1);
+        nextSwitchChange = now + 100000 + random() % 20000000;
+      }
+
+      tmr10ms_t tmr10ms = now / 10000;
+      uint8_t tick10ms = tmr10ms - lastTmr10ms;
+      lastTmr10ms = tmr10ms;
+      if (!tick10ms)
+        continue;
+
+      evalTimers(throttle, tick10ms);
+      TimerEvent event;
+      while (timerEvents.pop(event))
+        events.push_back(event);
+
+      for (uint8_t i = 0; i < TIMERS; i++) {
+        swsrc_t swtch = g_model.timers[i].swtch;
+        bool sw = (swtch == SWSRC_NONE || (swtch > 0) == switchUp);
+        for (uint8_t tick = 0; tick < tick10ms; tick++)
+          references[i].step(i, throttle, sw);
+        ASSERT_EQ(references[i].state, timersStates[i].state) << "flight " << flight << " timer " << (int)i << " at " << now << "us";
+        ASSERT_EQ(references[i].val, timersStates[i].val) << "flight " << flight << " timer " << (int)i << " at " << now << "us";
+      }
+    }
+
+    // same events, per timer in the same order
+    for (uint8_t i = 0; i < TIMERS; i++) {
+      std::vector<TimerEvent> engineEvents;
+      for (auto & event: events) {
+        if (event.idx == i)
+          engineEvents.push_back(event);
+      }
+      ASSERT_EQ(references[i].events.size(), engineEvents.size()) << "flight " << flight << " timer " << (int)i;
+      for (unsigned n = 0; n < engineEvents.size(); n++) {
+        EXPECT_EQ(references[i].events[n].type, engineEvents[n].type);
+        EXPECT_EQ(references[i].events[n].value, engineEvents[n].value);
+      }
+    }
+  }
+
+  simuSetSwitch(0, -1);
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+
+#if defined(USB_MSC_CACHE) && !defined(SIMU_DISKIO)
+
+#define TEST_DISK_SECTORS   (8 * USB_MSC_CACHE_SECTORS)
+
+// RAM disk standing for the SD card
+static uint8_t testDisk[TEST_DISK_SECTORS * BLOCK_SIZE];
+static int testDiskReads;
+static int testDiskWrites;
+static DWORD testDiskLastWriteCount;
+static bool testDiskWriteError;
+static uint8_t testCacheBuffer[USB_MSC_CACHE_SIZE];
+
+DRESULT __disk_read(BYTE drv, BYTE * buff, DWORD sector, UINT count)
+{
+  if (sector + count > TEST_DISK_SECTORS)
+    return RES_PARERR;
+  ++testDiskReads;
+  memcpy(buff, testDisk + sector * BLOCK_SIZE, count * BLOCK_SIZE);
+  return RES_OK;
+}
+
+DRESULT __disk_write(BYTE drv, const BYTE * buff, DWORD sector, UINT count)
+{
+  if (sector + count > TEST_DISK_SECTORS)
+    return RES_PARERR;
+  if (testDiskWriteError)
+    return RES_ERROR;
+  ++testDiskWrites;
+  testDiskLastWriteCount = count;
+  memcpy(testDisk + sector * BLOCK_SIZE, buff, count * BLOCK_SIZE);
+  return RES_OK;
+}
+
+class UsbMscCacheTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+      for (unsigned i = 0; i < sizeof(testDisk); i++) {
+        testDisk[i] = i / BLOCK_SIZE;
+      }
+      testDiskReads = testDiskWrites = 0;
+      testDiskWriteError = false;
+      cache.start(TEST_DISK_SECTORS);
+    }
+
+    void TearDown() override
+    {
+      cache.stop();
+    }
+
+    UsbMscCache cache{testCacheBuffer};
+};
+
+TEST_F(UsbMscCacheTest, readAhead)
+{
+  uint8_t buffer[BLOCK_SIZE];
+  for (int sector = 0; sector < 2 * USB_MSC_CACHE_SECTORS; sector++) {
+    ASSERT_EQ(RES_OK, cache.read(buffer, sector, 1));
+    EXPECT_EQ(sector, buffer[0]);
+    EXPECT_EQ(sector, buffer[BLOCK_SIZE - 1]);
+  }
+  EXPECT_EQ(2, testDiskReads);
+  EXPECT_EQ(2 * USB_MSC_CACHE_SECTORS - 2, (int)cache.getStats().readHits);
+
+  // no read-ahead past the end of the card
+  ASSERT_EQ(RES_OK, cache.read(buffer, TEST_DISK_SECTORS - 1, 1));
+  EXPECT_EQ((TEST_DISK_SECTORS - 1) & 0xFF, buffer[0]);
+}
+
+TEST_F(UsbMscCacheTest, writeBatching)
+{
+  uint8_t buffer[BLOCK_SIZE];
+  for (int sector = 3; sector < 3 + 2 * USB_MSC_CACHE_SECTORS; sector++) {
+    memset(buffer, 0xA5, BLOCK_SIZE);
+    ASSERT_EQ(RES_OK, cache.write(buffer, sector, 1));
+  }
+
+  // both windows boundaries were reached, the tail is pending
+  EXPECT_EQ(2, testDiskWrites);
+  EXPECT_EQ(USB_MSC_CACHE_SECTORS, (int)testDiskLastWriteCount);
+  EXPECT_EQ(2 + 2 * USB_MSC_CACHE_SECTORS, testDisk[(2 + 2 * USB_MSC_CACHE_SECTORS) * BLOCK_SIZE]);
+
+  ASSERT_EQ(RES_OK, cache.flush());
+  EXPECT_EQ(3, testDiskWrites);
+  for (int sector = 3; sector < 3 + 2 * USB_MSC_CACHE_SECTORS; sector++) {
+    EXPECT_EQ(0xA5, testDisk[sector * BLOCK_SIZE]);
+  }
+  EXPECT_EQ(2, testDisk[2 * BLOCK_SIZE]);
+  EXPECT_EQ(3 + 2 * USB_MSC_CACHE_SECTORS, testDisk[(3 + 2 * USB_MSC_CACHE_SECTORS) * BLOCK_SIZE]);
+}
+
+TEST_F(UsbMscCacheTest, alignedWritesGoDirect)
+{
+  static uint8_t buffer[2 * USB_MSC_CACHE_SIZE];
+  memset(buffer, 0x5A, sizeof(buffer));
+  ASSERT_EQ(RES_OK, cache.write(buffer, USB_MSC_CACHE_SECTORS, 2 * USB_MSC_CACHE_SECTORS));
+  EXPECT_EQ(1, testDiskWrites);
+  EXPECT_EQ(2 * USB_MSC_CACHE_SECTORS, (int)testDiskLastWriteCount);
+}
+
+TEST_F(UsbMscCacheTest, coherence)
+{
+  uint8_t buffer[BLOCK_SIZE];
+
+  // a write replaces the read-ahead data
+  ASSERT_EQ(RES_OK, cache.read(buffer, 0, 1));
+  memset(buffer, 0x77, BLOCK_SIZE);
+  ASSERT_EQ(RES_OK, cache.write(buffer, 1, 1));
+  memset(buffer, 0, BLOCK_SIZE);
+
+  // reading back a pending sector flushes it first
+  ASSERT_EQ(RES_OK, cache.read(buffer, 1, 1));
+  EXPECT_EQ(0x77, buffer[0]);
+  EXPECT_EQ(1, testDiskWrites);
+  EXPECT_EQ(0x77, testDisk[BLOCK_SIZE]);
+
+  ASSERT_EQ(RES_OK, cache.read(buffer, 2, 1));
+  EXPECT_EQ(2, buffer[0]);
+}
+
+TEST_F(UsbMscCacheTest, writeErrorKeepsPendingWrites)
+{
+  uint8_t buffer[BLOCK_SIZE];
+  memset(buffer, 0x33, BLOCK_SIZE);
+  ASSERT_EQ(RES_OK, cache.write(buffer, 1, 1));
+
+  testDiskWriteError = true;
+  EXPECT_EQ(RES_ERROR, cache.flush());
+  EXPECT_EQ(1, testDisk[BLOCK_SIZE]);
+
+  // the sector is still pending and reaches the card on the next flush
+  testDiskWriteError = false;
+  ASSERT_EQ(RES_OK, cache.flush());
+  EXPECT_EQ(1, testDiskWrites);
+  EXPECT_EQ(0x33, testDisk[BLOCK_SIZE]);
+}
+
+TEST_F(UsbMscCacheTest, idleFlush)
+{
+  uint8_t buffer[BLOCK_SIZE];
+  memset(buffer, 0x66, BLOCK_SIZE);
+  ASSERT_EQ(RES_OK, cache.write(buffer, 4, 1));
+
+  // the host may still continue the window
+  g_tmr10ms += USB_MSC_CACHE_IDLE_FLUSH - 1;
+  ASSERT_EQ(RES_OK, cache.flushIfIdle());
+  EXPECT_EQ(0, testDiskWrites);
+
+  // acknowledged writes can't stay in RAM until the cable is pulled
+  g_tmr10ms += 1;
+  ASSERT_EQ(RES_OK, cache.flushIfIdle());
+  EXPECT_EQ(1, testDiskWrites);
+  EXPECT_EQ(0x66, testDisk[4 * BLOCK_SIZE]);
+
+  // nothing left to write
+  g_tmr10ms += USB_MSC_CACHE_IDLE_FLUSH;
+  ASSERT_EQ(RES_OK, cache.flushIfIdle());
+  EXPECT_EQ(1, testDiskWrites);
+}
+
+TEST_F(UsbMscCacheTest, stopFlushes)
+{
+  uint8_t buffer[BLOCK_SIZE];
+  memset(buffer, 0x44, BLOCK_SIZE);
+  ASSERT_EQ(RES_OK, cache.write(buffer, 2, 1));
+  EXPECT_EQ(0, testDiskWrites);
+
+  cache.stop();
+  EXPECT_EQ(1, testDiskWrites);
+  EXPECT_EQ(0x44, testDisk[2 * BLOCK_SIZE]);
+
+  // once stopped the cache goes straight to the card
+  memset(buffer, 0x55, BLOCK_SIZE);
+  ASSERT_EQ(RES_OK, cache.write(buffer, 3, 1));
+  EXPECT_EQ(2, testDiskWrites);
+  EXPECT_EQ(0x55, testDisk[3 * BLOCK_SIZE]);
+}
+
+#endif
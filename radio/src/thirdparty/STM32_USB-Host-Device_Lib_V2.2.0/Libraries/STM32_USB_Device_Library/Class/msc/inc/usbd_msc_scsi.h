@@ -76,6 +76,8 @@
 #define SCSI_VERIFY16                               0x8F
 
 #define SCSI_SEND_DIAGNOSTIC                        0x1D
+#define SCSI_SYNCHRONIZE_CACHE10                    0x35	// modified by OpenTX
+#define SCSI_SYNCHRONIZE_CACHE16                    0x91	// modified by OpenTX
 #define SCSI_READ_FORMAT_CAPACITIES                 0x23
 
 #define NO_SENSE                                    0
@@ -98,6 +98,7 @@ static int8_t SCSI_ReadCapacity10(uint8_t lun, uint8_t *params);
 static int8_t SCSI_RequestSense (uint8_t lun, uint8_t *params);
 static int8_t SCSI_StartStopUnit(uint8_t lun, uint8_t *params);
 static int8_t SCSI_AllowRemoval(uint8_t lun, uint8_t *params);	// modified by OpenTX
+static int8_t SCSI_SynchronizeCache(uint8_t lun, uint8_t *params);	// modified by OpenTX
 static int8_t SCSI_ModeSense6 (uint8_t lun, uint8_t *params);
 static int8_t SCSI_ModeSense10 (uint8_t lun, uint8_t *params);
 static int8_t SCSI_Write10(uint8_t lun , uint8_t *params);
@@ -169,6 +170,10 @@ int8_t SCSI_ProcessCmd(USB_OTG_CORE_HANDLE  *pdev,
     
   case SCSI_VERIFY10:
     return SCSI_Verify10(lun, params);
+
+  case SCSI_SYNCHRONIZE_CACHE10:	// modified by OpenTX
+  case SCSI_SYNCHRONIZE_CACHE16:
+    return SCSI_SynchronizeCache(lun, params);
     
   default:
     SCSI_SenseCode(lun,
@@ -198,6 +203,14 @@ static int8_t SCSI_TestUnitReady(uint8_t lun, uint8_t *params)
     return -1;
   }  
   
+  if (STORAGE_Flush(lun) != 0)	// modified by OpenTX
+  {
+    SCSI_SenseCode(lun,
+                   HARDWARE_ERROR,
+                   WRITE_FAULT);
+    return -1;
+  }
+
   if(USBD_STORAGE_fops->IsReady(lun) !=0 )
   {
     SCSI_SenseCode(lun,
@@ -439,6 +452,11 @@ extern uint8_t lunReady[];	// modified by OpenTX
 static int8_t SCSI_StartStopUnit(uint8_t lun, uint8_t *params)
 {
   MSC_BOT_DataLen = 0;
+  if (STORAGE_Flush(lun) != 0)	// modified by OpenTX
+  {
+    SCSI_SenseCode(lun, HARDWARE_ERROR, WRITE_FAULT);
+    return -1;
+  }
   
 #if defined(BOOT)		// modified by OpenTX
   if (lun < 2) 
@@ -462,6 +480,23 @@ static int8_t SCSI_StartStopUnit(uint8_t lun, uint8_t *params)
 static int8_t SCSI_AllowRemoval(uint8_t lun, uint8_t *params)
 {
   MSC_BOT_DataLen = 0;
+  if (STORAGE_Flush(lun) != 0)	// modified by OpenTX
+  {
+    SCSI_SenseCode(lun, HARDWARE_ERROR, WRITE_FAULT);
+    return -1;
+  }
+  return 0;
+}
+
+// modified by OpenTX: the host asks for its acknowledged writes to reach the medium
+static int8_t SCSI_SynchronizeCache(uint8_t lun, uint8_t *params)
+{
+  MSC_BOT_DataLen = 0;
+  if (STORAGE_Flush(lun) != 0)
+  {
+    SCSI_SenseCode(lun, HARDWARE_ERROR, WRITE_FAULT);
+    return -1;
+  }
   return 0;
 }
 
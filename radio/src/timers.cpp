@@ -35,6 +35,8 @@ void timerReset(uint8_t idx)
   timerState.state = TMR_OFF; // is changed to RUNNING dep from mode
   timerState.val = g_model.timers[idx].start;
   timerState.val_10ms = 0 ;
+  // the queued callouts may be about the value before the reset
+  timerEvents.clear();
 }
 
 void timerSet(int idx, int val)
@@ -67,108 +69,159 @@ void saveTimers()
   }
 }
 
+Fifo<TimerEvent, 16> timerEvents;
+
+// Pushed by the mixer task and played by the menus task. When fewer than TIMERS slots are left,
+// countdown and minute callouts are dropped so that the elapsed alarms still fit in the queue.
+static void pushTimerEvent(uint8_t idx, uint8_t type, tmrval_t value)
+{
+  if (type != TIMER_EVENT_ELAPSED && !timerEvents.hasSpace(TIMERS))
+    return;
+
+  TimerEvent event;
+  event.idx = idx;
+  event.type = type;
+  event.value = value;
+  timerEvents.push(event);
+}
+
+void playTimerEvents()
+{
+  TimerEvent event;
+  while (timerEvents.pop(event)) {
+    switch (event.type) {
+      case TIMER_EVENT_ELAPSED:
+        AUDIO_TIMER_ELAPSED(event.idx);
+        break;
+      case TIMER_EVENT_COUNTDOWN:
+        AUDIO_TIMER_COUNTDOWN(event.idx, event.value);
+        break;
+      case TIMER_EVENT_MINUTE:
+        AUDIO_TIMER_MINUTE(event.value);
+        break;
+    }
+  }
+}
+
 #define THR_TRG_TRESHOLD    13      // approximately 10% full throttle
 
+static void startTimer(TimerState * timerState)
+{
+  timerState->state = TMR_RUNNING;
+  timerState->sum = 0;
+}
+
+static void evalTimerSecond(uint8_t idx, int16_t throttle)
+{
+  const TimerData & timerData = g_model.timers[idx];
+  tmrmode_t timerMode = timerData.mode;
+  tmrstart_t timerStart = timerData.start;
+  TimerState * timerState = &timersStates[idx];
+
+  tmrval_t newTimerVal = timerState->val;
+  if (timerStart) newTimerVal = timerStart - newTimerVal;
+
+  if (timerMode == TMRMODE_START) {
+    // Start timer based on switch
+    if (getSwitch(timerData.swtch) && timerState->state == TMR_OFF) {
+      startTimer(timerState);
+    }
+    if (timerState->state != TMR_OFF) {
+      newTimerVal++;
+    }
+  }
+  else if (getSwitch(timerData.swtch)) {
+    // Modes conditional on switch at any time
+    if (timerMode == TMRMODE_ON) {
+      newTimerVal++;
+    }
+    else if (timerMode == TMRMODE_THR) {
+      if (throttle) newTimerVal++;
+    }
+    else if (timerMode == TMRMODE_THR_REL) {
+      // one second of full throttle (128) per second
+      if (timerState->sum >= TIMER_THR_REL_SECOND) {
+        newTimerVal++;
+        timerState->sum -= TIMER_THR_REL_SECOND;
+      }
+    }
+    else if (timerMode == TMRMODE_THR_START) {
+      // we can't rely on (throttle || newTimerVal > 0) as a detection if
+      // timer should be running because having persistent timer brakes
+      // this rule
+      if ((throttle > THR_TRG_TRESHOLD) && timerState->state == TMR_OFF) {
+        startTimer(timerState);
+      }
+      if (timerState->state != TMR_OFF) newTimerVal++;
+    }
+  }
+
+  switch (timerState->state) {
+    case TMR_RUNNING:
+      if (timerStart && newTimerVal >= (tmrval_t)timerStart) {
+        pushTimerEvent(idx, TIMER_EVENT_ELAPSED, 0);
+        timerState->state = TMR_NEGATIVE;
+      }
+      break;
+    case TMR_NEGATIVE:
+      if (newTimerVal >= (tmrval_t)timerStart + MAX_ALERT_TIME) {
+        timerState->state = TMR_STOPPED;
+      }
+      break;
+  }
+
+  // if counting backwards - display backwards
+  if (timerStart) newTimerVal = timerStart - newTimerVal;
+
+  if (newTimerVal != timerState->val) {
+    timerState->val = newTimerVal;
+    if (timerState->state == TMR_RUNNING) {
+      if (timerData.countdownBeep && timerData.start) {
+        pushTimerEvent(idx, TIMER_EVENT_COUNTDOWN, newTimerVal);
+      }
+      if (timerData.minuteBeep && (newTimerVal % 60) == 0) {
+        pushTimerEvent(idx, TIMER_EVENT_MINUTE, newTimerVal);
+      }
+    }
+  }
+}
+
+/*
+  tick10ms is the time elapsed since the previous call, it varies with the mixer period.
+  The throttle is integrated over that time up to each second boundary, so the result
+  doesn't depend on how the time was split between calls.
+  Audio callouts are queued in timerEvents, they are played by the menus task, see playTimerEvents().
+*/
 void evalTimers(int16_t throttle, uint8_t tick10ms)
 {
   for (uint8_t i=0; i<TIMERS; i++) {
     tmrmode_t timerMode = g_model.timers[i].mode;
-    tmrstart_t timerStart = g_model.timers[i].start;
-    int16_t     timerSwtch = g_model.timers[i].swtch;
     TimerState * timerState = &timersStates[i];
 
-    if (timerMode) {
-      if ((timerState->state == TMR_OFF)
-          && (timerMode != TMRMODE_THR_START)
-          && (timerMode != TMRMODE_START)) {
-       
-        timerState->state = TMR_RUNNING;
-        timerState->cnt = 0;
-        timerState->sum = 0;
-      }
+    if (!timerMode)
+      continue;
 
-      if (timerMode == TMRMODE_THR_REL) {
-        timerState->cnt++;
-        timerState->sum += throttle;
-      }
+    if ((timerState->state == TMR_OFF)
+        && (timerMode != TMRMODE_THR_START)
+        && (timerMode != TMRMODE_START)) {
+      startTimer(timerState);
+    }
 
-      if ((timerState->val_10ms += tick10ms) >= 100) {
-        if (timerState->val == TIMER_MAX) break;
-        if (timerState->val == TIMER_MIN) break;
+    bool integrate = (timerMode == TMRMODE_THR_REL && getSwitch(g_model.timers[i].swtch));
 
+    // split the elapsed time at the seconds boundaries
+    uint8_t remaining = tick10ms;
+    while (remaining) {
+      uint8_t step = min<uint8_t>(remaining, 100 - timerState->val_10ms);
+      if (integrate) {
+        timerState->sum += (uint32_t)throttle * step;
+      }
+      remaining -= step;
+      timerState->val_10ms += step;
+      if (timerState->val_10ms >= 100) {
         timerState->val_10ms -= 100;
-        tmrval_t newTimerVal = timerState->val;
-        if (timerStart) newTimerVal = timerStart - newTimerVal;
-
-        if (timerMode == TMRMODE_START) {
-          // Start timer based on switch
-          if (getSwitch(timerSwtch) && timerState->state == TMR_OFF) {
-            timerState->state = TMR_RUNNING;  // start timer running
-            timerState->cnt = 0;
-            timerState->sum = 0;
-          }
-          if (timerState->state != TMR_OFF) {
-            newTimerVal++;
-          } 
-        } else if (getSwitch(timerSwtch)) {
-
-          // Modes conditional on switch at any time
-          if (timerMode == TMRMODE_ON) {
-            newTimerVal++;
-          } else if (timerMode == TMRMODE_THR) {
-            if (throttle) newTimerVal++;
-          } else if (timerMode == TMRMODE_THR_REL) {
-            // throttle was normalized to 0 to 128 value
-            // (throttle/64*2 (because - range is added as well)
-            if ((timerState->sum / timerState->cnt) >= 128) {  
-              newTimerVal++;  // add second used of throttle
-              timerState->sum -= 128 * timerState->cnt;
-            }
-            timerState->cnt = 0;
-          } else if (timerMode == TMRMODE_THR_START) {
-            // we can't rely on (throttle || newTimerVal > 0) as a detection if
-            // timer should be running because having persistent timer brakes
-            // this rule
-            if ((throttle > THR_TRG_TRESHOLD) && timerState->state == TMR_OFF) {
-              timerState->state = TMR_RUNNING;  // start timer running
-              timerState->cnt = 0;
-              timerState->sum = 0;
-              // TRACE("Timer[%d] THr triggered", i);
-            }
-            if (timerState->state != TMR_OFF) newTimerVal++;
-          }
-        }
-
-        switch (timerState->state) {
-          case TMR_RUNNING:
-            if (timerStart && newTimerVal >= (tmrval_t)timerStart) {
-              AUDIO_TIMER_ELAPSED(i);
-              timerState->state = TMR_NEGATIVE;
-              // TRACE("Timer[%d] negative", i);
-            }
-            break;
-          case TMR_NEGATIVE:
-            if (newTimerVal >= (tmrval_t)timerStart + MAX_ALERT_TIME) {
-              timerState->state = TMR_STOPPED;
-              // TRACE("Timer[%d] stopped state at %d", i, newTimerVal);
-            }
-            break;
-        }
-
-        // if counting backwards - display backwards
-        if (timerStart) newTimerVal = timerStart - newTimerVal;
-
-        if (newTimerVal != timerState->val) {
-          timerState->val = newTimerVal;
-          if (timerState->state == TMR_RUNNING) {
-            if (g_model.timers[i].countdownBeep && g_model.timers[i].start) {
-              AUDIO_TIMER_COUNTDOWN(i, newTimerVal);
-            }
-            if (g_model.timers[i].minuteBeep && (newTimerVal % 60) == 0) {
-              AUDIO_TIMER_MINUTE(newTimerVal);
-              // TRACE("Timer[%d] %d minute announcement", i, newTimerVal/60);
-            }
-          }
+        if (timerState->val != TIMER_MAX && timerState->val != TIMER_MIN) {
+          evalTimerSecond(i, throttle);
         }
       }
     }
@@ -22,6 +22,7 @@
 #define _TIMERS_H_
 
 #include "opentx_types.h"
+#include "fifo.h"
 
 #define TMR_OFF      0
 #define TMR_RUNNING  1
@@ -35,14 +36,28 @@ typedef int16_t tmrmode_t;
 
 #define TIMER_MIN     (tmrval_t(-TIMER_MAX-1))
 
+// throttle integral of one second at full throttle (128 per 10ms)
+#define TIMER_THR_REL_SECOND  (128 * 100)
+
 struct TimerState {
-  uint16_t cnt;
-  uint16_t sum;
+  uint32_t sum;       // throttle integral, in 10ms steps
   uint8_t  state;
   tmrval_t  val;
   uint8_t  val_10ms;
 };
 
+enum TimerEventType {
+  TIMER_EVENT_ELAPSED,
+  TIMER_EVENT_COUNTDOWN,
+  TIMER_EVENT_MINUTE,
+};
+
+struct TimerEvent {
+  uint8_t idx;
+  uint8_t type;
+  tmrval_t value;
+};
+
 #if defined(TIMERS)
 extern TimerState timersStates[TIMERS];
 #endif
@@ -56,6 +71,10 @@ void restoreTimers();
 
 void evalTimers(int16_t throttle, uint8_t tick10ms);
 
+// audio callouts of the timers, raised by the mixer task and played in the same order by the menus task
+extern Fifo<TimerEvent, 16> timerEvents;
+void playTimerEvents();
+
 extern volatile tmr10ms_t g_tmr10ms;
 static inline tmr10ms_t get_tmr10ms()
 {
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <string.h>
+#include "opentx.h"
+
+#if 0     // set to 1 to enable traces
+  #define TRACE_USB_MSC_CACHE(...)   TRACE(__VA_ARGS__)
+#else
+  #define TRACE_USB_MSC_CACHE(...)
+#endif
+
+static uint8_t usbMscCacheBuffer[USB_MSC_CACHE_SIZE] __DMA;
+UsbMscCache usbMscCache(usbMscCacheBuffer);
+
+UsbMscCache::UsbMscCache(uint8_t * buffer):
+  data(buffer),
+  started(false),
+  lastWriteTime(0)
+{
+  reset(0);
+  memclear(&stats, sizeof(stats));
+  lastSectors = 0;
+  lastTime = 0;
+  throughput = 0;
+}
+
+void UsbMscCache::reset(uint32_t sectorCount)
+{
+  mode = MODE_EMPTY;
+  bufferStart = validStart = validEnd = 0;
+  this->sectorCount = sectorCount;
+}
+
+void UsbMscCache::start(uint32_t sectorCount)
+{
+  reset(sectorCount);
+  started = true;
+}
+
+void UsbMscCache::stop()
+{
+  if (flush() != RES_OK) {
+    TRACE("USB MSC cache: pending writes lost");
+  }
+  reset(0);
+  started = false;
+}
+
+DRESULT UsbMscCache::flush()
+{
+  if (mode != MODE_WRITE) {
+    return RES_OK;
+  }
+
+  TRACE_USB_MSC_CACHE("\tusb cache flush(%u, %u)", (uint32_t)validStart, (uint32_t)(validEnd - validStart));
+  ++stats.flushes;
+  DRESULT res = __disk_write(0, data + (validStart - bufferStart) * BLOCK_SIZE, validStart, validEnd - validStart);
+  if (res == RES_OK) {
+    mode = MODE_EMPTY;
+  }
+  // otherwise the writes stay pending, the next flush retries them
+  return res;
+}
+
+DRESULT UsbMscCache::flushIfIdle()
+{
+  if (mode != MODE_WRITE || (tmr10ms_t)(get_tmr10ms() - lastWriteTime) < USB_MSC_CACHE_IDLE_FLUSH) {
+    return RES_OK;
+  }
+  return flush();
+}
+
+DRESULT UsbMscCache::read(BYTE * buff, DWORD sector, UINT count)
+{
+  stats.readSectors += count;
+
+  if (!started) {
+    return __disk_read(0, buff, sector, count);
+  }
+
+  if (mode == MODE_READ && sector >= validStart && sector + count <= validEnd) {
+    ++stats.readHits;
+    memcpy(buff, data + (sector - bufferStart) * BLOCK_SIZE, count * BLOCK_SIZE);
+    return RES_OK;
+  }
+
+  // the window is needed for the read-ahead, or the read overlaps pending writes
+  bool readAhead = (count < USB_MSC_CACHE_SECTORS && sector + USB_MSC_CACHE_SECTORS <= sectorCount);
+  if (mode == MODE_WRITE && (readAhead || (sector < validEnd && sector + count > validStart))) {
+    DRESULT res = flush();
+    if (res != RES_OK) {
+      return res;
+    }
+  }
+
+  if (!readAhead) {
+    TRACE_USB_MSC_CACHE("\tusb cache direct read(%u, %u)", (uint32_t)sector, (uint32_t)count);
+    return __disk_read(0, buff, sector, count);
+  }
+
+  mode = MODE_EMPTY;
+  DRESULT res = __disk_read(0, data, sector, USB_MSC_CACHE_SECTORS);
+  if (res != RES_OK) {
+    return res;
+  }
+
+  TRACE_USB_MSC_CACHE("\tusb cache read-ahead(%u) for read(%u, %u)", (uint32_t)sector, (uint32_t)sector, (uint32_t)count);
+  mode = MODE_READ;
+  bufferStart = validStart = sector;
+  validEnd = sector + USB_MSC_CACHE_SECTORS;
+  memcpy(buff, data, count * BLOCK_SIZE);
+  return RES_OK;
+}
+
+DRESULT UsbMscCache::write(const BYTE * buff, DWORD sector, UINT count)
+{
+  stats.writtenSectors += count;
+
+#if defined(DISK_CACHE)
+  // FatFs is not mounted while the host owns the card, but it will be again afterwards
+  diskCache.free(sector, count);
+#endif
+
+  if (!started) {
+    return __disk_write(0, buff, sector, count);
+  }
+
+  if (mode == MODE_READ) {
+    mode = MODE_EMPTY;
+  }
+
+  lastWriteTime = get_tmr10ms();
+
+  while (count > 0) {
+    // a write which does not continue the pending ones starts a new window
+    if (mode == MODE_WRITE && sector != validEnd) {
+      DRESULT res = flush();
+      if (res != RES_OK) {
+        return res;
+      }
+    }
+
+    DWORD windowStart = sector - (sector % USB_MSC_CACHE_SECTORS);
+
+    // whole aligned windows go straight to the card
+    if (mode == MODE_EMPTY && sector == windowStart && count >= USB_MSC_CACHE_SECTORS) {
+      UINT n = count - (count % USB_MSC_CACHE_SECTORS);
+      TRACE_USB_MSC_CACHE("\tusb cache direct write(%u, %u)", (uint32_t)sector, (uint32_t)n);
+      DRESULT res = __disk_write(0, buff, sector, n);
+      if (res != RES_OK) {
+        return res;
+      }
+      buff += n * BLOCK_SIZE;
+      sector += n;
+      count -= n;
+      continue;
+    }
+
+    if (mode == MODE_EMPTY) {
+      mode = MODE_WRITE;
+      bufferStart = windowStart;
+      validStart = validEnd = sector;
+    }
+
+    UINT n = min<UINT>(count, bufferStart + USB_MSC_CACHE_SECTORS - sector);
+    memcpy(data + (sector - bufferStart) * BLOCK_SIZE, buff, n * BLOCK_SIZE);
+    validEnd += n;
+    buff += n * BLOCK_SIZE;
+    sector += n;
+    count -= n;
+
+    if (validEnd == bufferStart + USB_MSC_CACHE_SECTORS) {
+      DRESULT res = flush();
+      if (res != RES_OK) {
+        return res;
+      }
+    }
+  }
+
+  return RES_OK;
+}
+
+const UsbMscCacheStats & UsbMscCache::getStats() const
+{
+  return stats;
+}
+
+uint32_t UsbMscCache::getThroughput()
+{
+  tmr10ms_t now = get_tmr10ms();
+  if (now - lastTime >= 100) {
+    uint32_t sectors = stats.readSectors + stats.writtenSectors;
+    throughput = (sectors - lastSectors) * (100 * BLOCK_SIZE / 1024) / (now - lastTime);
+    lastSectors = sectors;
+    lastTime = now;
+  }
+  return throughput;
+}
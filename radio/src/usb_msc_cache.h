@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _USB_MSC_CACHE_H_
+#define _USB_MSC_CACHE_H_
+
+#include "diskio.h"
+
+// tunable parameters: the window is the unit of read-ahead and the unit
+// in which writes are batched (aligned on its size)
+#if !defined(USB_MSC_CACHE_SECTORS)
+  #if defined(PCBHORUS) || defined(PCBNV14)
+    #define USB_MSC_CACHE_SECTORS      32
+  #elif defined(STM32F2)
+    #define USB_MSC_CACHE_SECTORS      8
+  #else
+    #define USB_MSC_CACHE_SECTORS      16
+  #endif
+#endif
+
+#define USB_MSC_CACHE_SIZE       (USB_MSC_CACHE_SECTORS * BLOCK_SIZE)
+
+// pending writes reach the card after this idle time, even if the host doesn't sync (10ms)
+#define USB_MSC_CACHE_IDLE_FLUSH   20
+
+struct UsbMscCacheStats
+{
+  uint32_t readSectors;
+  uint32_t writtenSectors;
+  uint32_t readHits;
+  uint32_t flushes;
+};
+
+// SD card access from the USB mass storage class. The single window buffer
+// holds either read-ahead data or writes waiting to complete their window,
+// never both: the host mostly streams in one direction at a time.
+// The cache is used between start() (the host gets the card) and stop(),
+// otherwise the accesses go straight to the card.
+class UsbMscCache
+{
+  public:
+    explicit UsbMscCache(uint8_t * buffer);  // USB_MSC_CACHE_SIZE bytes
+    void start(uint32_t sectorCount);
+    void stop();
+    DRESULT read(BYTE * buff, DWORD sector, UINT count);
+    DRESULT write(const BYTE * buff, DWORD sector, UINT count);
+    DRESULT flush();
+    DRESULT flushIfIdle();  // the writes pending since USB_MSC_CACHE_IDLE_FLUSH
+    const UsbMscCacheStats & getStats() const;
+    uint32_t getThroughput();  // KB/s, both directions
+
+  private:
+    void reset(uint32_t sectorCount);
+
+    enum Mode {
+      MODE_EMPTY,
+      MODE_READ,
+      MODE_WRITE
+    };
+
+    uint8_t * data;
+    bool started;
+    uint8_t mode;
+    DWORD bufferStart;   // sector stored at data[0]
+    DWORD validStart;    // first valid (read) or pending (write) sector
+    DWORD validEnd;
+    uint32_t sectorCount;
+    tmr10ms_t lastWriteTime;
+    UsbMscCacheStats stats;
+    uint32_t lastSectors;
+    tmr10ms_t lastTime;
+    uint32_t throughput;
+};
+
+extern UsbMscCache usbMscCache;
+
+#endif // _USB_MSC_CACHE_H_
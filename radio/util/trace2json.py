@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+    This script converts a trace buffer dump (CLI "tracebuffer dump" or the "Trace Buffer"
+    debug screen, built with DEBUG_TRACE_BUFFER) into the Chrome trace event format, which
+    can be opened in chrome://tracing or https://ui.perfetto.dev
+
+    Events pairs named "xxx_start" / "xxx_end" are shown as durations, all others as instant events.
+    The event names are taken from the TraceEvent enum in radio/src/debug.h
+    Each task (task_mixer_xxx, audio_xxx, ...) or driver (sd_xxx, ff_xxx) gets its own track, named
+    after the first word of its events names.
+
+    Usage:
+
+        ./trace2json.py dump.txt > trace.json
+        ./simu 2>&1 | ../radio/util/trace2json.py > trace.json
+"""
+
+from __future__ import print_function
+
+import json
+import os
+import re
+import sys
+
+
+def parseTraceEvents(filename):
+    events = {}
+    value = 0
+    inEnum = False
+    with open(filename, "r") as f:
+        for line in f:
+            line = line.split("//")[0].strip()
+            if line.startswith("enum TraceEvent"):
+                inEnum = True
+            elif inEnum:
+                if line.startswith("}"):
+                    break
+                m = re.match(r"(\w+)\s*(?:=\s*(\d+))?\s*,?", line)
+                if m:
+                    if m.group(2):
+                        value = int(m.group(2))
+                    events[value] = m.group(1)
+                    value += 1
+    return events
+
+
+def getTrackName(name):
+    if name.startswith("task_"):
+        name = name[5:]
+    return name.split("_")[0]
+
+
+def main():
+    header = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "debug.h")
+    names = parseTraceEvents(header)
+    values = set(names.values())
+
+    if len(sys.argv) > 1:
+        inp = open(sys.argv[1], "r")
+    else:
+        inp = sys.stdin
+
+    ticksPerUs = 1
+    output = []
+    tids = {}
+    for line in inp:
+        line = line.strip("\r\n")
+        m = re.match(r"Trace ticks/us (\d+)", line)
+        if m:
+            ticksPerUs = int(m.group(1))
+            continue
+        m = re.match(r"^(\d+)\s+(\d+)\s+(\d+)\s+0x([0-9a-fA-F]+)$", line)
+        if not m:
+            continue
+        time = int(m.group(2)) / float(ticksPerUs)
+        event = int(m.group(3))
+        data = int(m.group(4), 16)
+        name = names.get(event, "event_%d" % event)
+        track = getTrackName(name)
+        if track not in tids:
+            tids[track] = len(tids) + 1
+            output.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": tids[track], "args": {"name": track}})
+        item = {"ts": time, "pid": 0, "tid": tids[track], "args": {"data": "0x%08x" % data}}
+        if name.endswith("_start") and name[:-6] + "_end" in values:
+            item.update(name=name[:-6], ph="B")
+        elif name.endswith("_end") and name[:-4] + "_start" in values:
+            item.update(name=name[:-4], ph="E")
+        else:
+            item.update(name=name, ph="i", s="t")
+        output.append(item)
+
+    json.dump({"traceEvents": output, "displayTimeUnit": "ms"}, sys.stdout, indent=1)
+
+
+if __name__ == "__main__":
+    main()